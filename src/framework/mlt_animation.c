@@ -29,6 +29,7 @@
 #include <ctype.h>
 #include <float.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -54,7 +55,13 @@ struct mlt_animation_s
     int length; /**< the maximum number of frames to use when interpreting negative keyframe positions */
     double fps;          /**< framerate to use when converting time clock strings to frame units */
     mlt_locale_t locale; /**< pointer to a locale to use when converting strings to numeric values */
-    animation_node nodes; /**< a linked list of keyframes (and possibly non-keyframe values) */
+    animation_node nodes;  /**< a linked list of keyframes (and possibly non-keyframe values) */
+    animation_node *index; /**< the nodes in list order, for bisecting */
+    int count;             /**< the number of nodes in the index */
+    int size;              /**< the allocated size of the index */
+    int indexed;           /**< whether the index matches the list */
+    int sorted;            /**< whether the indexed frames are in ascending order */
+    atomic_int cursor;     /**< the index of the node found by the last lookup */
 };
 
 /** \brief Keyframe type to string mapping
@@ -149,6 +156,121 @@ mlt_animation mlt_animation_new()
     return self;
 }
 
+/** Make the index of the nodes match the linked list.
+ *
+ * This must be called after changing the list, so that looking up a node only
+ * reads the index and can be done by several threads. Without memory for the
+ * index, lookups walk the list instead.
+ * \private \memberof mlt_animation_s
+ * \param self an animation
+ */
+
+static void mlt_animation_index(mlt_animation self)
+{
+    animation_node node;
+    int count = 0;
+    for (node = self->nodes; node; node = node->next)
+        count++;
+    if (count > self->size) {
+        animation_node *index = realloc(self->index, count * sizeof(animation_node));
+        if (!index) {
+            self->indexed = 0;
+            return;
+        }
+        self->index = index;
+        self->size = count;
+    }
+    self->count = 0;
+    self->sorted = 1;
+    for (node = self->nodes; node; node = node->next) {
+        if (self->count && node->item.frame <= self->index[self->count - 1]->item.frame)
+            self->sorted = 0;
+        self->index[self->count++] = node;
+    }
+    atomic_store_explicit(&self->cursor, 0, memory_order_relaxed);
+    self->indexed = 1;
+}
+
+/** Determine if nodes can be found by bisecting the index.
+ *
+ * \private \memberof mlt_animation_s
+ * \param self an animation
+ * \return true if the index is complete and its frames are in ascending order
+ */
+
+static inline int mlt_animation_is_sorted(mlt_animation self)
+{
+    return self->indexed && self->sorted;
+}
+
+/** Find the last node at or before a position.
+ *
+ * This checks the node found by the previous lookup and the one following it
+ * before bisecting, which makes playing forward cheap.
+ * \private \memberof mlt_animation_s
+ * \param self an animation
+ * \param position the frame number for the point in time
+ * \return the node, the first node if the position precedes it, or NULL if there are no nodes
+ */
+
+static animation_node mlt_animation_find(mlt_animation self, int position)
+{
+    // Frames set out of order are found the way a walk of the list would find them
+    if (!mlt_animation_is_sorted(self)) {
+        animation_node node = self->nodes;
+        while (node && node->next && position >= node->next->item.frame)
+            node = node->next;
+        return node;
+    }
+    if (!self->count)
+        return NULL;
+
+    animation_node *index = self->index;
+    int i = atomic_load_explicit(&self->cursor, memory_order_relaxed);
+
+    if (i < self->count && index[i]->item.frame <= position) {
+        if (i + 1 == self->count || position < index[i + 1]->item.frame)
+            return index[i];
+        if (i + 2 == self->count || position < index[i + 2]->item.frame) {
+            atomic_store_explicit(&self->cursor, i + 1, memory_order_relaxed);
+            return index[i + 1];
+        }
+    }
+
+    int low = 0;
+    int high = self->count - 1;
+    while (low < high) {
+        int middle = low + (high - low + 1) / 2;
+        if (index[middle]->item.frame <= position)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    atomic_store_explicit(&self->cursor, low, memory_order_relaxed);
+
+    return index[low];
+}
+
+/** Get the N-th node.
+ *
+ * \private \memberof mlt_animation_s
+ * \param self an animation
+ * \param index the N-th node (0 based)
+ * \return the node or NULL if out of range
+ */
+
+static animation_node mlt_animation_node(mlt_animation self, int index)
+{
+    if (self->indexed)
+        return index >= 0 && index < self->count ? self->index[index] : NULL;
+
+    // Iterate through the keyframes.
+    animation_node node = index >= 0 ? self->nodes : NULL;
+    while (index-- && node)
+        node = node->next;
+    return node;
+}
+
 /** Re-interpolate non-keyframe nodes after a series of insertions or removals.
  *
  * \public \memberof mlt_animation_s
@@ -217,6 +339,7 @@ static int mlt_animation_drop(mlt_animation self, animation_node node)
     }
     mlt_property_close(node->item.property);
     free(node);
+    self->indexed = 0;
 
     return 0;
 }
@@ -236,6 +359,7 @@ static void mlt_animation_clean(mlt_animation self)
     self->data = NULL;
     while (self->nodes)
         mlt_animation_drop(self, self->nodes);
+    mlt_animation_index(self);
 }
 
 /** Parse a string representing an animation.
@@ -481,11 +605,7 @@ int mlt_animation_get_item(mlt_animation self, mlt_animation_item item, int posi
 
     int error = 0;
     // Need to find the nearest keyframe to the position specified
-    animation_node node = self->nodes;
-
-    // Iterate through the keyframes until we reach last or have
-    while (node && node->next && position >= node->next->item.frame)
-        node = node->next;
+    animation_node node = mlt_animation_find(self, position);
 
     if (node) {
         item->keyframe_type = node->item.keyframe_type;
@@ -559,8 +679,21 @@ int mlt_animation_insert(mlt_animation self, mlt_animation_item item)
         animation_node current = self->nodes;
 
         // Locate an existing nearby item
-        while (current->next && item->frame > current->item.frame)
-            current = current->next;
+        if (mlt_animation_is_sorted(self)) {
+            int low = 0;
+            int high = self->count - 1;
+            while (low < high) {
+                int middle = low + (high - low) / 2;
+                if (item->frame > self->index[middle]->item.frame)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            current = self->index[low];
+        } else {
+            while (current->next && item->frame > current->item.frame)
+                current = current->next;
+        }
 
         if (item->frame < current->item.frame) {
             if (current == self->nodes)
@@ -570,12 +703,31 @@ int mlt_animation_insert(mlt_animation self, mlt_animation_item item)
             node->next = current;
             node->prev = current->prev;
             current->prev = node;
+            mlt_animation_index(self);
         } else if (item->frame > current->item.frame) {
             if (current->next)
                 current->next->prev = node;
             node->next = current->next;
             node->prev = current;
             current->next = node;
+
+            // Appending keeps the index
+            if (!node->next && mlt_animation_is_sorted(self)) {
+                if (self->count == self->size) {
+                    int size = self->size ? 2 * self->size : 8;
+                    animation_node *index = realloc(self->index, size * sizeof(animation_node));
+                    if (index) {
+                        self->index = index;
+                        self->size = size;
+                    }
+                }
+                if (self->count < self->size)
+                    self->index[self->count++] = node;
+                else
+                    self->indexed = 0;
+            } else {
+                mlt_animation_index(self);
+            }
         } else {
             // Update matching node.
             current->item.frame = item->frame;
@@ -588,6 +740,7 @@ int mlt_animation_insert(mlt_animation self, mlt_animation_item item)
     } else {
         // Set the first item
         self->nodes = node;
+        mlt_animation_index(self);
     }
     mlt_animation_clear_string(self);
 
@@ -608,13 +761,18 @@ int mlt_animation_remove(mlt_animation self, int position)
         return 1;
 
     int error = 1;
-    animation_node node = self->nodes;
+    animation_node node = mlt_animation_find(self, position);
 
-    while (node && position != node->item.frame)
-        node = node->next;
+    if (!mlt_animation_is_sorted(self)) {
+        node = self->nodes;
+        while (node && position != node->item.frame)
+            node = node->next;
+    }
 
-    if (node && position == node->item.frame)
+    if (node && position == node->item.frame) {
         error = mlt_animation_drop(self, node);
+        mlt_animation_index(self);
+    }
 
     mlt_animation_clear_string(self);
 
@@ -635,8 +793,10 @@ int mlt_animation_next_key(mlt_animation self, mlt_animation_item item, int posi
     if (!self || !item)
         return 1;
 
-    animation_node node = self->nodes;
+    animation_node node = mlt_animation_find(self, position);
 
+    if (!mlt_animation_is_sorted(self))
+        node = self->nodes;
     while (node && position > node->item.frame)
         node = node->next;
 
@@ -665,12 +825,9 @@ int mlt_animation_prev_key(mlt_animation self, mlt_animation_item item, int posi
     if (!self || !item)
         return 1;
 
-    animation_node node = self->nodes;
-
-    while (node && node->next && position >= node->next->item.frame)
-        node = node->next;
+    animation_node node = mlt_animation_find(self, position);
 
-    if (position < node->item.frame)
+    if (node && position < node->item.frame)
         node = NULL;
 
     if (node) {
@@ -882,9 +1039,13 @@ int mlt_animation_key_count(mlt_animation self)
 {
     int count = -1;
     if (self) {
-        animation_node node = self->nodes;
-        for (count = 0; node; ++count)
-            node = node->next;
+        if (self->indexed) {
+            count = self->count;
+        } else {
+            animation_node node = self->nodes;
+            for (count = 0; node; ++count)
+                node = node->next;
+        }
     }
     return count;
 }
@@ -904,12 +1065,7 @@ int mlt_animation_key_get(mlt_animation self, mlt_animation_item item, int index
         return 1;
 
     int error = 0;
-    animation_node node = self->nodes;
-
-    // Iterate through the keyframes.
-    int i = index;
-    while (i-- && node)
-        node = node->next;
+    animation_node node = mlt_animation_node(self, index);
 
     if (node) {
         item->is_key = node->item.is_key;
@@ -935,6 +1091,7 @@ void mlt_animation_close(mlt_animation self)
 {
     if (self) {
         mlt_animation_clean(self);
+        free(self->index);
         free(self);
     }
 }
@@ -954,12 +1111,7 @@ int mlt_animation_key_set_type(mlt_animation self, int index, mlt_keyframe_type
         return 1;
 
     int error = 0;
-    animation_node node = self->nodes;
-
-    // Iterate through the keyframes.
-    int i = index;
-    while (i-- && node)
-        node = node->next;
+    animation_node node = mlt_animation_node(self, index);
 
     if (node) {
         node->item.keyframe_type = type;
@@ -987,15 +1139,11 @@ int mlt_animation_key_set_frame(mlt_animation self, int index, int frame)
         return 1;
 
     int error = 0;
-    animation_node node = self->nodes;
-
-    // Iterate through the keyframes.
-    int i = index;
-    while (i-- && node)
-        node = node->next;
+    animation_node node = mlt_animation_node(self, index);
 
     if (node) {
         node->item.frame = frame;
+        mlt_animation_index(self);
         mlt_animation_interpolate(self);
         mlt_animation_clear_string(self);
     } else {
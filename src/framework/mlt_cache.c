@@ -22,19 +22,22 @@
 
 #include "mlt_cache.h"
 #include "mlt_frame.h"
+#include "mlt_image.h"
 #include "mlt_log.h"
 #include "mlt_properties.h"
 #include "mlt_types.h"
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 
-/** the maximum number of data objects to cache per line */
-#define MAX_CACHE_SIZE (200)
-
 /** the default number of data objects to cache per line */
 #define DEFAULT_CACHE_SIZE (4)
 
+/** the initial number of hash buckets, a power of 2 */
+#define MIN_BUCKETS (16)
+
 /** \brief Cache item class
  *
  * A cache item is a structure holding information about a data object including
@@ -54,15 +57,35 @@ typedef struct mlt_cache_item_s
     int size;     /**< the size of the cached data */
     int refcount;              /**< a reference counter to control when destructor is called */
     mlt_destructor destructor; /**< a function to release or destroy the cached data */
+    int is_garbage; /**< indicates the data was replaced while there were references to it */
 } mlt_cache_item_s;
 
+/** \brief Cache entry class
+ *
+ * An entry is the presence of an object or frame in the cache. The entries
+ * are linked in order of use and chained in the hash buckets.
+ */
+
+typedef struct cache_entry_s *cache_entry;
+struct cache_entry_s
+{
+    void *object;          /**< the owner of the cached data, or the frame in a frame cache */
+    mlt_position position; /**< the position of the frame in a frame cache */
+    int64_t cost;          /**< the number of bytes charged for the entry */
+    uint64_t stamp;        /**< the time of the last use of an entry in a shared cache */
+    cache_entry prev;      /**< the next less recently used entry */
+    cache_entry next;      /**< the next more recently used entry */
+    cache_entry chain;     /**< the next entry in the same hash bucket */
+};
+
 /** \brief Cache class
  *
  * This is a utility class for implementing a Least Recently Used (LRU) cache
  * of data blobs indexed by the address of some other object (e.g., a service).
- * Instead of sorting and manipulating linked lists, it tries to be simple and
- * elegant by copying pointers between two arrays of fixed size to shuffle the
- * order of elements.
+ * The entries are found through a hash table and kept in a list ordered by
+ * use, so getting and putting do not depend on the number of entries.
+ * The capacity is a number of entries or, with mlt_cache_set_max_bytes(), a
+ * number of bytes so that entries of different sizes share it fairly.
  *
  * This class is useful if you have a service that wants to cache something
  * somewhat large, but will not scale if there are many instances of the service.
@@ -80,21 +103,55 @@ typedef struct mlt_cache_item_s
 
 struct mlt_cache_s
 {
-    int count;      /**< the number of items currently in the cache */
-    int size;       /**< the maximum number of items permitted in the cache <= \p MAX_CACHE_SIZE */
-    int is_frames;  /**< indicates if this cache is used to cache frames */
-    void **current; /**< pointer to the current array of pointers */
-    void *A[MAX_CACHE_SIZE];
-    void *B[MAX_CACHE_SIZE];
+    int count;     /**< the number of items currently in the cache */
+    int size;      /**< the maximum number of items permitted in the cache */
+    int is_frames; /**< indicates if this cache is used to cache frames */
+    int64_t bytes; /**< the number of bytes charged for the items in the cache */
+    int64_t max_bytes;    /**< the maximum number of bytes or 0 to limit the number of items */
+    cache_entry lru;      /**< the least recently used entry */
+    cache_entry mru;      /**< the most recently used entry */
+    cache_entry *buckets; /**< the hash table of entries */
+    int bucket_count;     /**< the number of hash buckets, a power of 2 */
+    int shared;           /**< indicates if this cache is subject to the shared budget */
     pthread_mutex_t mutex;  /**< a mutex to prevent multi-threaded race conditions */
     mlt_properties active;  /**< a list of cache items some of which may no longer
-	                            be in \p current but to which there are
+	                            be in the cache but to which there are
 	                            outstanding references */
     mlt_properties garbage; /**< a list cache items pending release. A cache item
 	                            is copied to this list when it is updated but there
 	                            are outstanding references to the old data object. */
 };
 
+/** \brief Shared cache budget
+ *
+ * Caches registered with mlt_cache_share() are charged against one process-wide
+ * number of bytes. When the budget is exceeded, the least recently used entry
+ * across all of the shared caches is released, so a cache that is busy can take
+ * memory from caches that are idle.
+ */
+
+static struct
+{
+    pthread_mutex_t mutex;  /**< protects the list of caches and serializes eviction */
+    mlt_cache *caches;      /**< the shared caches */
+    int count;              /**< the number of shared caches */
+    int size;               /**< the allocated length of \p caches */
+    atomic_llong max_bytes; /**< the budget or 0 for no budget */
+    atomic_llong bytes;     /**< the number of bytes charged for all shared entries */
+    atomic_llong hits;      /**< the number of successful lookups in shared caches */
+    atomic_llong misses;    /**< the number of failed lookups in shared caches */
+    atomic_ullong clock;    /**< the source of use stamps */
+} shared = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+static pthread_once_t shared_once = PTHREAD_ONCE_INIT;
+
+static void shared_init(void)
+{
+    const char *value = getenv("MLT_CACHE_MAX_BYTES");
+    if (value)
+        atomic_store(&shared.max_bytes, strtoll(value, NULL, 10));
+}
+
 /** Get the data pointer from the cache item.
  *
  * \public \memberof mlt_cache_s
@@ -110,23 +167,19 @@ void *mlt_cache_item_data(mlt_cache_item item, int *size)
     return item ? item->data : NULL;
 }
 
-/** Close a cache item given its parent object pointer.
+/** Release the reference of the cache to the data of an object.
  *
  * \private \memberof mlt_cache_s
- * \param cache a cache
+ * \param cache a cache that is not a frame cache
  * \param object the object to which the data object belongs
- * \param data the data object, which might be in the garbage list (optional)
+ * \param[out] data the data object to destroy
+ * \return the destructor to call on \p data when it was the last reference, or NULL
  */
 
-static void cache_object_close(mlt_cache cache, void *object, void *data)
+static mlt_destructor cache_object_release(mlt_cache cache, void *object, void **data)
 {
     char key[19];
-
-    if (cache->is_frames) {
-        // Frame caches are easy - just close the object as mlt_frame.
-        mlt_frame_close(object);
-        return;
-    }
+    mlt_destructor destructor = NULL;
 
     // Fetch the cache item from the active list by its owner's address
     sprintf(key, "%p", object);
@@ -141,38 +194,78 @@ static void cache_object_close(mlt_cache cache, void *object, void *data)
                 item->data,
                 item->refcount);
         if (item->destructor && --item->refcount <= 0) {
-            // Destroy the data object
-            item->destructor(item->data);
+            destructor = item->destructor;
+            *data = item->data;
             item->data = NULL;
             item->destructor = NULL;
             // Do not dispose of the cache item because it could likely be used
             // again.
         }
     }
+    return destructor;
+}
 
-    // Fetch the cache item from the garbage collection by its data address
-    if (data) {
-        sprintf(key, "%p", data);
-        item = mlt_properties_get_data(cache->garbage, key, NULL);
-        if (item) {
-            mlt_log(NULL,
-                    MLT_LOG_DEBUG,
-                    "collecting garbage item %p object %p data %p refcount %d\n",
-                    item,
-                    item->object,
-                    item->data,
-                    item->refcount);
-            if (item->destructor && --item->refcount <= 0) {
-                item->destructor(item->data);
-                item->data = NULL;
-                item->destructor = NULL;
-                // We do not need the garbage-collected cache item
-                mlt_properties_set_data(cache->garbage, key, NULL, 0, NULL, NULL);
-            }
-        }
+/** Close a cache item given its parent object pointer.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param object the object to which the data object belongs
+ */
+
+static void cache_object_close(mlt_cache cache, void *object)
+{
+    if (cache->is_frames) {
+        // Frame caches are easy - just close the object as mlt_frame.
+        mlt_frame_close(object);
+    } else {
+        void *data = NULL;
+        mlt_destructor destructor = cache_object_release(cache, object, &data);
+        // Destroy the data object
+        if (destructor)
+            destructor(data);
     }
 }
 
+/** Close a cache item in the garbage collection.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param item a cache item whose data was replaced in the cache
+ */
+
+static void cache_garbage_close(mlt_cache cache, mlt_cache_item item)
+{
+    mlt_log(NULL,
+            MLT_LOG_DEBUG,
+            "collecting garbage item %p object %p data %p refcount %d\n",
+            item,
+            item->object,
+            item->data,
+            item->refcount);
+    if (--item->refcount <= 0) {
+        char key[19];
+        sprintf(key, "%p", item->data);
+        if (item->destructor)
+            item->destructor(item->data);
+        // We do not need the garbage-collected cache item
+        mlt_properties_set_data(cache->garbage, key, NULL, 0, NULL, NULL);
+    }
+}
+
+/** Release a cache item when it is removed from the active list.
+ *
+ * An item moved to the garbage collection is released from there instead.
+ * \private \memberof mlt_cache_s
+ * \param data a cache item
+ */
+
+static void cache_item_free(void *data)
+{
+    mlt_cache_item item = data;
+    if (!item->is_garbage)
+        free(item);
+}
+
 /** Close a cache item.
  *
  * Release a reference and call the destructor on the data object when all
@@ -185,9 +278,271 @@ static void cache_object_close(mlt_cache cache, void *object, void *data)
 void mlt_cache_item_close(mlt_cache_item item)
 {
     if (item) {
-        pthread_mutex_lock(&item->cache->mutex);
-        cache_object_close(item->cache, item->object, item->data);
-        pthread_mutex_unlock(&item->cache->mutex);
+        mlt_cache cache = item->cache;
+        pthread_mutex_lock(&cache->mutex);
+        if (item->is_garbage)
+            cache_garbage_close(cache, item);
+        else
+            cache_object_close(cache, item->object);
+        pthread_mutex_unlock(&cache->mutex);
+    }
+}
+
+/** Compute the hash bucket of a cache key.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param key an object address or a frame position
+ * \return the index of a bucket
+ */
+
+static inline int cache_bucket(mlt_cache cache, uint64_t key)
+{
+    // Fibonacci hashing spreads both aligned addresses and consecutive positions
+    key *= UINT64_C(0x9E3779B97F4A7C15);
+    return (int) (key >> 32) & (cache->bucket_count - 1);
+}
+
+/** Get the hash key of an entry.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param entry a cache entry
+ * \return the key
+ */
+
+static inline uint64_t entry_key(mlt_cache cache, cache_entry entry)
+{
+    return cache->is_frames ? (uint64_t) entry->position : (uint64_t) (uintptr_t) entry->object;
+}
+
+/** Find the entry of an object or frame position.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param key an object address or a frame position
+ * \return the entry or NULL for a miss
+ */
+
+static cache_entry cache_find(mlt_cache cache, uint64_t key)
+{
+    cache_entry entry = cache->buckets[cache_bucket(cache, key)];
+    while (entry && entry_key(cache, entry) != key)
+        entry = entry->chain;
+    return entry;
+}
+
+/** Make an entry the most recently used.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param entry an entry that is not in the list of uses
+ */
+
+static void cache_push_mru(mlt_cache cache, cache_entry entry)
+{
+    if (cache->shared)
+        entry->stamp = atomic_fetch_add_explicit(&shared.clock, 1, memory_order_relaxed);
+    entry->prev = cache->mru;
+    entry->next = NULL;
+    if (cache->mru)
+        cache->mru->next = entry;
+    else
+        cache->lru = entry;
+    cache->mru = entry;
+}
+
+/** Remove an entry from the list of uses.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param entry an entry
+ */
+
+static void cache_unlink(mlt_cache cache, cache_entry entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->lru = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->mru = entry->prev;
+}
+
+/** Make an entry that is in the list of uses the most recently used.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param entry an entry
+ */
+
+static void cache_touch(mlt_cache cache, cache_entry entry)
+{
+    if (entry != cache->mru) {
+        cache_unlink(cache, entry);
+        cache_push_mru(cache, entry);
+    } else if (cache->shared) {
+        // Other caches may have been used since, so this use still needs a new stamp
+        entry->stamp = atomic_fetch_add_explicit(&shared.clock, 1, memory_order_relaxed);
+    }
+}
+
+/** Change the number of bytes charged for the entries of a cache.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param bytes the number of bytes to add, which may be negative
+ */
+
+static void cache_charge(mlt_cache cache, int64_t bytes)
+{
+    cache->bytes += bytes;
+    if (cache->shared)
+        atomic_fetch_add_explicit(&shared.bytes, bytes, memory_order_relaxed);
+}
+
+/** Add a new entry to the hash table and make it the most recently used.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param entry a new entry
+ */
+
+static void cache_insert(mlt_cache cache, cache_entry entry)
+{
+    // Keep the chains short
+    if (cache->count >= cache->bucket_count) {
+        int count = cache->bucket_count * 2;
+        cache_entry *buckets = calloc(count, sizeof(cache_entry));
+        if (buckets) {
+            cache_entry e;
+            free(cache->buckets);
+            cache->buckets = buckets;
+            cache->bucket_count = count;
+            for (e = cache->lru; e; e = e->next) {
+                int i = cache_bucket(cache, entry_key(cache, e));
+                e->chain = buckets[i];
+                buckets[i] = e;
+            }
+        }
+    }
+
+    int i = cache_bucket(cache, entry_key(cache, entry));
+    entry->chain = cache->buckets[i];
+    cache->buckets[i] = entry;
+    cache_push_mru(cache, entry);
+    cache_charge(cache, entry->cost);
+    cache->count++;
+}
+
+/** Remove an entry from the cache without releasing its data.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param entry an entry
+ */
+
+static void cache_detach(mlt_cache cache, cache_entry entry)
+{
+    cache_entry *link = &cache->buckets[cache_bucket(cache, entry_key(cache, entry))];
+    while (*link != entry)
+        link = &(*link)->chain;
+    *link = entry->chain;
+    cache_unlink(cache, entry);
+    cache_charge(cache, -entry->cost);
+    cache->count--;
+}
+
+/** Remove an entry from the cache and release its data.
+ *
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ * \param entry an entry
+ */
+
+static void cache_remove(mlt_cache cache, cache_entry entry)
+{
+    cache_detach(cache, entry);
+
+    mlt_log(NULL, MLT_LOG_DEBUG, "%s: %d = %p\n", __FUNCTION__, cache->count, entry->object);
+    cache_object_close(cache, entry->object);
+    free(entry);
+}
+
+/** Release the least recently used entries until the cache is within its capacity.
+ *
+ * The most recently used entry is always kept.
+ * \private \memberof mlt_cache_s
+ * \param cache a cache
+ */
+
+static void cache_evict(mlt_cache cache)
+{
+    while (cache->lru && (cache->max_bytes > 0 ? cache->bytes > cache->max_bytes && cache->count > 1
+                                                : cache->count > cache->size))
+        cache_remove(cache, cache->lru);
+}
+
+/** Release the least recently used entries of all shared caches until they are within the budget.
+ *
+ * This must be called without holding the mutex of any cache. The most recently
+ * used entry of \p keep is kept so that what was just put can be gotten.
+ * \private \memberof mlt_cache_s
+ * \param keep the cache that was just changed
+ */
+
+static void shared_evict(mlt_cache keep)
+{
+    int64_t max_bytes = atomic_load(&shared.max_bytes);
+
+    if (max_bytes <= 0 || atomic_load_explicit(&shared.bytes, memory_order_relaxed) <= max_bytes)
+        return;
+
+    while (atomic_load_explicit(&shared.bytes, memory_order_relaxed) > max_bytes) {
+        mlt_cache victim = NULL;
+        uint64_t oldest = 0;
+        mlt_destructor destructor = NULL;
+        void *data = NULL;
+        int i;
+
+        pthread_mutex_lock(&shared.mutex);
+        // Find the cache with the oldest entry
+        for (i = 0; i < shared.count; i++) {
+            mlt_cache cache = shared.caches[i];
+            pthread_mutex_lock(&cache->mutex);
+            cache_entry entry = cache->lru;
+            if (entry && !(cache == keep && entry == cache->mru)
+                && (!victim || entry->stamp < oldest)) {
+                victim = cache;
+                oldest = entry->stamp;
+            }
+            pthread_mutex_unlock(&cache->mutex);
+        }
+        if (victim) {
+            // Another thread may have used it in the meantime, but it is still old
+            pthread_mutex_lock(&victim->mutex);
+            cache_entry entry = victim->lru;
+            if (entry && !(victim == keep && entry == victim->mru)) {
+                cache_detach(victim, entry);
+                if (victim->is_frames) {
+                    destructor = (mlt_destructor) mlt_frame_close;
+                    data = entry->object;
+                } else {
+                    destructor = cache_object_release(victim, entry->object, &data);
+                }
+                free(entry);
+            }
+            pthread_mutex_unlock(&victim->mutex);
+        }
+        pthread_mutex_unlock(&shared.mutex);
+
+        // Destroy the data after unlocking because it may close services and their caches
+        if (destructor)
+            destructor(data);
+        if (!victim)
+            break;
     }
 }
 
@@ -203,7 +558,12 @@ mlt_cache mlt_cache_init()
     mlt_cache result = calloc(1, sizeof(struct mlt_cache_s));
     if (result) {
         result->size = DEFAULT_CACHE_SIZE;
-        result->current = result->A;
+        result->bucket_count = MIN_BUCKETS;
+        result->buckets = calloc(result->bucket_count, sizeof(cache_entry));
+        if (!result->buckets) {
+            free(result);
+            return NULL;
+        }
         pthread_mutex_init(&result->mutex, NULL);
         result->active = mlt_properties_new();
         result->garbage = mlt_properties_new();
@@ -213,8 +573,8 @@ mlt_cache mlt_cache_init()
 
 /** Set the number of items to cache.
  *
- * This must be called before using the cache. The size can not be more
- * than \p MAX_CACHE_SIZE.
+ * This must be called before using the cache. The entries are hashed, so
+ * the size does not need to be small.
  * \public \memberof mlt_cache_s
  * \param cache the cache to adjust
  * \param size the new size of the cache
@@ -222,7 +582,7 @@ mlt_cache mlt_cache_init()
 
 void mlt_cache_set_size(mlt_cache cache, int size)
 {
-    if (size <= MAX_CACHE_SIZE)
+    if (size > 0)
         cache->size = size;
 }
 
@@ -238,6 +598,148 @@ int mlt_cache_get_size(mlt_cache cache)
     return cache->size;
 }
 
+/** Set the number of bytes to cache.
+ *
+ * When this is greater than 0, the cache holds as many items as fit in it
+ * instead of the number of items from mlt_cache_set_size(). An item costs the
+ * size given to mlt_cache_put() or the size of the image, alpha, and audio of a
+ * cached frame. The most recently used item is kept even if it alone is larger.
+ * \public \memberof mlt_cache_s
+ * \param cache the cache to adjust
+ * \param bytes the maximum number of bytes or 0 to limit the number of items
+ */
+
+void mlt_cache_set_max_bytes(mlt_cache cache, int64_t bytes)
+{
+    pthread_mutex_lock(&cache->mutex);
+    cache->max_bytes = bytes > 0 ? bytes : 0;
+    cache_evict(cache);
+    pthread_mutex_unlock(&cache->mutex);
+}
+
+/** Get the maximum number of bytes to cache.
+ *
+ * \public \memberof mlt_cache_s
+ * \param cache the cache to check
+ * \return the maximum number of bytes or 0 if the number of items is limited instead
+ */
+
+int64_t mlt_cache_get_max_bytes(mlt_cache cache)
+{
+    return cache->max_bytes;
+}
+
+/** Get the number of bytes used by the items in the cache.
+ *
+ * \public \memberof mlt_cache_s
+ * \param cache the cache to check
+ * \return the number of bytes
+ */
+
+int64_t mlt_cache_get_bytes(mlt_cache cache)
+{
+    pthread_mutex_lock(&cache->mutex);
+    int64_t bytes = cache->bytes;
+    pthread_mutex_unlock(&cache->mutex);
+    return bytes;
+}
+
+/** Charge a cache against the process-wide budget.
+ *
+ * The entries of all shared caches are released in order of use across the
+ * caches when their total number of bytes exceeds mlt_cache_set_shared_max_bytes().
+ * This is in addition to the capacity of each cache. The budget is initialized
+ * from the environment variable \p MLT_CACHE_MAX_BYTES.
+ * \public \memberof mlt_cache_s
+ * \param cache the cache to share
+ */
+
+void mlt_cache_share(mlt_cache cache)
+{
+    pthread_once(&shared_once, shared_init);
+    pthread_mutex_lock(&shared.mutex);
+    if (!cache->shared) {
+        if (shared.count == shared.size) {
+            int size = shared.size ? shared.size * 2 : MIN_BUCKETS;
+            mlt_cache *caches = realloc(shared.caches, size * sizeof(mlt_cache));
+            if (!caches) {
+                pthread_mutex_unlock(&shared.mutex);
+                return;
+            }
+            shared.caches = caches;
+            shared.size = size;
+        }
+        shared.caches[shared.count++] = cache;
+
+        cache_entry entry;
+        pthread_mutex_lock(&cache->mutex);
+        cache->shared = 1;
+        atomic_fetch_add(&shared.bytes, cache->bytes);
+        for (entry = cache->lru; entry; entry = entry->next)
+            entry->stamp = atomic_fetch_add_explicit(&shared.clock, 1, memory_order_relaxed);
+        pthread_mutex_unlock(&cache->mutex);
+    }
+    pthread_mutex_unlock(&shared.mutex);
+}
+
+/** Set the number of bytes to cache across all shared caches.
+ *
+ * \public \memberof mlt_cache_s
+ * \param bytes the maximum number of bytes or 0 for no budget
+ */
+
+void mlt_cache_set_shared_max_bytes(int64_t bytes)
+{
+    pthread_once(&shared_once, shared_init);
+    atomic_store(&shared.max_bytes, bytes > 0 ? bytes : 0);
+    shared_evict(NULL);
+}
+
+/** Get the number of bytes to cache across all shared caches.
+ *
+ * \public \memberof mlt_cache_s
+ * \return the maximum number of bytes or 0 if there is no budget
+ */
+
+int64_t mlt_cache_get_shared_max_bytes()
+{
+    pthread_once(&shared_once, shared_init);
+    return atomic_load(&shared.max_bytes);
+}
+
+/** Get the number of bytes used by the items in all shared caches.
+ *
+ * \public \memberof mlt_cache_s
+ * \return the number of bytes
+ */
+
+int64_t mlt_cache_get_shared_bytes()
+{
+    return atomic_load(&shared.bytes);
+}
+
+/** Get the number of times data was found in a shared cache.
+ *
+ * \public \memberof mlt_cache_s
+ * \return the number of hits
+ */
+
+int64_t mlt_cache_get_shared_hits()
+{
+    return atomic_load(&shared.hits);
+}
+
+/** Get the number of times data was not found in a shared cache.
+ *
+ * \public \memberof mlt_cache_s
+ * \return the number of misses
+ */
+
+int64_t mlt_cache_get_shared_misses()
+{
+    return atomic_load(&shared.misses);
+}
+
 /** Destroy a cache.
  *
  * \public \memberof mlt_cache_s
@@ -247,11 +749,18 @@ int mlt_cache_get_size(mlt_cache cache)
 void mlt_cache_close(mlt_cache cache)
 {
     if (cache) {
-        while (cache->count--) {
-            void *object = cache->current[cache->count];
-            mlt_log(NULL, MLT_LOG_DEBUG, "%s: %d = %p\n", __FUNCTION__, cache->count, object);
-            cache_object_close(cache, object, NULL);
+        if (cache->shared) {
+            int i;
+            pthread_mutex_lock(&shared.mutex);
+            for (i = 0; i < shared.count && shared.caches[i] != cache; i++)
+                ;
+            if (i < shared.count)
+                shared.caches[i] = shared.caches[--shared.count];
+            pthread_mutex_unlock(&shared.mutex);
         }
+        while (cache->mru)
+            cache_remove(cache, cache->mru);
+        free(cache->buckets);
         mlt_properties_close(cache->active);
         mlt_properties_close(cache->garbage);
         pthread_mutex_destroy(&cache->mutex);
@@ -271,76 +780,25 @@ void mlt_cache_purge(mlt_cache cache, void *object)
     if (!cache)
         return;
     pthread_mutex_lock(&cache->mutex);
-    if (cache && object) {
-        int i, j;
-        void **alt = cache->current == cache->A ? cache->B : cache->A;
-
-        for (i = 0, j = 0; i < cache->count; i++) {
-            void *o = cache->current[i];
-
-            if (o == object) {
-                cache_object_close(cache, o, NULL);
-            } else {
-                alt[j++] = o;
+    if (object) {
+        if (cache->is_frames) {
+            cache_entry entry = cache->lru;
+            while (entry) {
+                cache_entry next = entry->next;
+                if (entry->object == object)
+                    cache_remove(cache, entry);
+                entry = next;
             }
+        } else {
+            cache_entry entry = cache_find(cache, (uintptr_t) object);
+            if (entry)
+                cache_remove(cache, entry);
         }
-        cache->count = j;
-        cache->current = alt;
     }
     pthread_mutex_unlock(&cache->mutex);
 }
 
-/** Shuffle the cache entries between the two arrays and return the cache entry for an object.
- *
- * \private \memberof mlt_cache_s
- * \param cache a cache object
- * \param object the object that owns the cached data
- * \return a cache entry if there was a hit or NULL for a miss
- */
-
-static void **shuffle_get_hit(mlt_cache cache, void *object)
-{
-    int i = cache->count;
-    int j = cache->count - 1;
-    void **hit = NULL;
-    void **alt = cache->current == cache->A ? cache->B : cache->A;
-
-    if (cache->count > 0 && cache->count < cache->size) {
-        // first determine if we have a hit
-        while (i-- && !hit) {
-            void **o = &cache->current[i];
-            if (*o == object)
-                hit = o;
-        }
-        // if there was no hit, we will not be shuffling out an entry
-        // and are still filling the cache
-        if (!hit)
-            ++j;
-        // reset these
-        i = cache->count;
-        hit = NULL;
-    }
-
-    // shuffle the existing entries to the alternate array
-    while (i--) {
-        void **o = &cache->current[i];
-
-        if (!hit && *o == object) {
-            hit = o;
-        } else if (j > 0) {
-            alt[--j] = *o;
-            // 			mlt_log( NULL, MLT_LOG_DEBUG, "%s: shuffle %d = %p\n", __FUNCTION__, j, alt[j] );
-        }
-    }
-    return hit;
-}
-
 /** Put a chunk of data in the cache.
- *
- * This function and mlt_cache_get() are not scalable with a large volume
- * of unique \p object parameter values. Therefore, it does not make sense
- * to use it for a frame/image cache using the frame position for \p object.
- * Instead, use mlt_cache_put_frame() for that.
  *
  * \public \memberof mlt_cache_s
  * \param cache a cache object
@@ -353,26 +811,24 @@ static void **shuffle_get_hit(mlt_cache cache, void *object)
 void mlt_cache_put(mlt_cache cache, void *object, void *data, int size, mlt_destructor destructor)
 {
     pthread_mutex_lock(&cache->mutex);
-    void **hit = shuffle_get_hit(cache, object);
-    void **alt = cache->current == cache->A ? cache->B : cache->A;
+    cache_entry entry = cache_find(cache, (uintptr_t) object);
 
     // add the object to the cache
-    if (hit) {
+    if (entry) {
         // release the old data
-        cache_object_close(cache, *hit, NULL);
+        cache_object_close(cache, object);
         // the MRU end gets the updated data
-        hit = &alt[cache->count - 1];
-    } else if (cache->count < cache->size) {
-        // more room in cache, add it to MRU end
-        hit = &alt[cache->count++];
+        cache_touch(cache, entry);
+        cache_charge(cache, size - entry->cost);
+        entry->cost = size;
     } else {
-        // release the entry at the LRU end
-        cache_object_close(cache, cache->current[0], NULL);
-
-        // The MRU end gets the new item
-        hit = &alt[cache->count - 1];
+        entry = calloc(1, sizeof(struct cache_entry_s));
+        if (entry) {
+            entry->object = object;
+            entry->cost = size;
+            cache_insert(cache, entry);
+        }
     }
-    *hit = object;
     mlt_log(NULL,
             MLT_LOG_DEBUG,
             "%s: put %d = %p, %p\n",
@@ -385,29 +841,30 @@ void mlt_cache_put(mlt_cache cache, void *object, void *data, int size, mlt_dest
     char key[19];
     sprintf(key, "%p", object);
     mlt_cache_item item = mlt_properties_get_data(cache->active, key, NULL);
-    if (!item) {
+    if (!item || (item->refcount > 0 && item->data)) {
+        mlt_cache_item orphan = item;
         item = calloc(1, sizeof(mlt_cache_item_s));
-        if (item)
-            mlt_properties_set_data(cache->active, key, item, 0, free, NULL);
-    }
-    if (item) {
-        // If updating the cache item but not all references are released
-        // copy the item to the garbage collection.
-        if (item->refcount > 0 && item->data) {
-            mlt_cache_item orphan = calloc(1, sizeof(mlt_cache_item_s));
+        if (item) {
+            // If updating the cache item but not all references are released
+            // move the item to the garbage collection with those references.
             if (orphan) {
                 mlt_log(NULL,
                         MLT_LOG_DEBUG,
                         "adding to garbage collection object %p data %p\n",
-                        item->object,
-                        item->data);
-                *orphan = *item;
-                sprintf(key, "%p", orphan->data);
+                        orphan->object,
+                        orphan->data);
+                char data_key[19];
+                sprintf(data_key, "%p", orphan->data);
+                orphan->is_garbage = 1;
                 // We store in the garbage collection by data address, not the owner's!
-                mlt_properties_set_data(cache->garbage, key, orphan, 0, free, NULL);
+                mlt_properties_set_data(cache->garbage, data_key, orphan, 0, free, NULL);
             }
+            mlt_properties_set_data(cache->active, key, item, 0, cache_item_free, NULL);
+        } else {
+            item = orphan;
         }
-
+    }
+    if (item) {
         // Set/update the cache item
         item->cache = cache;
         item->object = object;
@@ -417,9 +874,12 @@ void mlt_cache_put(mlt_cache cache, void *object, void *data, int size, mlt_dest
         item->refcount = 1;
     }
 
-    // swap the current array
-    cache->current = alt;
+    // Make room by releasing the least recently used
+    cache_evict(cache);
+    int is_shared = cache->shared;
     pthread_mutex_unlock(&cache->mutex);
+    if (is_shared)
+        shared_evict(cache);
 }
 
 /** Get a chunk of data from the cache.
@@ -434,16 +894,14 @@ mlt_cache_item mlt_cache_get(mlt_cache cache, void *object)
 {
     mlt_cache_item result = NULL;
     pthread_mutex_lock(&cache->mutex);
-    void **hit = shuffle_get_hit(cache, object);
-    void **alt = cache->current == cache->A ? cache->B : cache->A;
+    cache_entry entry = cache_find(cache, (uintptr_t) object);
 
-    if (hit) {
-        // copy the hit to the MRU end
-        alt[cache->count - 1] = *hit;
-        hit = &alt[cache->count - 1];
+    if (entry) {
+        // move the hit to the MRU end
+        cache_touch(cache, entry);
 
         char key[19];
-        sprintf(key, "%p", *hit);
+        sprintf(key, "%p", object);
         result = mlt_properties_get_data(cache->active, key, NULL);
         if (result && result->data) {
             result->refcount++;
@@ -452,100 +910,101 @@ mlt_cache_item mlt_cache_get(mlt_cache cache, void *object)
                     "%s: get %d = %p, %p\n",
                     __FUNCTION__,
                     cache->count - 1,
-                    *hit,
+                    object,
                     result->data);
         }
-
-        // swap the current array
-        cache->current = alt;
     }
+    int is_shared = cache->shared;
+    int is_hit = result && result->data;
     pthread_mutex_unlock(&cache->mutex);
+    if (is_shared)
+        atomic_fetch_add_explicit(is_hit ? &shared.hits : &shared.misses, 1, memory_order_relaxed);
 
     return result;
 }
 
-/** Shuffle the cache entries between the two arrays and return the frame for a position.
+/** Get the number of bytes held by a cached frame.
  *
  * \private \memberof mlt_cache_s
- * \param cache a cache object
- * \param position the position of the frame that you want
- * \return a frame if there was a hit or NULL for a miss
+ * \param frame a frame
+ * \return the number of bytes of its image, alpha, and audio
  */
 
-static mlt_frame *shuffle_get_frame(mlt_cache cache, mlt_position position)
+static int64_t frame_cost(mlt_frame frame)
 {
-    int i = cache->count;
-    int j = cache->count - 1;
-    mlt_frame *hit = NULL;
-    mlt_frame *alt = (mlt_frame *) (cache->current == cache->A ? cache->B : cache->A);
-
-    if (cache->count > 0 && cache->count < cache->size) {
-        // first determine if we have a hit
-        while (i-- && !hit) {
-            mlt_frame *o = (mlt_frame *) &cache->current[i];
-            if (mlt_frame_original_position(*o) == position)
-                hit = o;
+    mlt_properties properties = MLT_FRAME_PROPERTIES(frame);
+    int64_t cost = 0;
+    int size = 0;
+
+    if (mlt_properties_get_data(properties, "image", &size)) {
+        if (!size) {
+            struct mlt_image_s image;
+            mlt_image_set_values(&image,
+                                 NULL,
+                                 mlt_properties_get_int(properties, "format"),
+                                 mlt_properties_get_int(properties, "width"),
+                                 mlt_properties_get_int(properties, "height"));
+            size = mlt_image_calculate_size(&image);
         }
-        // if there was no hit, we will not be shuffling out an entry
-        // and are still filling the cache
-        if (!hit)
-            ++j;
-        // reset these
-        i = cache->count;
-        hit = NULL;
+        cost += size;
     }
-
-    // shuffle the existing entries to the alternate array
-    while (i--) {
-        mlt_frame *o = (mlt_frame *) &cache->current[i];
-
-        if (!hit && mlt_frame_original_position(*o) == position) {
-            hit = o;
-        } else if (j > 0) {
-            alt[--j] = *o;
-            // 			mlt_log( NULL, MLT_LOG_DEBUG, "%s: shuffle %d = %p\n", __FUNCTION__, j, alt[j] );
-        }
-    }
-    return hit;
+    size = 0;
+    if (mlt_properties_get_data(properties, "alpha", &size))
+        cost += size;
+    size = 0;
+    if (mlt_properties_get_data(properties, "audio", &size))
+        cost += size;
+    return cost;
 }
 
 static void cache_put_frame(mlt_cache cache, mlt_frame frame, int audio, int image)
 {
+    mlt_frame clone = NULL;
+    if (audio && image) {
+        clone = mlt_frame_clone(frame, 1);
+    } else if (audio) {
+        clone = mlt_frame_clone_audio(frame, 1);
+    } else if (image) {
+        clone = mlt_frame_clone_image(frame, 1);
+    }
+    if (!clone)
+        return;
+
     pthread_mutex_lock(&cache->mutex);
-    mlt_frame *hit = shuffle_get_frame(cache, mlt_frame_original_position(frame));
-    mlt_frame *alt = (mlt_frame *) (cache->current == cache->A ? cache->B : cache->A);
+    cache->is_frames = 1;
+    mlt_position position = mlt_frame_original_position(frame);
+    cache_entry entry = cache_find(cache, position);
 
     // add the frame to the cache
-    if (hit) {
+    if (entry) {
         // release the old data
-        mlt_frame_close(*hit);
+        mlt_frame_close(entry->object);
         // the MRU end gets the updated data
-        hit = &alt[cache->count - 1];
-    } else if (cache->count < cache->size) {
-        // more room in cache, add it to MRU end
-        hit = &alt[cache->count++];
+        cache_touch(cache, entry);
+        entry->object = clone;
+        cache_charge(cache, -entry->cost);
+        entry->cost = frame_cost(clone);
+        cache_charge(cache, entry->cost);
     } else {
-        // release the entry at the LRU end
-        mlt_frame_close(cache->current[0]);
-
-        // The MRU end gets the new item
-        hit = &alt[cache->count - 1];
-    }
-    if (audio && image) {
-        *hit = mlt_frame_clone(frame, 1);
-    } else if (audio) {
-        *hit = mlt_frame_clone_audio(frame, 1);
-    } else if (image) {
-        *hit = mlt_frame_clone_image(frame, 1);
+        entry = calloc(1, sizeof(struct cache_entry_s));
+        if (entry) {
+            entry->object = clone;
+            entry->position = position;
+            entry->cost = frame_cost(clone);
+            cache_insert(cache, entry);
+        } else {
+            mlt_frame_close(clone);
+        }
     }
     mlt_log(NULL, MLT_LOG_DEBUG, "%s: put %d = %p\n", __FUNCTION__, cache->count - 1, frame);
 
-    // swap the current array
-    cache->current = (void **) alt;
-    cache->is_frames = 1;
+    // Make room by releasing the least recently used
+    cache_evict(cache);
+    int is_shared = cache->shared;
     pthread_mutex_unlock(&cache->mutex);
+    if (is_shared)
+        shared_evict(cache);
 }
-
 /** Put a frame in the cache with audio and video.
  *
  * Unlike mlt_cache_put() this version is more suitable for caching frames
@@ -615,21 +1074,26 @@ mlt_frame mlt_cache_get_frame(mlt_cache cache, mlt_position position)
 {
     mlt_frame result = NULL;
     pthread_mutex_lock(&cache->mutex);
-    mlt_frame *hit = shuffle_get_frame(cache, position);
-    mlt_frame *alt = (mlt_frame *) (cache->current == cache->A ? cache->B : cache->A);
+    cache_entry entry = cache->is_frames ? cache_find(cache, position) : NULL;
 
-    if (hit) {
-        // copy the hit to the MRU end
-        alt[cache->count - 1] = *hit;
-        hit = &alt[cache->count - 1];
+    if (entry) {
+        // move the hit to the MRU end
+        cache_touch(cache, entry);
 
-        result = mlt_frame_clone(*hit, 1);
-        mlt_log(NULL, MLT_LOG_DEBUG, "%s: get %d = %p\n", __FUNCTION__, cache->count - 1, *hit);
-
-        // swap the current array
-        cache->current = (void **) alt;
+        result = mlt_frame_clone(entry->object, 1);
+        mlt_log(NULL,
+                MLT_LOG_DEBUG,
+                "%s: get %d = %p\n",
+                __FUNCTION__,
+                cache->count - 1,
+                entry->object);
     }
+    int is_shared = cache->shared;
     pthread_mutex_unlock(&cache->mutex);
+    if (is_shared)
+        atomic_fetch_add_explicit(result ? &shared.hits : &shared.misses,
+                                  1,
+                                  memory_order_relaxed);
 
     return result;
 }
@@ -32,6 +32,15 @@ MLT_EXPORT void mlt_cache_item_close(mlt_cache_item item);
 MLT_EXPORT mlt_cache mlt_cache_init();
 MLT_EXPORT void mlt_cache_set_size(mlt_cache cache, int size);
 MLT_EXPORT int mlt_cache_get_size(mlt_cache cache);
+MLT_EXPORT void mlt_cache_set_max_bytes(mlt_cache cache, int64_t bytes);
+MLT_EXPORT int64_t mlt_cache_get_max_bytes(mlt_cache cache);
+MLT_EXPORT int64_t mlt_cache_get_bytes(mlt_cache cache);
+MLT_EXPORT void mlt_cache_share(mlt_cache cache);
+MLT_EXPORT void mlt_cache_set_shared_max_bytes(int64_t bytes);
+MLT_EXPORT int64_t mlt_cache_get_shared_max_bytes();
+MLT_EXPORT int64_t mlt_cache_get_shared_bytes();
+MLT_EXPORT int64_t mlt_cache_get_shared_hits();
+MLT_EXPORT int64_t mlt_cache_get_shared_misses();
 MLT_EXPORT void mlt_cache_close(mlt_cache cache);
 MLT_EXPORT void mlt_cache_purge(mlt_cache cache, void *object);
 MLT_EXPORT void mlt_cache_put(
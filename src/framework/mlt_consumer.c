@@ -26,6 +26,7 @@
 #include "mlt_log.h"
 #include "mlt_producer.h"
 #include "mlt_profile.h"
+#include "mlt_slices.h"
 
 #include <stdatomic.h>
 #include <stdio.h>
@@ -47,6 +48,71 @@
  */
 MLT_EXPORT pthread_mutex_t mlt_sdl_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/** The interned names of the properties read and written for every frame */
+
+static struct
+{
+    mlt_properties_key put_mode;
+    mlt_properties_key test_card_producer;
+    mlt_properties_key rescale;
+    mlt_properties_key progressive;
+    mlt_properties_key deinterlace;
+    mlt_properties_key deinterlacer;
+    mlt_properties_key deinterlace_method;
+    mlt_properties_key top_field_first;
+    mlt_properties_key consumer_progressive;
+    mlt_properties_key consumer_top_field_first;
+    mlt_properties_key color_trc;
+    mlt_properties_key mlt_color_trc;
+    mlt_properties_key channel_layout;
+    mlt_properties_key color_range;
+    mlt_properties_key scale;
+    mlt_properties_key ct_filter;
+    mlt_properties_key speed;
+    mlt_properties_key rendered;
+    mlt_properties_key audio_rendered;
+    mlt_properties_key consumer;
+    mlt_properties_key width;
+    mlt_properties_key height;
+    mlt_properties_key buffer;
+    mlt_properties_key private_buffer;
+    mlt_properties_key prefill;
+    mlt_properties_key drop_max;
+    mlt_properties_key drop_count;
+} keys;
+static pthread_once_t keys_once = PTHREAD_ONCE_INIT;
+
+static void keys_init()
+{
+    keys.put_mode = mlt_properties_intern("put_mode");
+    keys.test_card_producer = mlt_properties_intern("test_card_producer");
+    keys.rescale = mlt_properties_intern("rescale");
+    keys.progressive = mlt_properties_intern("progressive");
+    keys.deinterlace = mlt_properties_intern("deinterlace");
+    keys.deinterlacer = mlt_properties_intern("deinterlacer");
+    keys.deinterlace_method = mlt_properties_intern("deinterlace_method");
+    keys.top_field_first = mlt_properties_intern("top_field_first");
+    keys.consumer_progressive = mlt_properties_intern("consumer.progressive");
+    keys.consumer_top_field_first = mlt_properties_intern("consumer.top_field_first");
+    keys.color_trc = mlt_properties_intern("color_trc");
+    keys.mlt_color_trc = mlt_properties_intern("mlt_color_trc");
+    keys.channel_layout = mlt_properties_intern("channel_layout");
+    keys.color_range = mlt_properties_intern("color_range");
+    keys.scale = mlt_properties_intern("scale");
+    keys.ct_filter = mlt_properties_intern("_ct_filter");
+    keys.speed = mlt_properties_intern("_speed");
+    keys.rendered = mlt_properties_intern("rendered");
+    keys.audio_rendered = mlt_properties_intern("_audio_rendered");
+    keys.consumer = mlt_properties_intern("consumer");
+    keys.width = mlt_properties_intern("width");
+    keys.height = mlt_properties_intern("height");
+    keys.buffer = mlt_properties_intern("buffer");
+    keys.private_buffer = mlt_properties_intern("_buffer");
+    keys.prefill = mlt_properties_intern("prefill");
+    keys.drop_max = mlt_properties_intern("drop_max");
+    keys.drop_count = mlt_properties_intern("drop_count");
+}
+
 /** Determine whether the "ante" and "post" consumer properties are permitted
  * to be executed via system().
  *
@@ -70,15 +136,20 @@ static int ante_post_commands_allowed()
     return e && e[0] && strcmp(e, "0") != 0;
 }
 
-/** mlt_frame_s::is_processing can not be made atomic, so protect it with a mutex.
- */
-MLT_EXPORT pthread_mutex_t mlt_frame_processing_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 /** \brief private members of mlt_consumer */
 
+/** How the render threads and mlt_slices share the CPUs */
+
+typedef enum {
+    parallel_auto,   ///< give each frame a share of the CPUs that depends on the queue depth
+    parallel_frames, ///< render frames in parallel and run their slices serially
+    parallel_slices  ///< render one frame at a time with all of the CPUs for its slices
+} parallel_policy;
+
 typedef struct
 {
     int real_time;
+    parallel_policy parallel_policy;
     atomic_int ahead;
     int preroll;
     mlt_image_format image_format;
@@ -109,6 +180,12 @@ typedef struct
     int process_head;
     atomic_int started;
     pthread_t *threads; /**< used to deallocate all threads */
+    /* the audio rendering thread of parallel_audio */
+    int parallel_audio;
+    mlt_deque audio_queue;
+    pthread_cond_t audio_cond;
+    pthread_t audio_thread;
+    int audio_thread_started;
 } consumer_private;
 
 static void mlt_consumer_property_changed(mlt_properties owner, mlt_consumer self, mlt_event_data);
@@ -133,6 +210,7 @@ static void consumer_read_ahead_start(mlt_consumer self);
 int mlt_consumer_init(mlt_consumer self, void *child, mlt_profile profile)
 {
     int error = 0;
+    pthread_once(&keys_once, keys_init);
     memset(self, 0, sizeof(struct mlt_consumer_s));
     self->child = child;
     consumer_private *priv = self->local = calloc(1, sizeof(consumer_private));
@@ -580,6 +658,23 @@ int mlt_consumer_start(mlt_consumer self)
     // Set the real_time preference
     priv->real_time = mlt_properties_get_int(properties, "real_time");
 
+    // Set how the render threads share the CPUs with the slices
+    const char *policy = mlt_properties_get(properties, "parallel_policy");
+    if (policy && !strcmp(policy, "frames")) {
+        priv->parallel_policy = parallel_frames;
+    } else if (policy && !strcmp(policy, "slices")) {
+        priv->parallel_policy = parallel_slices;
+        if (abs(priv->real_time) > 1)
+            priv->real_time = priv->real_time > 0 ? 1 : -1;
+    } else {
+        priv->parallel_policy = parallel_auto;
+    }
+
+    // Render audio on its own thread, ahead of the image rendering threads
+    priv->parallel_audio = abs(priv->real_time) > 1
+                           && mlt_properties_get_int(properties, "parallel_audio")
+                           && !mlt_properties_get_int(properties, "audio_off");
+
     // For worker threads implementation, buffer must be at least # threads
     if (abs(priv->real_time) > 1
         && mlt_properties_get_int(properties, "buffer") <= abs(priv->real_time))
@@ -667,7 +762,8 @@ mlt_frame mlt_consumer_get_frame(mlt_consumer self)
     mlt_properties properties = MLT_CONSUMER_PROPERTIES(self);
 
     // Get the frame
-    if (mlt_service_producer(service) == NULL && mlt_properties_get_int(properties, "put_mode")) {
+    if (mlt_service_producer(service) == NULL
+        && mlt_properties_get_int_k(properties, keys.put_mode)) {
         struct timeval now;
         struct timespec tm;
         consumer_private *priv = self->local;
@@ -696,66 +792,73 @@ mlt_frame mlt_consumer_get_frame(mlt_consumer self)
         mlt_properties frame_properties = MLT_FRAME_PROPERTIES(frame);
 
         // Get the test card producer
-        mlt_producer test_card = mlt_properties_get_data(properties, "test_card_producer", NULL);
+        mlt_producer test_card = mlt_properties_get_data_k(properties,
+                                                           keys.test_card_producer,
+                                                           NULL);
 
         // Attach the test frame producer to it.
         if (test_card != NULL)
-            mlt_properties_set_data(frame_properties, "test_card_producer", test_card, 0, NULL, NULL);
+            mlt_properties_set_data_k(frame_properties,
+                                      keys.test_card_producer,
+                                      test_card,
+                                      0,
+                                      NULL,
+                                      NULL);
 
         // Pass along the interpolation and deinterlace options
         // TODO: get rid of consumer_deinterlace and use profile.progressive
         mlt_properties_set(frame_properties,
                            "consumer.rescale",
-                           mlt_properties_get(properties, "rescale"));
-        mlt_properties_set_int(frame_properties,
-                               "consumer.progressive",
-                               mlt_properties_get_int(properties, "progressive")
-                                   | mlt_properties_get_int(properties, "deinterlace"));
+                           mlt_properties_get_k(properties, keys.rescale));
+        mlt_properties_set_int_k(frame_properties,
+                                 keys.consumer_progressive,
+                                 mlt_properties_get_int_k(properties, keys.progressive)
+                                     | mlt_properties_get_int_k(properties, keys.deinterlace));
         mlt_properties_set(frame_properties,
                            "consumer.deinterlacer",
-                           mlt_properties_get(properties, "deinterlacer")
-                               ? mlt_properties_get(properties, "deinterlacer")
-                               : mlt_properties_get(properties, "deinterlace_method"));
-        mlt_properties_set_int(frame_properties,
-                               "consumer.top_field_first",
-                               mlt_properties_get_int(properties, "top_field_first"));
+                           mlt_properties_get_k(properties, keys.deinterlacer)
+                               ? mlt_properties_get_k(properties, keys.deinterlacer)
+                               : mlt_properties_get_k(properties, keys.deinterlace_method));
+        mlt_properties_set_int_k(frame_properties,
+                                 keys.consumer_top_field_first,
+                                 mlt_properties_get_int_k(properties, keys.top_field_first));
         mlt_properties_set(frame_properties,
                            "consumer.color_trc",
-                           mlt_properties_get(properties, "color_trc"));
+                           mlt_properties_get_k(properties, keys.color_trc));
         mlt_properties_set(frame_properties,
                            "consumer.mlt_color_trc",
-                           mlt_properties_get(properties, "mlt_color_trc"));
+                           mlt_properties_get_k(properties, keys.mlt_color_trc));
         mlt_properties_set(frame_properties,
                            "consumer.channel_layout",
-                           mlt_properties_get(properties, "channel_layout"));
+                           mlt_properties_get_k(properties, keys.channel_layout));
         mlt_properties_set(frame_properties,
                            "consumer.color_range",
-                           mlt_properties_get(properties, "color_range"));
+                           mlt_properties_get_k(properties, keys.color_range));
         mlt_properties_set(frame_properties,
                            "consumer.scale",
-                           mlt_properties_get(properties, "scale"));
+                           mlt_properties_get_k(properties, keys.scale));
 
-        if (mlt_properties_get(properties, "mlt_color_trc")) {
+        if (mlt_properties_get_k(properties, keys.mlt_color_trc)) {
             // Add a normalize filter to convert the mlt_color_trc to color_trc
-            mlt_filter ct_filter = (mlt_filter) mlt_properties_get_data(properties,
-                                                                        "_ct_filter",
-                                                                        NULL);
+            mlt_filter ct_filter = (mlt_filter) mlt_properties_get_data_k(properties,
+                                                                          keys.ct_filter,
+                                                                          NULL);
             if (!ct_filter) {
                 mlt_profile profile = mlt_service_profile(service);
                 ct_filter = mlt_factory_filter(profile, "color_transform", NULL);
                 if (ct_filter) {
                     mlt_properties cs_properties = MLT_FILTER_PROPERTIES(ct_filter);
-                    const char *color_trc_str = mlt_properties_get(properties, "color_trc");
+                    const char *color_trc_str = mlt_properties_get_k(properties, keys.color_trc);
                     mlt_color_trc trc = mlt_image_color_trc_id(color_trc_str);
                     if (trc == mlt_color_trc_none)
                         trc = mlt_image_default_trc(profile->colorspace);
                     mlt_properties_set_int(cs_properties, "force_trc", trc);
-                    mlt_properties_set_data(properties,
-                                            "_ct_filter",
-                                            ct_filter,
-                                            0,
-                                            (mlt_destructor) mlt_filter_close,
-                                            NULL);
+                    mlt_properties_set_data_k(properties,
+                                              keys.ct_filter,
+                                              ct_filter,
+                                              0,
+                                              (mlt_destructor) mlt_filter_close,
+                                              NULL);
                 }
             }
             if (ct_filter) {
@@ -844,8 +947,8 @@ static void *consumer_read_ahead_thread(void *arg)
 
     // Get the first frame
     frame = mlt_consumer_get_frame(self);
-    if (priv->speed != mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "_speed")) {
-        priv->speed = mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "_speed");
+    if (priv->speed != mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.speed)) {
+        priv->speed = mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.speed);
         // get_frame might want to recalculate the minimum queue size if the speed has changed.
         pthread_cond_broadcast(&priv->queue_cond);
     }
@@ -873,7 +976,7 @@ static void *consumer_read_ahead_thread(void *arg)
         }
 
         // Mark as rendered
-        mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "rendered", 1);
+        mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered, 1);
         last_pos = start_pos = pos = mlt_frame_get_position(frame);
     }
 
@@ -883,8 +986,9 @@ static void *consumer_read_ahead_thread(void *arg)
     // Continue to read ahead
     while (priv->ahead) {
         // Get the maximum size of the buffer
-        int buffer = (priv->speed == 0) ? 1
-                                        : MAX(mlt_properties_get_int(properties, "buffer"), 0) + 1;
+        int buffer = (priv->speed == 0)
+                         ? 1
+                         : MAX(mlt_properties_get_int_k(properties, keys.buffer), 0) + 1;
 
         // Put the current frame into the queue
         pthread_mutex_lock(&priv->queue_mutex);
@@ -908,10 +1012,10 @@ static void *consumer_read_ahead_thread(void *arg)
         if (frame == NULL)
             continue;
         pos = mlt_frame_get_position(frame);
-        priv->speed = mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "_speed");
+        priv->speed = mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.speed);
 
         // WebVfx uses this to setup a consumer-stopping event handler.
-        mlt_properties_set_data(MLT_FRAME_PROPERTIES(frame), "consumer", self, 0, NULL, NULL);
+        mlt_properties_set_data_k(MLT_FRAME_PROPERTIES(frame), keys.consumer, self, 0, NULL, NULL);
 
         // Increment the counter used for averaging processing cost
         count++;
@@ -932,7 +1036,7 @@ static void *consumer_read_ahead_thread(void *arg)
         // All non-normal playback frames should be shown
         if (priv->speed != 1) {
 #ifdef DEINTERLACE_ON_NOT_NORMAL_SPEED
-            mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "consumer.progressive", 1);
+            mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.consumer_progressive, 1);
 #endif
             // Indicate seeking or trick-play
             start_pos = pos;
@@ -942,8 +1046,8 @@ static void *consumer_read_ahead_thread(void *arg)
         if (!skip_next || priv->real_time == -1) {
             if (!video_off) {
                 // Reset width/height - could have been changed by previous mlt_frame_get_image
-                width = mlt_properties_get_int(properties, "width");
-                height = mlt_properties_get_int(properties, "height");
+                width = mlt_properties_get_int_k(properties, keys.width);
+                height = mlt_properties_get_int_k(properties, keys.height);
 
                 // Get the image
                 mlt_events_fire(MLT_CONSUMER_PROPERTIES(self),
@@ -955,7 +1059,7 @@ static void *consumer_read_ahead_thread(void *arg)
             }
 
             // Indicate the rendered image is available.
-            mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "rendered", 1);
+            mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered, 1);
 
             // Reset consecutively-skipped counter
             skipped = 0;
@@ -1053,6 +1157,10 @@ static void *consumer_read_ahead_thread(void *arg)
  * back closer to the head of the queue so that worker threads can work 
  * ahead of the playout point (queue head).
  *
+ * Frames are claimed through mlt_frame_s::is_processing, which belongs to the
+ * consumer that queued the frame, so the caller must hold the queue_mutex of
+ * this consumer only.
+ *
  * \private \memberof mlt_consumer_s
  * \param self a consumer
  * \return an index into the queue
@@ -1062,11 +1170,9 @@ static inline int first_unprocessed_frame(mlt_consumer self)
 {
     consumer_private *priv = self->local;
     int index = priv->real_time <= 0 ? 0 : priv->process_head;
-    pthread_mutex_lock(&mlt_frame_processing_mutex);
     while (index < mlt_deque_count(priv->queue)
            && MLT_FRAME(mlt_deque_peek(priv->queue, index))->is_processing)
         index++;
-    pthread_mutex_unlock(&mlt_frame_processing_mutex);
     return index;
 }
 
@@ -1076,6 +1182,102 @@ static inline int first_unprocessed_frame(mlt_consumer self)
  * \param arg a consumer
  */
 
+/** Render the audio of a frame with the consumer's audio settings.
+ *
+ * The frames must be passed in order to keep the sample counts continuous.
+ * \private \memberof mlt_consumer_s
+ * \param self a consumer
+ * \param frame a frame
+ */
+
+static void consumer_render_audio(mlt_consumer self, mlt_frame frame)
+{
+    consumer_private *priv = self->local;
+    void *audio = NULL;
+    int samples = mlt_audio_calculate_frame_samples(priv->fps,
+                                                    priv->frequency,
+                                                    priv->aud_counter++);
+    mlt_frame_get_audio(frame,
+                        &audio,
+                        &priv->audio_format,
+                        &priv->frequency,
+                        &priv->channels,
+                        &samples);
+}
+
+/** Determine if a queued frame is still waiting for the audio thread.
+ *
+ * The queue_mutex must be held.
+ * \private \memberof mlt_consumer_s
+ * \param priv the private data of a consumer
+ * \param frame a queued frame or NULL
+ * \return true if the image of the frame must not be rendered yet
+ */
+
+static inline int audio_pending(consumer_private *priv, mlt_frame frame)
+{
+    return priv->parallel_audio && frame
+           && !mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.audio_rendered);
+}
+
+/** Add a frame to the work queue of the rendering threads.
+ *
+ * \private \memberof mlt_consumer_s
+ * \param self a consumer
+ * \param frame a frame
+ */
+
+static void consumer_queue_frame(mlt_consumer self, mlt_frame frame)
+{
+    consumer_private *priv = self->local;
+    pthread_mutex_lock(&priv->queue_mutex);
+    mlt_deque_push_back(priv->queue, frame);
+    if (priv->parallel_audio) {
+        mlt_properties_inc_ref(MLT_FRAME_PROPERTIES(frame));
+        mlt_deque_push_back(priv->audio_queue, frame);
+        pthread_cond_signal(&priv->audio_cond);
+    }
+    pthread_cond_signal(&priv->queue_cond);
+    pthread_mutex_unlock(&priv->queue_mutex);
+}
+
+/** The audio rendering thread of parallel_audio.
+ *
+ * Audio is rendered strictly in the order the frames were queued. The image
+ * of a frame is rendered only after its audio, so a frame is never worked on
+ * by two threads at once.
+ * \private \memberof mlt_consumer_s
+ * \param arg a consumer
+ * \return NULL
+ */
+
+static void *consumer_audio_thread(void *arg)
+{
+    mlt_consumer self = arg;
+    consumer_private *priv = self->local;
+
+    while (priv->ahead) {
+        pthread_mutex_lock(&priv->queue_mutex);
+        while (priv->ahead && !mlt_deque_count(priv->audio_queue))
+            pthread_cond_wait(&priv->audio_cond, &priv->queue_mutex);
+        mlt_frame frame = mlt_deque_pop_front(priv->audio_queue);
+        pthread_mutex_unlock(&priv->queue_mutex);
+        if (!frame)
+            continue;
+
+        consumer_render_audio(self, frame);
+
+        // Let the rendering threads and the consumer thread have the frame
+        pthread_mutex_lock(&priv->queue_mutex);
+        mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.audio_rendered, 1);
+        pthread_cond_broadcast(&priv->queue_cond);
+        pthread_mutex_unlock(&priv->queue_mutex);
+        mlt_frame_close(frame);
+    }
+
+    return NULL;
+}
+
 static void *consumer_worker_thread(void *arg)
 {
     // The argument is the consumer
@@ -1099,9 +1301,17 @@ static void *consumer_worker_thread(void *arg)
     mlt_frame frame = NULL;
     uint8_t *image = NULL;
 
+    // The CPUs shared by the render threads and the slices
+    int threads = abs(priv->real_time);
+    int cpus = mlt_slices_count_normal();
+    int pending = 0;
+
     if (preview_off && preview_format != 0)
         format = preview_format;
 
+    if (priv->parallel_policy == parallel_frames)
+        mlt_slices_set_thread_limit(1);
+
     mlt_events_fire(properties, "consumer-thread-started", mlt_event_data_none());
 
     // Continue to read ahead
@@ -1109,7 +1319,9 @@ static void *consumer_worker_thread(void *arg)
         // Get the next unprocessed frame from the work queue
         pthread_mutex_lock(&priv->queue_mutex);
         int index = first_unprocessed_frame(self);
-        while (priv->ahead && index >= mlt_deque_count(priv->queue)) {
+        while (priv->ahead
+               && (index >= mlt_deque_count(priv->queue)
+                   || audio_pending(priv, mlt_deque_peek(priv->queue, index)))) {
             mlt_log_debug(MLT_CONSUMER_SERVICE(self),
                           "waiting in worker index = %d queue count = %d\n",
                           index,
@@ -1127,10 +1339,9 @@ static void *consumer_worker_thread(void *arg)
                           index,
                           mlt_frame_get_position(frame),
                           mlt_deque_count(priv->queue));
-            pthread_mutex_lock(&mlt_frame_processing_mutex);
             frame->is_processing = 1;
-            pthread_mutex_unlock(&mlt_frame_processing_mutex);
             mlt_properties_inc_ref(MLT_FRAME_PROPERTIES(frame));
+            pending = mlt_deque_count(priv->queue) - index;
         }
         pthread_mutex_unlock(&priv->queue_mutex);
 
@@ -1139,25 +1350,29 @@ static void *consumer_worker_thread(void *arg)
             continue;
 
         // WebVfx uses this to setup a consumer-stopping event handler.
-        mlt_properties_set_data(MLT_FRAME_PROPERTIES(frame), "consumer", self, 0, NULL, NULL);
+        mlt_properties_set_data_k(MLT_FRAME_PROPERTIES(frame), keys.consumer, self, 0, NULL, NULL);
 
 #ifdef DEINTERLACE_ON_NOT_NORMAL_SPEED
         // All non normal playback frames should be shown
-        if (mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "_speed") != 1)
-            mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "consumer.progressive", 1);
+        if (mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.speed) != 1)
+            mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.consumer_progressive, 1);
 #endif
 
+        // With fewer frames waiting than threads, the idle threads' CPUs go to the slices
+        if (priv->parallel_policy == parallel_auto)
+            mlt_slices_set_thread_limit(MAX(1, cpus / CLAMP(pending, 1, threads)));
+
         // Get the image
         if (!video_off) {
             // Fetch width/height again
-            width = mlt_properties_get_int(properties, "width");
-            height = mlt_properties_get_int(properties, "height");
+            width = mlt_properties_get_int_k(properties, keys.width);
+            height = mlt_properties_get_int_k(properties, keys.height);
             mlt_events_fire(MLT_CONSUMER_PROPERTIES(self),
                             "consumer-frame-render",
                             mlt_event_data_from_frame(frame));
             mlt_frame_get_image(frame, &image, &format, &width, &height, 0);
         }
-        mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "rendered", 1);
+        mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered, 1);
         mlt_frame_close(frame);
 
         // Tell a waiting thread (non-realtime main consumer thread) that we are done.
@@ -1241,6 +1456,20 @@ static void consumer_work_start(mlt_consumer self)
     pthread_cond_init(&priv->queue_cond, NULL);
     pthread_cond_init(&priv->done_cond, NULL);
 
+    // Start the audio rendering thread
+    if (priv->parallel_audio) {
+        priv->audio_queue = mlt_deque_init();
+        pthread_cond_init(&priv->audio_cond, NULL);
+        priv->audio_thread_started
+            = pthread_create(&priv->audio_thread, NULL, consumer_audio_thread, self) == 0;
+        if (!priv->audio_thread_started) {
+            pthread_cond_destroy(&priv->audio_cond);
+            mlt_deque_close(priv->audio_queue);
+            priv->audio_queue = NULL;
+            priv->parallel_audio = 0;
+        }
+    }
+
     // Create the read ahead
     if (mlt_properties_get(MLT_CONSUMER_PROPERTIES(self), "priority")) {
         struct sched_param priority;
@@ -1351,6 +1580,18 @@ static void consumer_work_stop(mlt_consumer self)
         pthread_t *thread;
         while ((thread = mlt_deque_pop_back(priv->worker_threads)))
             pthread_join(*thread, NULL);
+        if (priv->audio_thread_started) {
+            pthread_mutex_lock(&priv->queue_mutex);
+            pthread_cond_broadcast(&priv->audio_cond);
+            pthread_mutex_unlock(&priv->queue_mutex);
+            pthread_join(priv->audio_thread, NULL);
+            priv->audio_thread_started = 0;
+            pthread_cond_destroy(&priv->audio_cond);
+            while (mlt_deque_count(priv->audio_queue))
+                mlt_frame_close(mlt_deque_pop_back(priv->audio_queue));
+            mlt_deque_close(priv->audio_queue);
+            priv->audio_queue = NULL;
+        }
 
         // Deallocate the array of threads
         free(priv->threads);
@@ -1404,6 +1645,8 @@ void mlt_consumer_purge(mlt_consumer self)
 
         while (priv->started && mlt_deque_count(priv->queue))
             mlt_frame_close(mlt_deque_pop_back(priv->queue));
+        while (priv->started && priv->audio_queue && mlt_deque_count(priv->audio_queue))
+            mlt_frame_close(mlt_deque_pop_back(priv->audio_queue));
 
         if (priv->started && priv->real_time) {
             priv->is_purge = 1;
@@ -1436,17 +1679,15 @@ static mlt_frame worker_get_frame(mlt_consumer self, mlt_properties properties)
     consumer_private *priv = self->local;
     int threads = abs(priv->real_time);
     int audio_off = mlt_properties_get_int(properties, "audio_off");
-    int samples = 0;
-    void *audio = NULL;
-    int buffer = mlt_properties_get_int(properties, "_buffer");
-    buffer = buffer > 0 ? buffer : mlt_properties_get_int(properties, "buffer");
+    int buffer = mlt_properties_get_int_k(properties, keys.private_buffer);
+    buffer = buffer > 0 ? buffer : mlt_properties_get_int_k(properties, keys.buffer);
     // This is a heuristic to determine a suitable minimum buffer size for the number of threads.
     int headroom = (priv->real_time < 0) ? threads : (2 + threads * threads);
     buffer = MAX(buffer, headroom);
 
     // Start worker threads if not already started.
     if (!priv->ahead) {
-        int prefill = mlt_properties_get_int(properties, "prefill");
+        int prefill = mlt_properties_get_int_k(properties, keys.prefill);
         prefill = prefill > 0 && prefill < buffer ? prefill : buffer;
 
         set_audio_format(self);
@@ -1459,28 +1700,21 @@ static mlt_frame worker_get_frame(mlt_consumer self, mlt_properties properties)
             frame = mlt_consumer_get_frame(self);
             if (frame) {
                 // Process the audio
-                if (!audio_off) {
-                    samples = mlt_audio_calculate_frame_samples(priv->fps,
-                                                                priv->frequency,
-                                                                priv->aud_counter++);
-                    mlt_frame_get_audio(frame,
-                                        &audio,
-                                        &priv->audio_format,
-                                        &priv->frequency,
-                                        &priv->channels,
-                                        &samples);
-                }
-                pthread_mutex_lock(&priv->queue_mutex);
-                mlt_deque_push_back(priv->queue, frame);
-                pthread_cond_signal(&priv->queue_cond);
-                pthread_mutex_unlock(&priv->queue_mutex);
-                priv->speed = mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "_speed");
+                if (!audio_off && !priv->parallel_audio)
+                    consumer_render_audio(self, frame);
+                consumer_queue_frame(self, frame);
+                priv->speed = mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.speed);
                 buffer = (priv->speed == 0) ? 1 : buffer;
             }
         }
 
         // Wait for prefill
-        while (priv->ahead && first_unprocessed_frame(self) < prefill) {
+        while (priv->ahead) {
+            pthread_mutex_lock(&priv->queue_mutex);
+            int index = first_unprocessed_frame(self);
+            pthread_mutex_unlock(&priv->queue_mutex);
+            if (index >= prefill)
+                break;
             pthread_mutex_lock(&priv->done_mutex);
             pthread_cond_wait(&priv->done_cond, &priv->done_mutex);
             pthread_mutex_unlock(&priv->done_mutex);
@@ -1496,26 +1730,23 @@ static mlt_frame worker_get_frame(mlt_consumer self, mlt_properties properties)
         frame = mlt_consumer_get_frame(self);
         if (frame) {
             // Process the audio
-            if (!audio_off) {
-                samples = mlt_audio_calculate_frame_samples(priv->fps,
-                                                            priv->frequency,
-                                                            priv->aud_counter++);
-                mlt_frame_get_audio(frame,
-                                    &audio,
-                                    &priv->audio_format,
-                                    &priv->frequency,
-                                    &priv->channels,
-                                    &samples);
-            }
-            pthread_mutex_lock(&priv->queue_mutex);
-            mlt_deque_push_back(priv->queue, frame);
-            pthread_cond_signal(&priv->queue_cond);
-            pthread_mutex_unlock(&priv->queue_mutex);
-            priv->speed = mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "_speed");
+            if (!audio_off && !priv->parallel_audio)
+                consumer_render_audio(self, frame);
+            consumer_queue_frame(self, frame);
+            priv->speed = mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.speed);
             buffer = (priv->speed == 0) ? 1 : buffer;
         }
     }
 
+    // Wait for the audio of the next frame, which is needed even if its image is dropped.
+    if (priv->parallel_audio) {
+        pthread_mutex_lock(&priv->queue_mutex);
+        while (priv->ahead && !priv->is_purge
+               && audio_pending(priv, mlt_deque_peek_front(priv->queue)))
+            pthread_cond_wait(&priv->queue_cond, &priv->queue_mutex);
+        pthread_mutex_unlock(&priv->queue_mutex);
+    }
+
     // Wait if not realtime.
     while (priv->ahead && priv->real_time < 0 && !priv->is_purge
            && !(mlt_properties_get_int(MLT_FRAME_PROPERTIES(
@@ -1537,7 +1768,7 @@ static mlt_frame worker_get_frame(mlt_consumer self, mlt_properties properties)
 
     // Adapt the worker process head to the runtime conditions.
     if (priv->real_time > 0) {
-        if (mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "rendered")) {
+        if (mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered)) {
             priv->consecutive_dropped = 0;
             if (priv->process_head > threads && priv->consecutive_rendered >= priv->process_head)
                 priv->process_head--;
@@ -1554,27 +1785,27 @@ static mlt_frame worker_get_frame(mlt_consumer self, mlt_properties properties)
         //			priv->consecutive_dropped, priv->consecutive_rendered, priv->process_head );
 
         // Check for too many consecutively dropped frames
-        if (priv->consecutive_dropped > mlt_properties_get_int(properties, "drop_max")) {
-            int orig_buffer = mlt_properties_get_int(properties, "buffer");
-            int prefill = mlt_properties_get_int(properties, "prefill");
+        if (priv->consecutive_dropped > mlt_properties_get_int_k(properties, keys.drop_max)) {
+            int orig_buffer = mlt_properties_get_int_k(properties, keys.buffer);
+            int prefill = mlt_properties_get_int_k(properties, keys.prefill);
             mlt_log_verbose(self, "too many frames dropped - ");
 
             // If using a default low-latency buffer level (SDL) and below the limit
             if ((orig_buffer == 1 || prefill == 1) && buffer < (threads + 1) * 10) {
                 // Auto-scale the buffer to compensate
                 mlt_log_verbose(self, "increasing buffer to %d\n", buffer + threads);
-                mlt_properties_set_int(properties, "_buffer", buffer + threads);
+                mlt_properties_set_int_k(properties, keys.private_buffer, buffer + threads);
                 priv->consecutive_dropped = priv->fps / 2;
             } else {
                 // Tell the consumer to render it
                 mlt_log_verbose(self, "forcing next frame\n");
-                mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "rendered", 1);
+                mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered, 1);
                 priv->consecutive_dropped = 0;
             }
         }
-        if (!mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "rendered")) {
-            int dropped = mlt_properties_get_int(properties, "drop_count");
-            mlt_properties_set_int(properties, "drop_count", ++dropped);
+        if (!mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered)) {
+            int dropped = mlt_properties_get_int_k(properties, keys.drop_count);
+            mlt_properties_set_int_k(properties, keys.drop_count, ++dropped);
             mlt_log_verbose(MLT_CONSUMER_SERVICE(self), "dropped video frame %d\n", dropped);
         }
     }
@@ -1612,8 +1843,8 @@ mlt_frame mlt_consumer_rt_frame(mlt_consumer self)
         return worker_get_frame(self, properties);
     } else if (priv->real_time == 1 || priv->real_time == -1) {
         int size = 1;
-        int buffer = mlt_properties_get_int(properties, "buffer");
-        int prefill = mlt_properties_get_int(properties, "prefill");
+        int buffer = mlt_properties_get_int_k(properties, keys.buffer);
+        int prefill = mlt_properties_get_int_k(properties, keys.prefill);
         int preroll_size = prefill > 0 && prefill < buffer ? prefill : buffer;
 
         if (priv->preroll) {
@@ -1643,9 +1874,9 @@ mlt_frame mlt_consumer_rt_frame(mlt_consumer self)
         pthread_cond_broadcast(&priv->queue_cond);
         pthread_mutex_unlock(&priv->queue_mutex);
         if (priv->real_time == 1 && frame
-            && !mlt_properties_get_int(MLT_FRAME_PROPERTIES(frame), "rendered")) {
-            int dropped = mlt_properties_get_int(properties, "drop_count");
-            mlt_properties_set_int(properties, "drop_count", ++dropped);
+            && !mlt_properties_get_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered)) {
+            int dropped = mlt_properties_get_int_k(properties, keys.drop_count);
+            mlt_properties_set_int_k(properties, keys.drop_count, ++dropped);
             mlt_log_verbose(MLT_CONSUMER_SERVICE(self), "dropped video frame %d\n", dropped);
         }
     } else // real_time == 0
@@ -1659,10 +1890,15 @@ mlt_frame mlt_consumer_rt_frame(mlt_consumer self)
 
         // This isn't true, but from the consumers perspective it is
         if (frame != NULL) {
-            mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "rendered", 1);
+            mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(frame), keys.rendered, 1);
 
             // WebVfx uses this to setup a consumer-stopping event handler.
-            mlt_properties_set_data(MLT_FRAME_PROPERTIES(frame), "consumer", self, 0, NULL, NULL);
+            mlt_properties_set_data_k(MLT_FRAME_PROPERTIES(frame),
+                                      keys.consumer,
+                                      self,
+                                      0,
+                                      NULL,
+                                      NULL);
         }
     }
 
@@ -48,6 +48,12 @@
  * other options include: mono, stereo, 5.1, 7.1, etc.
  * \properties \em real_time the asynchronous behavior: 1 (default) for asynchronous
  * with frame dropping, -1 for asynchronous without frame dropping, 0 to disable (synchronous)
+ * \properties \em parallel_policy how the render threads of real_time > 1 or < -1 share the CPUs
+ * with sliced image processing: "frames" runs the slices of each frame on its render thread only,
+ * "slices" renders one frame at a time using all of the CPUs for its slices, and "auto" (default)
+ * gives each frame a share of the CPUs that grows when fewer frames are waiting to be rendered
+ * \properties \em parallel_audio set to 1 with real_time > 1 or < -1 to render audio on a thread of
+ * its own, in frame order and ahead of the image render threads, instead of on the read-ahead thread
  * \properties \em test_card the name of a resource to use as the test card, defaults to
  * environment variable MLT_TEST_CARD. If undefined, the hard-coded default test card is
  * white silence. A test card is what appears when nothing is produced.
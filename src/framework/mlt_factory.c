@@ -274,6 +274,8 @@ char *mlt_environment(const char *name)
 }
 
 /** Set a value in the environment.
+ *
+ * Setting MLT_POOL_BUDGET also changes the memory budget of the pool.
  *
  * \param name the name of a MLT environment variable
  * \param value the value of the variable
@@ -282,6 +284,8 @@ char *mlt_environment(const char *name)
 
 int mlt_environment_set(const char *name, const char *value)
 {
+    if (name && !strcmp(name, "MLT_POOL_BUDGET"))
+        mlt_pool_set_budget(value ? strtoll(value, NULL, 10) : 0);
     if (global_properties)
         return mlt_properties_set(global_properties, name, value);
     else
@@ -522,6 +526,7 @@ void mlt_factory_close()
         }
         free(mlt_directory);
         mlt_directory = NULL;
+        mlt_frame_pool_close();
         mlt_pool_close();
     }
 }
@@ -27,12 +27,153 @@
 #include "mlt_producer.h"
 #include "mlt_profile.h"
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/** The interned names of the frame properties that are used on every frame */
+
+static struct
+{
+    mlt_properties_key position;
+    mlt_properties_key original_position;
+    mlt_properties_key image;
+    mlt_properties_key width;
+    mlt_properties_key height;
+    mlt_properties_key aspect_ratio;
+    mlt_properties_key audio;
+    mlt_properties_key alpha;
+    mlt_properties_key format;
+    mlt_properties_key test_image;
+    mlt_properties_key test_audio;
+    mlt_properties_key image_count;
+    mlt_properties_key audio_format;
+    mlt_properties_key audio_frequency;
+    mlt_properties_key audio_channels;
+    mlt_properties_key audio_samples;
+    mlt_properties_key meta_volume;
+    mlt_properties_key producer;
+} keys;
+static pthread_once_t keys_once = PTHREAD_ONCE_INIT;
+
+static void keys_init()
+{
+    keys.position = mlt_properties_intern("_position");
+    keys.original_position = mlt_properties_intern("original_position");
+    keys.image = mlt_properties_intern("image");
+    keys.width = mlt_properties_intern("width");
+    keys.height = mlt_properties_intern("height");
+    keys.aspect_ratio = mlt_properties_intern("aspect_ratio");
+    keys.audio = mlt_properties_intern("audio");
+    keys.alpha = mlt_properties_intern("alpha");
+    keys.format = mlt_properties_intern("format");
+    keys.test_image = mlt_properties_intern("test_image");
+    keys.test_audio = mlt_properties_intern("test_audio");
+    keys.image_count = mlt_properties_intern("image_count");
+    keys.audio_format = mlt_properties_intern("audio_format");
+    keys.audio_frequency = mlt_properties_intern("audio_frequency");
+    keys.audio_channels = mlt_properties_intern("audio_channels");
+    keys.audio_samples = mlt_properties_intern("audio_samples");
+    keys.meta_volume = mlt_properties_intern("meta.volume");
+    keys.producer = mlt_properties_intern("_producer");
+}
+
+/** The closed frames that can be handed out again by mlt_frame_init() */
+
+#define FRAME_POOL_MAX 256
+
+static struct
+{
+    pthread_mutex_t mutex;
+    int limit;
+    int count;
+    mlt_frame frames[FRAME_POOL_MAX];
+} frame_pool = {PTHREAD_MUTEX_INITIALIZER, 0, 0, {NULL}};
+static pthread_once_t frame_pool_once = PTHREAD_ONCE_INIT;
+
+static void frame_pool_init()
+{
+    const char *value = getenv("MLT_FRAME_POOL");
+    int limit = value ? atoi(value) : 64;
+    frame_pool.limit = CLAMP(limit, 0, FRAME_POOL_MAX);
+}
+
+/** Take a frame from the pool.
+ *
+ * \private \memberof mlt_frame_s
+ * \return a frame that was reset by frame_pool_put() or NULL if the pool is empty
+ */
+
+static mlt_frame frame_pool_get()
+{
+    mlt_frame self = NULL;
+    if (frame_pool.limit > 0) {
+        pthread_mutex_lock(&frame_pool.mutex);
+        if (frame_pool.count > 0)
+            self = frame_pool.frames[--frame_pool.count];
+        pthread_mutex_unlock(&frame_pool.mutex);
+    }
+    return self;
+}
+
+/** Reset a frame that is no longer referenced and return it to the pool.
+ *
+ * The values on the frame are released right away, exactly as when the frame
+ * is destroyed, but the frame, its property table and its stacks are kept.
+ * \private \memberof mlt_frame_s
+ * \param self a frame whose reference count has dropped to zero
+ * \return true if the frame was not pooled and must be destroyed
+ */
+
+static int frame_pool_put(mlt_frame self)
+{
+    if (frame_pool.limit <= 0 || frame_pool.count >= frame_pool.limit)
+        return 1;
+    while (mlt_deque_count(self->stack_image))
+        mlt_deque_pop_back(self->stack_image);
+    while (mlt_deque_count(self->stack_audio))
+        mlt_deque_pop_back(self->stack_audio);
+    while (mlt_deque_peek_back(self->stack_service))
+        mlt_service_close(mlt_deque_pop_back(self->stack_service));
+    while (mlt_deque_count(self->stack_service))
+        mlt_deque_pop_back(self->stack_service);
+    if (mlt_properties_reset(&self->parent))
+        return 1;
+    self->convert_image = mlt_frame_convert_image;
+    self->convert_audio = NULL;
+    self->is_processing = 0;
+
+    pthread_mutex_lock(&frame_pool.mutex);
+    int pooled = frame_pool.count < frame_pool.limit;
+    if (pooled)
+        frame_pool.frames[frame_pool.count++] = self;
+    pthread_mutex_unlock(&frame_pool.mutex);
+    return !pooled;
+}
+
+/** Free a frame and everything on it.
+ *
+ * \private \memberof mlt_frame_s
+ * \param self a frame that is no longer referenced
+ */
+
+static void frame_destroy(mlt_frame self)
+{
+    mlt_deque_close(self->stack_image);
+    mlt_deque_close(self->stack_audio);
+    while (mlt_deque_peek_back(self->stack_service))
+        mlt_service_close(mlt_deque_pop_back(self->stack_service));
+    mlt_deque_close(self->stack_service);
+    mlt_properties_close(&self->parent);
+    free(self);
+}
+
 /** Construct a frame object.
  *
+ * Frames are recycled: mlt_frame_close() releases everything on a frame but
+ * keeps up to 64 empty frames for reuse here. Set the environment variable
+ * MLT_FRAME_POOL to change how many are kept (up to 256), or 0 to disable it.
  * \public \memberof mlt_frame_s
  * \param service the pointer to any service that can provide access to the profile
  * \return a frame object on success or NULL if there was an allocation error
@@ -40,29 +181,40 @@
 
 mlt_frame mlt_frame_init(mlt_service service)
 {
-    // Allocate a frame
-    mlt_frame self = calloc(1, sizeof(struct mlt_frame_s));
+    // Every frame is made here, so the keys are ready for all other frame functions
+    pthread_once(&keys_once, keys_init);
+
+    pthread_once(&frame_pool_once, frame_pool_init);
+
+    // Reuse a closed frame or allocate a new one
+    mlt_frame self = frame_pool_get();
+    int reused = self != NULL;
+    if (!reused)
+        self = calloc(1, sizeof(struct mlt_frame_s));
 
     if (self != NULL) {
         mlt_profile profile = mlt_service_profile(service);
 
         // Initialise the properties
         mlt_properties properties = &self->parent;
-        mlt_properties_init(properties, self);
+        if (!reused)
+            mlt_properties_init(properties, self);
 
         // Set default properties on the frame
-        mlt_properties_set_position(properties, "_position", 0.0);
-        mlt_properties_set_data(properties, "image", NULL, 0, NULL, NULL);
-        mlt_properties_set_int(properties, "width", profile ? profile->width : 720);
-        mlt_properties_set_int(properties, "height", profile ? profile->height : 576);
-        mlt_properties_set_double(properties, "aspect_ratio", mlt_profile_sar(NULL));
-        mlt_properties_set_data(properties, "audio", NULL, 0, NULL, NULL);
-        mlt_properties_set_data(properties, "alpha", NULL, 0, NULL, NULL);
+        mlt_properties_set_position_k(properties, keys.position, 0.0);
+        mlt_properties_set_data_k(properties, keys.image, NULL, 0, NULL, NULL);
+        mlt_properties_set_int_k(properties, keys.width, profile ? profile->width : 720);
+        mlt_properties_set_int_k(properties, keys.height, profile ? profile->height : 576);
+        mlt_properties_set_double_k(properties, keys.aspect_ratio, mlt_profile_sar(NULL));
+        mlt_properties_set_data_k(properties, keys.audio, NULL, 0, NULL, NULL);
+        mlt_properties_set_data_k(properties, keys.alpha, NULL, 0, NULL, NULL);
 
         // Construct stacks for frames and methods
-        self->stack_image = mlt_deque_init();
-        self->stack_audio = mlt_deque_init();
-        self->stack_service = mlt_deque_init();
+        if (!reused) {
+            self->stack_image = mlt_deque_init();
+            self->stack_audio = mlt_deque_init();
+            self->stack_service = mlt_deque_init();
+        }
         self->convert_image = mlt_frame_convert_image;
     }
 
@@ -92,8 +244,8 @@ int mlt_frame_is_test_card(mlt_frame self)
 {
     mlt_properties properties = MLT_FRAME_PROPERTIES(self);
     return (mlt_deque_count(self->stack_image) == 0
-            && !mlt_properties_get_data(properties, "image", NULL))
-           || mlt_properties_get_int(properties, "test_image");
+            && !mlt_properties_get_data_k(properties, keys.image, NULL))
+           || mlt_properties_get_int_k(properties, keys.test_image);
 }
 
 /** Determine if the frame will produce audio from a test card.
@@ -107,8 +259,8 @@ int mlt_frame_is_test_audio(mlt_frame self)
 {
     mlt_properties properties = MLT_FRAME_PROPERTIES(self);
     return (mlt_deque_count(self->stack_audio) == 0
-            && !mlt_properties_get_data(properties, "audio", NULL))
-           || mlt_properties_get_int(properties, "test_audio");
+            && !mlt_properties_get_data_k(properties, keys.audio, NULL))
+           || mlt_properties_get_int_k(properties, keys.test_audio);
 }
 
 /** Get the sample aspect ratio of the frame.
@@ -120,7 +272,7 @@ int mlt_frame_is_test_audio(mlt_frame self)
 
 double mlt_frame_get_aspect_ratio(mlt_frame self)
 {
-    return mlt_properties_get_double(MLT_FRAME_PROPERTIES(self), "aspect_ratio");
+    return mlt_properties_get_double_k(MLT_FRAME_PROPERTIES(self), keys.aspect_ratio);
 }
 
 /** Set the sample aspect ratio of the frame.
@@ -133,7 +285,7 @@ double mlt_frame_get_aspect_ratio(mlt_frame self)
 
 int mlt_frame_set_aspect_ratio(mlt_frame self, double value)
 {
-    return mlt_properties_set_double(MLT_FRAME_PROPERTIES(self), "aspect_ratio", value);
+    return mlt_properties_set_double_k(MLT_FRAME_PROPERTIES(self), keys.aspect_ratio, value);
 }
 
 /** Get the time position of this frame.
@@ -150,7 +302,7 @@ int mlt_frame_set_aspect_ratio(mlt_frame self, double value)
 
 mlt_position mlt_frame_get_position(mlt_frame self)
 {
-    int pos = mlt_properties_get_position(MLT_FRAME_PROPERTIES(self), "_position");
+    int pos = mlt_properties_get_position_k(MLT_FRAME_PROPERTIES(self), keys.position);
     return pos < 0 ? 0 : pos;
 }
 
@@ -165,7 +317,7 @@ mlt_position mlt_frame_get_position(mlt_frame self)
 
 mlt_position mlt_frame_original_position(mlt_frame self)
 {
-    int pos = mlt_properties_get_position(MLT_FRAME_PROPERTIES(self), "original_position");
+    int pos = mlt_properties_get_position_k(MLT_FRAME_PROPERTIES(self), keys.original_position);
     return pos < 0 ? 0 : pos;
 }
 
@@ -180,9 +332,9 @@ mlt_position mlt_frame_original_position(mlt_frame self)
 int mlt_frame_set_position(mlt_frame self, mlt_position value)
 {
     // Only set the original_position the first time.
-    if (!mlt_properties_get(MLT_FRAME_PROPERTIES(self), "original_position"))
-        mlt_properties_set_position(MLT_FRAME_PROPERTIES(self), "original_position", value);
-    return mlt_properties_set_position(MLT_FRAME_PROPERTIES(self), "_position", value);
+    if (!mlt_properties_get_k(MLT_FRAME_PROPERTIES(self), keys.original_position))
+        mlt_properties_set_position_k(MLT_FRAME_PROPERTIES(self), keys.original_position, value);
+    return mlt_properties_set_position_k(MLT_FRAME_PROPERTIES(self), keys.position, value);
 }
 
 /** Stack a get_image callback.
@@ -334,7 +486,12 @@ mlt_deque mlt_frame_service_stack(mlt_frame self)
 
 int mlt_frame_set_image(mlt_frame self, uint8_t *image, int size, mlt_destructor destroy)
 {
-    return mlt_properties_set_data(MLT_FRAME_PROPERTIES(self), "image", image, size, destroy, NULL);
+    return mlt_properties_set_data_k(MLT_FRAME_PROPERTIES(self),
+                                     keys.image,
+                                     image,
+                                     size,
+                                     destroy,
+                                     NULL);
 }
 
 /** Set a new alpha channel on the frame.
@@ -349,7 +506,12 @@ int mlt_frame_set_image(mlt_frame self, uint8_t *image, int size, mlt_destructor
 
 int mlt_frame_set_alpha(mlt_frame self, uint8_t *alpha, int size, mlt_destructor destroy)
 {
-    return mlt_properties_set_data(MLT_FRAME_PROPERTIES(self), "alpha", alpha, size, destroy, NULL);
+    return mlt_properties_set_data_k(MLT_FRAME_PROPERTIES(self),
+                                     keys.alpha,
+                                     alpha,
+                                     size,
+                                     destroy,
+                                     NULL);
 }
 
 /** Replace image stack with the information provided.
@@ -386,10 +548,10 @@ void mlt_frame_replace_image(
         ;
 
     // Update the information
-    mlt_properties_set_data(MLT_FRAME_PROPERTIES(self), "image", image, 0, NULL, NULL);
-    mlt_properties_set_int(MLT_FRAME_PROPERTIES(self), "width", width);
-    mlt_properties_set_int(MLT_FRAME_PROPERTIES(self), "height", height);
-    mlt_properties_set_int(MLT_FRAME_PROPERTIES(self), "format", format);
+    mlt_properties_set_data_k(MLT_FRAME_PROPERTIES(self), keys.image, image, 0, NULL, NULL);
+    mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(self), keys.width, width);
+    mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(self), keys.height, height);
+    mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(self), keys.format, format);
 }
 
 static int generate_test_image(mlt_properties properties,
@@ -419,14 +581,14 @@ static int generate_test_image(mlt_properties properties,
                                mlt_properties_get(properties, "consumer.rescale"));
             error = mlt_frame_get_image(test_frame, buffer, format, width, height, writable);
             if (!error && buffer && *buffer) {
-                mlt_properties_set_double(properties,
-                                          "aspect_ratio",
-                                          mlt_frame_get_aspect_ratio(test_frame));
-                mlt_properties_set_int(properties, "width", *width);
-                mlt_properties_set_int(properties, "height", *height);
+                mlt_properties_set_double_k(properties,
+                                            keys.aspect_ratio,
+                                            mlt_frame_get_aspect_ratio(test_frame));
+                mlt_properties_set_int_k(properties, keys.width, *width);
+                mlt_properties_set_int_k(properties, keys.height, *height);
                 if (mlt_frame_has_convert_image(test_frame) && requested_format != mlt_image_none)
                     mlt_frame_convert_image(test_frame, buffer, format, requested_format);
-                mlt_properties_set_int(properties, "format", *format);
+                mlt_properties_set_int_k(properties, keys.format, *format);
             }
         } else {
             mlt_properties_set_data(properties, "test_card_producer", NULL, 0, NULL, NULL);
@@ -460,19 +622,21 @@ static int generate_test_image(mlt_properties properties,
         mlt_image_set_values(&img, NULL, *format, *width, *height);
         mlt_image_alloc_data(&img);
 
-        if (mlt_properties_get_int(properties, "test_audio")) {
+        if (mlt_properties_get_int_k(properties, keys.test_audio)) {
             const char *color_range = mlt_properties_get(properties, "consumer.color_range");
             mlt_image_fill_white(&img, mlt_image_full_range(color_range));
         } else {
-            mlt_image_fill_checkerboard(&img, mlt_properties_get_double(properties, "aspect_ratio"));
+            mlt_image_fill_checkerboard(&img,
+                                        mlt_properties_get_double_k(properties,
+                                                                    keys.aspect_ratio));
         }
 
         *buffer = img.data;
-        mlt_properties_set_int(properties, "format", *format);
-        mlt_properties_set_int(properties, "width", *width);
-        mlt_properties_set_int(properties, "height", *height);
-        mlt_properties_set_data(properties, "image", *buffer, 0, img.release_data, NULL);
-        mlt_properties_set_int(properties, "test_image", 1);
+        mlt_properties_set_int_k(properties, keys.format, *format);
+        mlt_properties_set_int_k(properties, keys.width, *width);
+        mlt_properties_set_int_k(properties, keys.height, *height);
+        mlt_properties_set_data_k(properties, keys.image, *buffer, 0, img.release_data, NULL);
+        mlt_properties_set_int_k(properties, keys.test_image, 1);
         error = 0;
     }
     return error;
@@ -511,27 +675,27 @@ int mlt_frame_get_image(mlt_frame self,
     int error = 0;
 
     if (get_image) {
-        mlt_properties_set_int(properties,
-                               "image_count",
-                               mlt_properties_get_int(properties, "image_count") - 1);
+        mlt_properties_set_int_k(properties,
+                                 keys.image_count,
+                                 mlt_properties_get_int_k(properties, keys.image_count) - 1);
         error = get_image(self, buffer, format, width, height, writable);
         if (!error && buffer && *buffer) {
-            mlt_properties_set_int(properties, "width", *width);
-            mlt_properties_set_int(properties, "height", *height);
+            mlt_properties_set_int_k(properties, keys.width, *width);
+            mlt_properties_set_int_k(properties, keys.height, *height);
             if (mlt_frame_has_convert_image(self) && requested_format != mlt_image_none)
                 mlt_frame_convert_image(self, buffer, format, requested_format);
-            mlt_properties_set_int(properties, "format", *format);
+            mlt_properties_set_int_k(properties, keys.format, *format);
         } else {
             error = generate_test_image(properties, buffer, format, width, height, writable);
         }
-    } else if (mlt_properties_get_data(properties, "image", NULL) && buffer) {
-        *format = mlt_properties_get_int(properties, "format");
-        *buffer = mlt_properties_get_data(properties, "image", NULL);
-        *width = mlt_properties_get_int(properties, "width");
-        *height = mlt_properties_get_int(properties, "height");
+    } else if (mlt_properties_get_data_k(properties, keys.image, NULL) && buffer) {
+        *format = mlt_properties_get_int_k(properties, keys.format);
+        *buffer = mlt_properties_get_data_k(properties, keys.image, NULL);
+        *width = mlt_properties_get_int_k(properties, keys.width);
+        *height = mlt_properties_get_int_k(properties, keys.height);
         if (mlt_frame_has_convert_image(self) && *buffer && requested_format != mlt_image_none) {
             mlt_frame_convert_image(self, buffer, format, requested_format);
-            mlt_properties_set_int(properties, "format", *format);
+            mlt_properties_set_int_k(properties, keys.format, *format);
         }
     } else {
         error = generate_test_image(properties, buffer, format, width, height, writable);
@@ -552,9 +716,9 @@ uint8_t *mlt_frame_get_alpha(mlt_frame self)
 {
     uint8_t *alpha = NULL;
     if (self != NULL) {
-        alpha = mlt_properties_get_data(&self->parent, "alpha", NULL);
+        alpha = mlt_properties_get_data_k(&self->parent, keys.alpha, NULL);
         if (alpha) {
-            mlt_image_format format = mlt_properties_get_int(&self->parent, "format");
+            mlt_image_format format = mlt_properties_get_int_k(&self->parent, keys.format);
             if (mlt_image_rgba == format || format == mlt_image_rgba64) {
                 alpha = NULL;
             }
@@ -578,9 +742,9 @@ uint8_t *mlt_frame_get_alpha_size(mlt_frame self, int *size)
 {
     uint8_t *alpha = NULL;
     if (self) {
-        alpha = mlt_properties_get_data(&self->parent, "alpha", size);
+        alpha = mlt_properties_get_data_k(&self->parent, keys.alpha, size);
         if (alpha) {
-            mlt_image_format format = mlt_properties_get_int(&self->parent, "format");
+            mlt_image_format format = mlt_properties_get_int_k(&self->parent, keys.format);
             if (mlt_image_rgba == format || mlt_image_rgba64 == format) {
                 alpha = NULL;
                 if (size) {
@@ -622,23 +786,23 @@ int mlt_frame_get_audio(mlt_frame self,
 {
     mlt_get_audio get_audio = mlt_frame_pop_audio(self);
     mlt_properties properties = MLT_FRAME_PROPERTIES(self);
-    int hide = mlt_properties_get_int(properties, "test_audio");
+    int hide = mlt_properties_get_int_k(properties, keys.test_audio);
     mlt_audio_format requested_format = *format;
 
     if (hide == 0 && get_audio != NULL) {
         get_audio(self, buffer, format, frequency, channels, samples);
-        mlt_properties_set_int(properties, "audio_frequency", *frequency);
-        mlt_properties_set_int(properties, "audio_channels", *channels);
-        mlt_properties_set_int(properties, "audio_samples", *samples);
-        mlt_properties_set_int(properties, "audio_format", *format);
+        mlt_properties_set_int_k(properties, keys.audio_frequency, *frequency);
+        mlt_properties_set_int_k(properties, keys.audio_channels, *channels);
+        mlt_properties_set_int_k(properties, keys.audio_samples, *samples);
+        mlt_properties_set_int_k(properties, keys.audio_format, *format);
         if (self->convert_audio && *buffer && requested_format != mlt_audio_none)
             self->convert_audio(self, buffer, format, requested_format);
-    } else if (mlt_properties_get_data(properties, "audio", NULL)) {
-        *buffer = mlt_properties_get_data(properties, "audio", NULL);
-        *format = mlt_properties_get_int(properties, "audio_format");
-        *frequency = mlt_properties_get_int(properties, "audio_frequency");
-        *channels = mlt_properties_get_int(properties, "audio_channels");
-        *samples = mlt_properties_get_int(properties, "audio_samples");
+    } else if (mlt_properties_get_data_k(properties, keys.audio, NULL)) {
+        *buffer = mlt_properties_get_data_k(properties, keys.audio, NULL);
+        *format = mlt_properties_get_int_k(properties, keys.audio_format);
+        *frequency = mlt_properties_get_int_k(properties, keys.audio_frequency);
+        *channels = mlt_properties_get_int_k(properties, keys.audio_channels);
+        *samples = mlt_properties_get_int_k(properties, keys.audio_samples);
         if (self->convert_audio && *buffer && requested_format != mlt_audio_none)
             self->convert_audio(self, buffer, format, requested_format);
     } else {
@@ -647,10 +811,10 @@ int mlt_frame_get_audio(mlt_frame self,
         *channels = *channels <= 0 ? 2 : *channels;
         *frequency = *frequency <= 0 ? 48000 : *frequency;
         *format = *format == mlt_audio_none ? mlt_audio_s16 : *format;
-        mlt_properties_set_int(properties, "audio_frequency", *frequency);
-        mlt_properties_set_int(properties, "audio_channels", *channels);
-        mlt_properties_set_int(properties, "audio_samples", *samples);
-        mlt_properties_set_int(properties, "audio_format", *format);
+        mlt_properties_set_int_k(properties, keys.audio_frequency, *frequency);
+        mlt_properties_set_int_k(properties, keys.audio_channels, *channels);
+        mlt_properties_set_int_k(properties, keys.audio_samples, *samples);
+        mlt_properties_set_int_k(properties, keys.audio_format, *format);
 
         size = mlt_audio_format_size(*format, *samples, *channels);
         if (size)
@@ -659,18 +823,18 @@ int mlt_frame_get_audio(mlt_frame self,
             *buffer = NULL;
         if (*buffer)
             memset(*buffer, 0, size);
-        mlt_properties_set_data(properties,
-                                "audio",
-                                *buffer,
-                                size,
-                                (mlt_destructor) mlt_pool_release,
-                                NULL);
-        mlt_properties_set_int(properties, "test_audio", 1);
+        mlt_properties_set_data_k(properties,
+                                  keys.audio,
+                                  *buffer,
+                                  size,
+                                  (mlt_destructor) mlt_pool_release,
+                                  NULL);
+        mlt_properties_set_int_k(properties, keys.test_audio, 1);
     }
 
     // TODO: This does not belong here
-    if (*format == mlt_audio_s16 && mlt_properties_get(properties, "meta.volume") && *buffer) {
-        double value = mlt_properties_get_double(properties, "meta.volume");
+    if (*format == mlt_audio_s16 && mlt_properties_get_k(properties, keys.meta_volume) && *buffer) {
+        double value = mlt_properties_get_double_k(properties, keys.meta_volume);
 
         if (value == 0.0) {
             memset(*buffer, 0, *samples * *channels * 2);
@@ -703,13 +867,13 @@ int mlt_frame_get_audio(mlt_frame self,
 int mlt_frame_set_audio(
     mlt_frame self, void *buffer, mlt_audio_format format, int size, mlt_destructor destructor)
 {
-    mlt_properties_set_int(MLT_FRAME_PROPERTIES(self), "audio_format", format);
-    return mlt_properties_set_data(MLT_FRAME_PROPERTIES(self),
-                                   "audio",
-                                   buffer,
-                                   size,
-                                   destructor,
-                                   NULL);
+    mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(self), keys.audio_format, format);
+    return mlt_properties_set_data_k(MLT_FRAME_PROPERTIES(self),
+                                     keys.audio,
+                                     buffer,
+                                     size,
+                                     destructor,
+                                     NULL);
 }
 
 /** Get audio on a frame as a waveform image.
@@ -808,7 +972,7 @@ unsigned char *mlt_frame_get_waveform(mlt_frame self, int w, int h)
 mlt_producer mlt_frame_get_original_producer(mlt_frame self)
 {
     if (self != NULL)
-        return mlt_properties_get_data(MLT_FRAME_PROPERTIES(self), "_producer", NULL);
+        return mlt_properties_get_data_k(MLT_FRAME_PROPERTIES(self), keys.producer, NULL);
     return NULL;
 }
 
@@ -820,15 +984,27 @@ mlt_producer mlt_frame_get_original_producer(mlt_frame self)
 
 void mlt_frame_close(mlt_frame self)
 {
-    if (self != NULL && mlt_properties_dec_ref(MLT_FRAME_PROPERTIES(self)) <= 0) {
-        mlt_deque_close(self->stack_image);
-        mlt_deque_close(self->stack_audio);
-        while (mlt_deque_peek_back(self->stack_service))
-            mlt_service_close(mlt_deque_pop_back(self->stack_service));
-        mlt_deque_close(self->stack_service);
-        mlt_properties_close(&self->parent);
-        free(self);
-    }
+    if (self != NULL && mlt_properties_dec_ref(MLT_FRAME_PROPERTIES(self)) <= 0
+        && frame_pool_put(self))
+        frame_destroy(self);
+}
+
+/** Free the frames kept for reuse by mlt_frame_init().
+ *
+ * mlt_factory_close() calls this before it closes the memory pool.
+ * \public \memberof mlt_frame_s
+ */
+
+void mlt_frame_pool_close()
+{
+    mlt_frame frames[FRAME_POOL_MAX];
+    pthread_mutex_lock(&frame_pool.mutex);
+    int count = frame_pool.count;
+    memcpy(frames, frame_pool.frames, count * sizeof(mlt_frame));
+    frame_pool.count = 0;
+    pthread_mutex_unlock(&frame_pool.mutex);
+    while (count > 0)
+        frame_destroy(frames[--count]);
 }
 
 /* ---- Image conversion callback list ---- */
@@ -1137,37 +1313,38 @@ mlt_frame mlt_frame_clone(mlt_frame self, int is_deep)
     mlt_properties_inherit(new_props, properties);
 
     // Carry over some special data properties for the multi consumer.
-    mlt_properties_set_data(new_props,
-                            "_producer",
-                            mlt_frame_get_original_producer(self),
-                            0,
-                            NULL,
-                            NULL);
+    mlt_properties_set_data_k(new_props,
+                              keys.producer,
+                              mlt_frame_get_original_producer(self),
+                              0,
+                              NULL,
+                              NULL);
     mlt_frame_copy_convert_image(new_frame, self);
 
     if (is_deep) {
-        data = mlt_properties_get_data(properties, "audio", &size);
+        data = mlt_properties_get_data_k(properties, keys.audio, &size);
         if (data) {
             if (!size)
-                size = mlt_audio_format_size(mlt_properties_get_int(properties, "audio_format"),
-                                             mlt_properties_get_int(properties, "audio_samples"),
-                                             mlt_properties_get_int(properties, "audio_channels"));
+                size = mlt_audio_format_size(
+                    mlt_properties_get_int_k(properties, keys.audio_format),
+                    mlt_properties_get_int_k(properties, keys.audio_samples),
+                    mlt_properties_get_int_k(properties, keys.audio_channels));
             copy = mlt_pool_alloc(size);
             memcpy(copy, data, size);
-            mlt_properties_set_data(new_props, "audio", copy, size, mlt_pool_release, NULL);
+            mlt_properties_set_data_k(new_props, keys.audio, copy, size, mlt_pool_release, NULL);
         }
         size = 0;
-        data = mlt_properties_get_data(properties, "image", &size);
-        mlt_image_format format = mlt_properties_get_int(properties, "format");
+        data = mlt_properties_get_data_k(properties, keys.image, &size);
+        mlt_image_format format = mlt_properties_get_int_k(properties, keys.format);
         if (data && format != mlt_image_movit && format != mlt_image_private) {
-            int width = mlt_properties_get_int(properties, "width");
-            int height = mlt_properties_get_int(properties, "height");
+            int width = mlt_properties_get_int_k(properties, keys.width);
+            int height = mlt_properties_get_int_k(properties, keys.height);
 
             if (!size)
                 size = mlt_image_format_size(format, width, height, NULL);
             copy = mlt_pool_alloc(size);
             memcpy(copy, data, size);
-            mlt_properties_set_data(new_props, "image", copy, size, mlt_pool_release, NULL);
+            mlt_properties_set_data_k(new_props, keys.image, copy, size, mlt_pool_release, NULL);
 
             size = 0;
             data = mlt_frame_get_alpha_size(self, &size);
@@ -1176,7 +1353,12 @@ mlt_frame mlt_frame_clone(mlt_frame self, int is_deep)
                     size = width * height;
                 copy = mlt_pool_alloc(size);
                 memcpy(copy, data, size);
-                mlt_properties_set_data(new_props, "alpha", copy, size, mlt_pool_release, NULL);
+                mlt_properties_set_data_k(new_props,
+                                          keys.alpha,
+                                          copy,
+                                          size,
+                                          mlt_pool_release,
+                                          NULL);
             };
         }
     } else {
@@ -1190,14 +1372,14 @@ mlt_frame mlt_frame_clone(mlt_frame self, int is_deep)
                                 NULL);
 
         // Copy properties
-        data = mlt_properties_get_data(properties, "audio", &size);
-        mlt_properties_set_data(new_props, "audio", data, size, NULL, NULL);
+        data = mlt_properties_get_data_k(properties, keys.audio, &size);
+        mlt_properties_set_data_k(new_props, keys.audio, data, size, NULL, NULL);
         size = 0;
-        data = mlt_properties_get_data(properties, "image", &size);
-        mlt_properties_set_data(new_props, "image", data, size, NULL, NULL);
+        data = mlt_properties_get_data_k(properties, keys.image, &size);
+        mlt_properties_set_data_k(new_props, keys.image, data, size, NULL, NULL);
         size = 0;
         data = mlt_frame_get_alpha_size(self, &size);
-        mlt_properties_set_data(new_props, "alpha", data, size, NULL, NULL);
+        mlt_properties_set_data_k(new_props, keys.alpha, data, size, NULL, NULL);
     }
 
     return new_frame;
@@ -1227,24 +1409,25 @@ mlt_frame mlt_frame_clone_audio(mlt_frame self, int is_deep)
     mlt_properties_inherit(new_props, properties);
 
     // Carry over some special data properties for the multi consumer.
-    mlt_properties_set_data(new_props,
-                            "_producer",
-                            mlt_frame_get_original_producer(self),
-                            0,
-                            NULL,
-                            NULL);
+    mlt_properties_set_data_k(new_props,
+                              keys.producer,
+                              mlt_frame_get_original_producer(self),
+                              0,
+                              NULL,
+                              NULL);
     mlt_frame_copy_convert_image(new_frame, self);
 
     if (is_deep) {
-        data = mlt_properties_get_data(properties, "audio", &size);
+        data = mlt_properties_get_data_k(properties, keys.audio, &size);
         if (data) {
             if (!size)
-                size = mlt_audio_format_size(mlt_properties_get_int(properties, "audio_format"),
-                                             mlt_properties_get_int(properties, "audio_samples"),
-                                             mlt_properties_get_int(properties, "audio_channels"));
+                size = mlt_audio_format_size(
+                    mlt_properties_get_int_k(properties, keys.audio_format),
+                    mlt_properties_get_int_k(properties, keys.audio_samples),
+                    mlt_properties_get_int_k(properties, keys.audio_channels));
             copy = mlt_pool_alloc(size);
             memcpy(copy, data, size);
-            mlt_properties_set_data(new_props, "audio", copy, size, mlt_pool_release, NULL);
+            mlt_properties_set_data_k(new_props, keys.audio, copy, size, mlt_pool_release, NULL);
         }
     } else {
         // This frame takes a reference on the original frame since the data is a shallow copy.
@@ -1257,8 +1440,8 @@ mlt_frame mlt_frame_clone_audio(mlt_frame self, int is_deep)
                                 NULL);
 
         // Copy properties
-        data = mlt_properties_get_data(properties, "audio", &size);
-        mlt_properties_set_data(new_props, "audio", data, size, NULL, NULL);
+        data = mlt_properties_get_data_k(properties, keys.audio, &size);
+        mlt_properties_set_data_k(new_props, keys.audio, data, size, NULL, NULL);
     }
 
     return new_frame;
@@ -1288,26 +1471,26 @@ mlt_frame mlt_frame_clone_image(mlt_frame self, int is_deep)
     mlt_properties_inherit(new_props, properties);
 
     // Carry over some special data properties for the multi consumer.
-    mlt_properties_set_data(new_props,
-                            "_producer",
-                            mlt_frame_get_original_producer(self),
-                            0,
-                            NULL,
-                            NULL);
+    mlt_properties_set_data_k(new_props,
+                              keys.producer,
+                              mlt_frame_get_original_producer(self),
+                              0,
+                              NULL,
+                              NULL);
     mlt_frame_copy_convert_image(new_frame, self);
 
     if (is_deep) {
-        data = mlt_properties_get_data(properties, "image", &size);
-        mlt_image_format format = mlt_properties_get_int(properties, "format");
+        data = mlt_properties_get_data_k(properties, keys.image, &size);
+        mlt_image_format format = mlt_properties_get_int_k(properties, keys.format);
         if (data && format != mlt_image_movit && format != mlt_image_private) {
-            int width = mlt_properties_get_int(properties, "width");
-            int height = mlt_properties_get_int(properties, "height");
+            int width = mlt_properties_get_int_k(properties, keys.width);
+            int height = mlt_properties_get_int_k(properties, keys.height);
 
             if (!size)
                 size = mlt_image_format_size(format, width, height, NULL);
             copy = mlt_pool_alloc(size);
             memcpy(copy, data, size);
-            mlt_properties_set_data(new_props, "image", copy, size, mlt_pool_release, NULL);
+            mlt_properties_set_data_k(new_props, keys.image, copy, size, mlt_pool_release, NULL);
 
             size = 0;
             data = mlt_frame_get_alpha_size(self, &size);
@@ -1316,7 +1499,12 @@ mlt_frame mlt_frame_clone_image(mlt_frame self, int is_deep)
                     size = width * height;
                 copy = mlt_pool_alloc(size);
                 memcpy(copy, data, size);
-                mlt_properties_set_data(new_props, "alpha", copy, size, mlt_pool_release, NULL);
+                mlt_properties_set_data_k(new_props,
+                                          keys.alpha,
+                                          copy,
+                                          size,
+                                          mlt_pool_release,
+                                          NULL);
             };
         }
     } else {
@@ -1331,11 +1519,11 @@ mlt_frame mlt_frame_clone_image(mlt_frame self, int is_deep)
 
         // Copy properties
         size = 0;
-        data = mlt_properties_get_data(properties, "image", &size);
-        mlt_properties_set_data(new_props, "image", data, size, NULL, NULL);
+        data = mlt_properties_get_data_k(properties, keys.image, &size);
+        mlt_properties_set_data_k(new_props, keys.image, data, size, NULL, NULL);
         size = 0;
         data = mlt_frame_get_alpha_size(self, &size);
-        mlt_properties_set_data(new_props, "alpha", data, size, NULL, NULL);
+        mlt_properties_set_data_k(new_props, keys.alpha, data, size, NULL, NULL);
     }
 
     return new_frame;
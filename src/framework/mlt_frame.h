@@ -181,6 +181,7 @@ MLT_EXPORT void *mlt_frame_pop_audio(mlt_frame self);
 MLT_EXPORT mlt_deque mlt_frame_service_stack(mlt_frame self);
 MLT_EXPORT mlt_producer mlt_frame_get_original_producer(mlt_frame self);
 MLT_EXPORT void mlt_frame_close(mlt_frame self);
+MLT_EXPORT void mlt_frame_pool_close();
 MLT_EXPORT mlt_properties mlt_frame_unique_properties(mlt_frame self, mlt_service service);
 MLT_EXPORT mlt_properties mlt_frame_get_unique_properties(mlt_frame self, mlt_service service);
 MLT_EXPORT void mlt_frame_append_convert_image(mlt_frame self, mlt_convert_image convert);
@@ -48,6 +48,14 @@ struct playlist_entry_s
     int preservation_hack;
 };
 
+/** \brief private members of mlt_playlist_s
+*/
+
+typedef struct
+{
+    mlt_position *starts; /**< the start of each entry followed by the total length */
+} playlist_private;
+
 /* Forward declarations
 */
 
@@ -86,7 +94,11 @@ mlt_playlist mlt_playlist_alloc()
 
         self->size = 10;
         self->list = calloc(self->size, sizeof(playlist_entry *));
-        if (self->list == NULL)
+        playlist_private *priv = producer->local = calloc(1, sizeof(playlist_private));
+        if (self->list == NULL || priv == NULL)
+            goto error2;
+        priv->starts = calloc(self->size + 1, sizeof(mlt_position));
+        if (priv->starts == NULL)
             goto error2;
 
         mlt_events_register(MLT_PLAYLIST_PROPERTIES(self), "playlist-next");
@@ -95,6 +107,9 @@ mlt_playlist mlt_playlist_alloc()
     return self;
 error2:
     free(self->list);
+    if (self->parent.local)
+        free(((playlist_private *) self->parent.local)->starts);
+    free(self->parent.local);
 error1:
     free(self);
     return NULL;
@@ -181,6 +196,7 @@ static int mlt_playlist_virtual_refresh(mlt_playlist self)
 {
     // Obtain the properties
     mlt_properties properties = MLT_PLAYLIST_PROPERTIES(self);
+    playlist_private *priv = self->parent.local;
     int i = 0;
     mlt_position frame_count = 0;
 
@@ -214,8 +230,10 @@ static int mlt_playlist_virtual_refresh(mlt_playlist self)
                                      * self->list[i]->repeat;
 
         // Update the frame_count for self clip
+        priv->starts[i] = frame_count;
         frame_count += self->list[i]->frame_count;
     }
+    priv->starts[self->count] = frame_count;
 
     // Refresh all properties
     mlt_events_block(properties, properties);
@@ -320,10 +338,13 @@ static int mlt_playlist_virtual_append(mlt_playlist self,
     // Check that we have room
     if (self->count >= self->size) {
         int i;
-        self->list = realloc(self->list, (self->size + 10) * sizeof(playlist_entry *));
-        for (i = self->size; i < self->size + 10; i++)
+        int size = self->size * 2;
+        self->list = realloc(self->list, size * sizeof(playlist_entry *));
+        playlist_private *priv = self->parent.local;
+        priv->starts = realloc(priv->starts, (size + 1) * sizeof(mlt_position));
+        for (i = self->size; i < size; i++)
             self->list[i] = NULL;
-        self->size += 10;
+        self->size = size;
     }
 
     // Create the entry
@@ -348,8 +369,29 @@ static int mlt_playlist_virtual_append(mlt_playlist self,
     return mlt_playlist_virtual_refresh(self);
 }
 
+/** Update the start positions of the entries.
+ *
+ * This must be called when the entries are reordered before anything looks up
+ * a position; mlt_playlist_virtual_refresh() does it too.
+ * \private \memberof mlt_playlist_s
+ * \param self a playlist
+ */
+
+static void mlt_playlist_update_starts(mlt_playlist self)
+{
+    playlist_private *priv = self->parent.local;
+    mlt_position start = 0;
+    int i;
+    for (i = 0; i < self->count; i++) {
+        priv->starts[i] = start;
+        start += self->list[i]->frame_count;
+    }
+    priv->starts[self->count] = start;
+}
+
 /** Locate a producer by index.
  *
+ * This bisects the start positions of the entries.
  * \private \memberof mlt_playlist_s
  * \param self a playlist
  * \param[in, out] position the time at which to locate the producer, returns the time relative to the producer's starting point
@@ -363,27 +405,25 @@ static mlt_producer mlt_playlist_locate(mlt_playlist self,
                                         int *clip,
                                         int *total)
 {
-    // Default producer to NULL
-    mlt_producer producer = NULL;
-
-    // Loop for each producer until found
-    for (*clip = 0; *clip < self->count; *clip += 1) {
-        // Increment the total
-        *total += self->list[*clip]->frame_count;
-
-        // Check if the position indicates that we have found the clip
-        // Note that 0 length clips get skipped automatically
-        if (*position < self->list[*clip]->frame_count) {
-            // Found it, now break
-            producer = self->list[*clip]->producer;
-            break;
-        } else {
-            // Decrement position by length of self entry
-            *position -= self->list[*clip]->frame_count;
-        }
+    // Find the first entry that ends after the position
+    // Note that 0 length clips get skipped automatically
+    playlist_private *priv = self->parent.local;
+    int low = 0;
+    int high = self->count;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (*position < priv->starts[middle + 1])
+            high = middle;
+        else
+            low = middle + 1;
     }
 
-    return producer;
+    // Make the position relative to the entry
+    *clip = low;
+    *position -= priv->starts[low];
+    *total += priv->starts[low < self->count ? low + 1 : low];
+
+    return low < self->count ? self->list[low]->producer : NULL;
 }
 
 /** Seek in the virtual playlist.
@@ -495,20 +535,10 @@ static mlt_producer mlt_playlist_virtual_set_out(mlt_playlist self)
 
     // Map playlist position to real producer in virtual playlist
     mlt_position position = mlt_producer_frame(&self->parent);
-
-    // Loop through the virtual playlist
     int i = 0;
+    int total = 0;
 
-    for (i = 0; i < self->count; i++) {
-        if (position < self->list[i]->frame_count) {
-            // Found it, now break
-            producer = self->list[i]->producer;
-            break;
-        } else {
-            // Decrement position by length of this entry
-            position -= self->list[i]->frame_count;
-        }
-    }
+    producer = mlt_playlist_locate(self, &position, &i, &total);
 
     if (!producer) {
         producer = blank_producer(self);
@@ -538,19 +568,10 @@ int mlt_playlist_current_clip(mlt_playlist self)
 {
     // Map playlist position to real producer in virtual playlist
     mlt_position position = mlt_producer_frame(&self->parent);
-
-    // Loop through the virtual playlist
     int i = 0;
+    int total = 0;
 
-    for (i = 0; i < self->count; i++) {
-        if (position < self->list[i]->frame_count) {
-            // Found it, now break
-            break;
-        } else {
-            // Decrement position by length of this entry
-            position -= self->list[i]->frame_count;
-        }
-    }
+    mlt_playlist_locate(self, &position, &i, &total);
 
     return i;
 }
@@ -583,9 +604,8 @@ mlt_producer mlt_playlist_current(mlt_playlist self)
 
 mlt_position mlt_playlist_clip(mlt_playlist self, mlt_whence whence, int index)
 {
-    mlt_position position = 0;
+    playlist_private *priv = self->parent.local;
     int absolute_clip = index;
-    int i = 0;
 
     // Determine the absolute clip
     switch (whence) {
@@ -608,11 +628,7 @@ mlt_position mlt_playlist_clip(mlt_playlist self, mlt_whence whence, int index)
     else if (absolute_clip > self->count)
         absolute_clip = self->count;
 
-    // Now determine the position
-    for (i = 0; i < absolute_clip; i++)
-        position += self->list[i]->frame_count;
-
-    return position;
+    return priv->starts[absolute_clip];
 }
 
 /** Get all the info about the clip specified.
@@ -805,6 +821,7 @@ int mlt_playlist_remove(mlt_playlist self, int where)
         for (i = where + 1; i < self->count; i++)
             self->list[i - 1] = self->list[i];
         self->count--;
+        mlt_playlist_update_starts(self);
 
         if (entry->preservation_hack == 0) {
             // Decouple from mix_in/out if necessary
@@ -896,6 +913,7 @@ int mlt_playlist_move(mlt_playlist self, int src, int dest)
                 self->list[i] = self->list[i + 1];
         }
         self->list[dest] = src_entry;
+        mlt_playlist_update_starts(self);
 
         mlt_playlist_get_clip_info(self, &current_info, current);
         mlt_producer_seek(MLT_PLAYLIST_PRODUCER(self), current_info.start + position);
@@ -2097,6 +2115,7 @@ static int producer_get_frame(mlt_producer producer, mlt_frame_ptr frame, int in
 void mlt_playlist_close(mlt_playlist self)
 {
     if (self != NULL && mlt_properties_dec_ref(MLT_PLAYLIST_PROPERTIES(self)) <= 0) {
+        playlist_private *priv = self->parent.local;
         int i = 0;
         self->parent.close = NULL;
         for (i = 0; i < self->count; i++) {
@@ -2106,6 +2125,8 @@ void mlt_playlist_close(mlt_playlist self)
         }
         mlt_producer_close(&self->parent);
         free(self->list);
+        free(priv->starts);
+        free(priv);
         free(self);
     }
 }
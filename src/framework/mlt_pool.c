@@ -20,14 +20,26 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
-#include "mlt_deque.h"
+// For sched_getcpu
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "mlt_log.h"
+#include "mlt_pool.h"
 #include "mlt_properties.h"
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __linux__
+#include <sched.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#endif
+
 // Not nice - memalign is defined here apparently?
 #ifdef linux
 #include <malloc.h>
@@ -71,24 +83,129 @@ void mlt_pool_release(void *release)
 void mlt_pool_purge() {}
 void mlt_pool_close() {}
 void mlt_pool_stat() {}
+int mlt_pool_get_stats(mlt_pool_stats *stats, int count)
+{
+    return 0;
+}
+void mlt_pool_set_budget(int64_t bytes) {}
+int64_t mlt_pool_get_budget()
+{
+    return 0;
+}
+int64_t mlt_pool_allocated()
+{
+    return 0;
+}
 
 #else
 
-/** global singleton for tracking pools */
+/** the smallest pooled block as a power of 2 */
+#define POOL_MIN_BITS 8
+
+/** the largest pooled block as a power of 2 */
+#define POOL_MAX_BITS 30
+
+/** the number of size classes */
+#define POOL_COUNT (POOL_MAX_BITS - POOL_MIN_BITS + 1)
+
+/** the most bytes a thread may hold in its cache for one size class */
+#define CACHE_MAX_BYTES (16 * 1024 * 1024)
 
-static mlt_properties pools = NULL;
+/** the most blocks a thread may hold in its cache for one size class */
+#define CACHE_MAX_BLOCKS 32
+
+/** the most NUMA nodes with separate depots */
+#define POOL_NODES 8
+
+/** the size of a transparent huge page */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
 /** \brief Pool (memory) class
+ *
+ * Each size class has a depot of free blocks that is shared by all threads.
+ * The depot is an intrusive lock-free stack: the link to the next free block
+ * is stored in the first bytes of the unused block itself. Blocks are pushed
+ * with compare-and-swap, but they are only ever removed by taking the whole
+ * stack at once with an atomic exchange, which avoids the ABA problem.
+ *
+ * Large size classes may be mapped: their blocks are carved from anonymous
+ * memory mappings that are aligned for huge pages. Mapped pools keep a depot
+ * per NUMA node, and a block always returns to the depot of the node that
+ * allocated it, so that a thread reuses memory that is local to it.
  */
 
 typedef struct mlt_pool_s
 {
-    pthread_mutex_t lock; ///< lock to prevent race conditions
-    mlt_deque stack;      ///< a stack of addresses to memory blocks
-    int size;             ///< the size of the memory block as a power of 2
-    int count;            ///< the number of blocks in the pool
+    _Atomic(void *) depot[POOL_NODES]; ///< lock-free stacks of addresses to free memory blocks
+    atomic_int available;              ///< the number of blocks in the depots
+    atomic_int count;                  ///< the number of blocks in the pool
+    atomic_int high_water;             ///< the largest number of blocks in the pool
+    atomic_uint_fast64_t stamp;        ///< the pool clock when a depot was last used
+    int size;                          ///< the size of the memory block as a power of 2
+    int mapped;                        ///< whether blocks are backed by memory mappings
+    int offset;                        ///< the bytes before the release header in a block
 } * mlt_pool;
 
+/** \brief A per-thread cache of free blocks for every size class
+ *
+ * Most allocations and releases are satisfied here without touching any
+ * shared state. When a cache grows past its high-water mark, half of it is
+ * handed back to the depot. The counts are only written by the owning thread
+ * but may be read by others to report statistics.
+ */
+
+typedef struct pool_cache_s
+{
+    void *head[POOL_COUNT];       ///< the top of the list of free blocks per size class
+    atomic_int count[POOL_COUNT]; ///< the number of free blocks per size class
+    int generation;               ///< the trim generation this cache has seen
+    struct pool_cache_s *next;    ///< the next cache in the registry
+} * pool_cache;
+
+/** global singleton for tracking pools */
+
+static struct mlt_pool_s pools[POOL_COUNT];
+
+/** the key for the calling thread's cache */
+
+static pthread_key_t cache_key;
+static int cache_key_valid = 0;
+
+/** the registry of all thread caches, used for statistics */
+
+static pool_cache caches = NULL;
+static pthread_mutex_t caches_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** the memory budget in bytes or 0 for unlimited */
+
+static atomic_int_fast64_t budget = 0;
+
+/** the number of bytes allocated from the system */
+
+static atomic_int_fast64_t allocated = 0;
+
+/** a logical clock to order the use of the depots */
+
+static atomic_uint_fast64_t pool_clock = 0;
+
+/** incremented to ask every thread to return its cache to the depots */
+
+static atomic_int trim_generation = 0;
+
+/** serialises trimming */
+
+static pthread_mutex_t trim_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** the alignment of blocks in mapped pools */
+
+static int pool_alignment = 64;
+
+/** the number of NUMA nodes and the node of each CPU */
+
+static int pool_nodes = 1;
+static int *cpu_nodes = NULL;
+static int cpu_count = 0;
+
 /** \brief private to mlt_pool_s, for tracking items to release
  *
  * Aligned to 16 byte in case we toss buffers to external assembly
@@ -105,34 +222,464 @@ typedef struct __attribute__((aligned(16))) mlt_release_s
 {
     mlt_pool pool;
     int references;
+    int node;
 } * mlt_release;
 
-/** Create a pool.
+/** Get or set the link to the next free block.
  *
  * \private \memberof mlt_pool_s
- * \param size the size of the memory blocks to hold as some power of two
- * \return a new pool object
+ * \param ptr an opaque pointer to an unused block
  */
 
-static mlt_pool pool_init(int size)
+#define pool_next(ptr) (*(void **) (ptr))
+
+/** Get the number of blocks in a thread cache.
+ *
+ * \private \memberof mlt_pool_s
+ */
+
+#define cache_count(cache, index) \
+    atomic_load_explicit(&(cache)->count[index], memory_order_relaxed)
+
+/** Set the number of blocks in a thread cache.
+ *
+ * Only the owning thread writes the count, so this needs no read-modify-write.
+ * \private \memberof mlt_pool_s
+ */
+
+#define cache_set_count(cache, index, value) \
+    atomic_store_explicit(&(cache)->count[index], (value), memory_order_relaxed)
+
+/** Get the high-water mark of a thread cache for a size class.
+ *
+ * \private \memberof mlt_pool_s
+ * \param self a pool
+ * \return the maximum number of blocks a thread may keep, possibly 0
+ */
+
+static inline int pool_cache_limit(mlt_pool self)
 {
-    // Create the pool
-    mlt_pool self = calloc(1, sizeof(struct mlt_pool_s));
+    int limit = CACHE_MAX_BYTES / self->size;
+    return limit > CACHE_MAX_BLOCKS ? CACHE_MAX_BLOCKS : limit;
+}
 
-    // Initialise it
-    if (self != NULL) {
-        // Initialise the mutex
-        pthread_mutex_init(&self->lock, NULL);
+/** Determine the size class for a block size.
+ *
+ * \private \memberof mlt_pool_s
+ * \param size the number of bytes including the release header
+ * \return the index into the pools or -1 if too large
+ */
+
+static inline int pool_index(int size)
+{
+    int bits = POOL_MIN_BITS;
+    if (size > (1 << POOL_MIN_BITS)) {
+#if defined(__GNUC__)
+        bits = 32 - __builtin_clz((unsigned int) size - 1);
+#else
+        while ((1 << bits) < size)
+            bits++;
+#endif
+    }
+    return bits > POOL_MAX_BITS ? -1 : bits - POOL_MIN_BITS;
+}
+
+/** Get the release header of a block.
+ *
+ * \private \memberof mlt_pool_s
+ * \param ptr an opaque pointer
+ */
+
+#define pool_release(ptr) ((mlt_release) ((char *) (ptr) - sizeof(struct mlt_release_s)))
+
+/** Find the NUMA nodes of the CPUs.
+ *
+ * \private \memberof mlt_pool_s
+ */
+
+static void pool_numa_init()
+{
+#ifdef __linux__
+    int node;
+
+    if (cpu_nodes)
+        return;
+    for (node = 0; node < POOL_NODES; node++) {
+        char path[64];
+        int first, last;
+        FILE *file;
+
+        sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+        file = fopen(path, "r");
+        if (!file)
+            break;
+        // The list looks like "0-15,32-47"
+        while (fscanf(file, "%d", &first) == 1) {
+            last = first;
+            if (fgetc(file) == '-') {
+                if (fscanf(file, "%d", &last) != 1)
+                    last = first;
+                fgetc(file);
+            }
+            if (last >= cpu_count) {
+                int *nodes = realloc(cpu_nodes, (last + 1) * sizeof(int));
+                if (!nodes)
+                    break;
+                memset(nodes + cpu_count, 0, (last + 1 - cpu_count) * sizeof(int));
+                cpu_nodes = nodes;
+                cpu_count = last + 1;
+            }
+            for (; first <= last; first++)
+                cpu_nodes[first] = node;
+        }
+        fclose(file);
+    }
+    pool_nodes = node > 1 && cpu_nodes ? node : 1;
+#endif
+}
+
+/** Get the NUMA node of the calling thread.
+ *
+ * \private \memberof mlt_pool_s
+ * \param self a pool
+ * \return the index of the depot to use
+ */
+
+static inline int pool_node(mlt_pool self)
+{
+#ifdef __linux__
+    if (self->mapped && pool_nodes > 1) {
+        int cpu = sched_getcpu();
+        if (cpu >= 0 && cpu < cpu_count)
+            return cpu_nodes[cpu];
+    }
+#endif
+    return 0;
+}
+
+/** Allocate a new block from the system.
+ *
+ * \private \memberof mlt_pool_s
+ * \param self a pool
+ * \return the release header of the block or NULL
+ */
+
+static mlt_release pool_alloc_block(mlt_pool self)
+{
+    char *block = NULL;
+
+#ifdef __linux__
+    if (self->mapped) {
+        // Map an extra huge page so that the block can start on a huge page boundary.
+        // The pages are not touched here, so they are placed on the NUMA node of the
+        // thread that first writes to them.
+        size_t length = (self->size + self->offset + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        char *map = mmap(NULL,
+                         length + HUGE_PAGE_SIZE,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1,
+                         0);
+        if (map != MAP_FAILED) {
+            size_t lead = (HUGE_PAGE_SIZE - ((uintptr_t) map & (HUGE_PAGE_SIZE - 1)))
+                          & (HUGE_PAGE_SIZE - 1);
+            if (lead)
+                munmap(map, lead);
+            if (HUGE_PAGE_SIZE - lead)
+                munmap(map + lead + length, HUGE_PAGE_SIZE - lead);
+            block = map + lead;
+            madvise(block, length, MADV_HUGEPAGE);
+        }
+    } else
+#endif
+        block = mlt_alloc(self->size);
+
+    return block ? (mlt_release)(block + self->offset) : NULL;
+}
+
+/** Push a chain of free blocks onto a depot.
+ *
+ * \private \memberof mlt_pool_s
+ * \param self a pool
+ * \param node the index of the depot
+ * \param head the first block in the chain
+ * \param tail the last block in the chain
+ * \param n the number of blocks in the chain
+ */
 
-        // Create the stack
-        self->stack = mlt_deque_init();
+static void depot_push(mlt_pool self, int node, void *head, void *tail, int n)
+{
+    void *top = atomic_load_explicit(&self->depot[node], memory_order_relaxed);
+    do {
+        pool_next(tail) = top;
+    } while (!atomic_compare_exchange_weak_explicit(&self->depot[node],
+                                                    &top,
+                                                    head,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+    atomic_fetch_add_explicit(&self->available, n, memory_order_relaxed);
+    atomic_store_explicit(&self->stamp,
+                          atomic_fetch_add_explicit(&pool_clock, 1, memory_order_relaxed),
+                          memory_order_relaxed);
+}
 
-        // Assign the size
-        self->size = size;
+/** Push a chain of free blocks onto the depots of their nodes.
+ *
+ * \private \memberof mlt_pool_s
+ * \param self a pool
+ * \param head the first block in the chain
+ * \param tail the last block in the chain
+ * \param n the number of blocks in the chain
+ */
+
+static void depot_push_chain(mlt_pool self, void *head, void *tail, int n)
+{
+    if (self->mapped && pool_nodes > 1) {
+        while (head) {
+            void *next = head != tail ? pool_next(head) : NULL;
+            depot_push(self, pool_release(head)->node, head, head, 1);
+            head = next;
+        }
+    } else {
+        depot_push(self, 0, head, tail, n);
     }
+}
 
-    // Return it
-    return self;
+/** Take every free block from a depot.
+ *
+ * \private \memberof mlt_pool_s
+ * \param self a pool
+ * \param node the index of the depot
+ * \return the first block in the chain or NULL if the depot is empty
+ */
+
+static void *depot_take(mlt_pool self, int node)
+{
+    if (atomic_load_explicit(&self->depot[node], memory_order_relaxed) == NULL)
+        return NULL;
+    return atomic_exchange_explicit(&self->depot[node], NULL, memory_order_acquire);
+}
+
+/** Free a block and update the accounting.
+ *
+ * \private \memberof mlt_pool_s
+ * \param self a pool
+ * \param ptr an opaque pointer to an unused block that is not in any list
+ */
+
+static void pool_free_block(mlt_pool self, void *ptr)
+{
+    char *block = (char *) pool_release(ptr) - self->offset;
+#ifdef __linux__
+    if (self->mapped)
+        munmap(block,
+               (self->size + self->offset + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+    else
+#endif
+        mlt_free(block);
+    atomic_fetch_sub_explicit(&self->count, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&allocated, self->size, memory_order_relaxed);
+}
+
+/** Free the least recently used blocks in the depots.
+ *
+ * Depots are visited from the one used longest ago. Within a depot, the
+ * blocks at the bottom of the stack were released first, so they go first.
+ *
+ * \private \memberof mlt_pool_s
+ * \param bytes the number of bytes to free
+ * \return the number of bytes freed
+ */
+
+static int64_t pool_trim(int64_t bytes)
+{
+    int64_t freed = 0;
+    uint64_t after = 0;
+    int visited = 0;
+
+    pthread_mutex_lock(&trim_mutex);
+    while (freed < bytes && visited < POOL_COUNT) {
+        // Find the depot that was used least recently
+        mlt_pool self = NULL;
+        uint64_t oldest = UINT64_MAX;
+        int i;
+        for (i = 0; i < POOL_COUNT; i++) {
+            uint64_t stamp = atomic_load_explicit(&pools[i].stamp, memory_order_relaxed);
+            if (atomic_load_explicit(&pools[i].available, memory_order_relaxed) > 0
+                && stamp >= after && stamp < oldest) {
+                oldest = stamp;
+                self = &pools[i];
+            }
+        }
+        if (!self)
+            break;
+        after = oldest + 1;
+        visited++;
+
+        int node;
+        for (node = 0; node < POOL_NODES && freed < bytes; node++) {
+            void *head = depot_take(self, node);
+            if (!head)
+                continue;
+
+            // Keep the most recently released blocks on top of the stack
+            int n = 1;
+            void *ptr = head;
+            while (pool_next(ptr)) {
+                ptr = pool_next(ptr);
+                n++;
+            }
+            int drop = (bytes - freed + self->size - 1) / self->size;
+            int keep = n > drop ? n - drop : 0;
+            void *tail = NULL;
+            ptr = head;
+            for (i = 0; i < keep; i++) {
+                tail = ptr;
+                ptr = pool_next(ptr);
+            }
+            atomic_fetch_sub_explicit(&self->available, n, memory_order_relaxed);
+            while (ptr) {
+                void *next = pool_next(ptr);
+                pool_free_block(self, ptr);
+                freed += self->size;
+                ptr = next;
+            }
+            if (tail) {
+                pool_next(tail) = NULL;
+                depot_push(self, node, head, tail, keep);
+            }
+        }
+    }
+    pthread_mutex_unlock(&trim_mutex);
+
+    return freed;
+}
+
+/** Trim the pool if it exceeds the memory budget.
+ *
+ * Threads are asked to return their caches so that their blocks can be
+ * trimmed on a later call.
+ *
+ * \private \memberof mlt_pool_s
+ * \param extra the number of bytes about to be allocated
+ */
+
+static void pool_enforce_budget(int64_t extra)
+{
+    int64_t limit = atomic_load_explicit(&budget, memory_order_relaxed);
+    if (limit > 0) {
+        int64_t excess = atomic_load_explicit(&allocated, memory_order_relaxed) + extra - limit;
+        if (excess > 0 && pool_trim(excess) < excess)
+            atomic_fetch_add_explicit(&trim_generation, 1, memory_order_relaxed);
+    }
+}
+
+/** Determine whether the pool exceeds the memory budget.
+ *
+ * \private \memberof mlt_pool_s
+ * \return true if there is a budget and it is exceeded
+ */
+
+static inline int pool_over_budget()
+{
+    int64_t limit = atomic_load_explicit(&budget, memory_order_relaxed);
+    return limit > 0 && atomic_load_explicit(&allocated, memory_order_relaxed) > limit;
+}
+
+/** Give free blocks from a thread cache back to the depot.
+ *
+ * \private \memberof mlt_pool_s
+ * \param cache a thread cache
+ * \param index the size class
+ * \param keep the number of blocks to leave in the cache
+ */
+
+static void pool_cache_trim(pool_cache cache, int index, int keep)
+{
+    int n = cache_count(cache, index) - keep;
+    if (n > 0) {
+        void *head = cache->head[index];
+        void *tail = head;
+        int i;
+        for (i = 1; i < n; i++)
+            tail = pool_next(tail);
+        cache->head[index] = pool_next(tail);
+        cache_set_count(cache, index, keep);
+        depot_push_chain(&pools[index], head, tail, n);
+    }
+}
+
+/** Give all free blocks from a thread cache back to the depot.
+ *
+ * \private \memberof mlt_pool_s
+ * \param cache a thread cache
+ */
+
+static void pool_cache_flush(pool_cache cache)
+{
+    int i;
+    for (i = 0; i < POOL_COUNT; i++)
+        pool_cache_trim(cache, i, 0);
+}
+
+/** Unregister a thread cache, return its blocks to the depot, and free it.
+ *
+ * This is the destructor of the thread-specific data.
+ *
+ * \private \memberof mlt_pool_s
+ * \param cache a thread cache
+ */
+
+static void pool_cache_close(void *cache)
+{
+    if (cache) {
+        pool_cache *p;
+        pthread_mutex_lock(&caches_mutex);
+        for (p = &caches; *p; p = &(*p)->next) {
+            if (*p == cache) {
+                *p = ((pool_cache) cache)->next;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&caches_mutex);
+        pool_cache_flush(cache);
+        free(cache);
+        pool_enforce_budget(0);
+    }
+}
+
+/** Get the calling thread's cache.
+ *
+ * \private \memberof mlt_pool_s
+ * \param create whether to create the cache if it does not exist
+ * \return a cache or NULL
+ */
+
+static pool_cache pool_cache_get(int create)
+{
+    pool_cache cache = NULL;
+    if (cache_key_valid) {
+        cache = pthread_getspecific(cache_key);
+        if (cache == NULL && create) {
+            cache = calloc(1, sizeof(*cache));
+            if (cache) {
+                cache->generation = atomic_load_explicit(&trim_generation, memory_order_relaxed);
+                pthread_mutex_lock(&caches_mutex);
+                cache->next = caches;
+                caches = cache;
+                pthread_mutex_unlock(&caches_mutex);
+                pthread_setspecific(cache_key, cache);
+            }
+        } else if (cache) {
+            // Return everything if the pool asked for it to enforce the budget
+            int generation = atomic_load_explicit(&trim_generation, memory_order_relaxed);
+            if (cache->generation != generation) {
+                cache->generation = generation;
+                pool_cache_flush(cache);
+            }
+        }
+    }
+    return cache;
 }
 
 /** Get an item from the pool.
@@ -149,35 +696,80 @@ static void *pool_fetch(mlt_pool self)
 
     // Sanity check
     if (self != NULL) {
-        // Lock the pool
-        pthread_mutex_lock(&self->lock);
-
-        // Check if the stack is empty
-        if (mlt_deque_count(self->stack) != 0) {
-            // Pop the top of the stack
-            ptr = mlt_deque_pop_back(self->stack);
+        int index = self - pools;
+        int node = pool_node(self);
+        pool_cache cache = pool_cache_get(1);
+        int cached = cache ? cache_count(cache, index) : 0;
+
+        if (cached > 0) {
+            // Pop the top of the thread's own stack
+            ptr = cache->head[index];
+            cache->head[index] = pool_next(ptr);
+            cache_set_count(cache, index, cached - 1);
+        } else if ((ptr = depot_take(self, node)) != NULL) {
+            // Keep the first block and refill the thread cache from the rest
+            void *rest = pool_next(ptr);
+            int n = 1;
+            int keep = cache ? pool_cache_limit(self) / 2 : 0;
+            while (rest && keep-- > 0) {
+                void *next = pool_next(rest);
+                pool_next(rest) = cache->head[index];
+                cache->head[index] = rest;
+                rest = next;
+                n++;
+            }
+            if (cache)
+                cache_set_count(cache, index, n - 1);
+            atomic_fetch_sub_explicit(&self->available, n, memory_order_relaxed);
+
+            // Return whatever is left to the depot for other threads
+            if (rest) {
+                void *tail = rest;
+                n = 1;
+                while (pool_next(tail)) {
+                    tail = pool_next(tail);
+                    n++;
+                }
+                atomic_fetch_sub_explicit(&self->available, n, memory_order_relaxed);
+                depot_push(self, node, rest, tail, n);
+            }
+        }
 
+        if (ptr != NULL) {
             // Assign the reference
             mlt_release release = (void *) ((char *) ptr - sizeof(struct mlt_release_s));
             release->references = 1;
         } else {
+            // Make room for it within the budget
+            pool_enforce_budget(self->size);
+
             // We need to generate a release item
-            mlt_release release = mlt_alloc(self->size);
+            mlt_release release = pool_alloc_block(self);
 
             // If out of memory, log it, reclaim memory, and try again.
             if (!release && self->size > 0) {
                 mlt_log_fatal(NULL, "[mlt_pool] out of memory\n");
                 mlt_pool_purge();
-                release = mlt_alloc(self->size);
+                release = pool_alloc_block(self);
             }
 
             // Initialise it
             if (release != NULL) {
                 // Increment the number of items allocated to this pool
-                self->count++;
+                int count = atomic_fetch_add_explicit(&self->count, 1, memory_order_relaxed) + 1;
+                int high_water = atomic_load_explicit(&self->high_water, memory_order_relaxed);
+                while (count > high_water
+                       && !atomic_compare_exchange_weak_explicit(&self->high_water,
+                                                                 &high_water,
+                                                                 count,
+                                                                 memory_order_relaxed,
+                                                                 memory_order_relaxed))
+                    ;
+                atomic_fetch_add_explicit(&allocated, self->size, memory_order_relaxed);
 
                 // Assign the pool
                 release->pool = self;
+                release->node = node;
 
                 // Assign the reference
                 release->references = 1;
@@ -188,9 +780,6 @@ static void *pool_fetch(mlt_pool self)
             }
             // cppcheck-suppress memleak
         }
-
-        // Unlock the pool
-        pthread_mutex_unlock(&self->lock);
     }
 
     // Return the generated release object
@@ -214,14 +803,29 @@ static void pool_return(void *ptr)
         mlt_pool self = that->pool;
 
         if (self != NULL) {
-            // Lock the pool
-            pthread_mutex_lock(&self->lock);
-
-            // Push it back onto the stack
-            mlt_deque_push_back(self->stack, ptr);
-
-            // Unlock the pool
-            pthread_mutex_unlock(&self->lock);
+            int index = self - pools;
+            int limit = pool_cache_limit(self);
+            int over_budget = pool_over_budget();
+            pool_cache cache = limit > 0 && !over_budget ? pool_cache_get(1) : NULL;
+
+            if (cache) {
+                // Push it onto the thread's own stack
+                int count = cache_count(cache, index) + 1;
+                pool_next(ptr) = cache->head[index];
+                cache->head[index] = ptr;
+                cache_set_count(cache, index, count);
+
+                // Trim to half when over the high-water mark
+                if (count > limit)
+                    pool_cache_trim(cache, index, limit / 2);
+            } else {
+                // Push it back onto the shared stack
+                depot_push(self, that->node, ptr, ptr, 1);
+
+                // Free idle blocks that do not fit within the budget
+                if (over_budget)
+                    pool_enforce_budget(0);
+            }
 
             return;
         }
@@ -231,7 +835,7 @@ static void pool_return(void *ptr)
     }
 }
 
-/** Destroy a pool.
+/** Free all blocks in the depot of a pool.
  *
  * \private \memberof mlt_pool_s
  * \param self a pool
@@ -239,28 +843,32 @@ static void pool_return(void *ptr)
 
 static void pool_close(mlt_pool self)
 {
-    if (self != NULL) {
-        // We need to free up all items in the pool
-        void *release = NULL;
+    int node;
+
+    for (node = 0; node < POOL_NODES; node++) {
+        void *release = depot_take(self, node);
 
         // Iterate through the stack until depleted
-        while ((release = mlt_deque_pop_back(self->stack)) != NULL) {
+        while (release != NULL) {
+            void *next = pool_next(release);
+
             // We'll free this item now
-            mlt_free((char *) release - sizeof(struct mlt_release_s));
+            atomic_fetch_sub_explicit(&self->available, 1, memory_order_relaxed);
+            pool_free_block(self, release);
+            release = next;
         }
-
-        // We can now close the stack
-        mlt_deque_close(self->stack);
-
-        // Destroy the mutex
-        pthread_mutex_destroy(&self->lock);
-
-        // Close the pool
-        free(self);
     }
 }
 
 /** Initialise the global pool.
+ *
+ * The pool is configured with these environment variables:
+ * - MLT_POOL_BUDGET: the memory budget in bytes
+ * - MLT_POOL_HUGE_THRESHOLD: the block size in bytes from which blocks are
+ *   carved from memory mappings that use transparent huge pages and NUMA
+ *   node local depots (Linux only, default 0 for off)
+ * - MLT_POOL_ALIGNMENT: the alignment in bytes of blocks from memory
+ *   mappings, a power of two from 16 to 4096 (default 64)
  *
  * \public \memberof mlt_pool_s
  */
@@ -269,24 +877,42 @@ void mlt_pool_init()
 {
     // Loop variable used to create the pools
     int i = 0;
+    int64_t threshold = 0;
+
+#ifdef __linux__
+    if (getenv("MLT_POOL_HUGE_THRESHOLD"))
+        threshold = strtoll(getenv("MLT_POOL_HUGE_THRESHOLD"), NULL, 10);
+    if (getenv("MLT_POOL_ALIGNMENT")) {
+        int alignment = atoi(getenv("MLT_POOL_ALIGNMENT"));
+        if (alignment >= 16 && alignment <= 4096 && !(alignment & (alignment - 1)))
+            pool_alignment = alignment;
+    }
+    if (threshold > 0)
+        pool_numa_init();
+#endif
 
     // Create the pools
-    pools = mlt_properties_new();
-
-    // Create the pools
-    for (i = 8; i < 31; i++) {
-        // Each properties item needs a name
-        char name[32];
-
-        // Construct a pool
-        mlt_pool pool = pool_init(1 << i);
+    for (i = 0; i < POOL_COUNT; i++) {
+        int node;
+        for (node = 0; node < POOL_NODES; node++)
+            atomic_init(&pools[i].depot[node], NULL);
+        atomic_init(&pools[i].available, 0);
+        atomic_init(&pools[i].count, 0);
+        atomic_init(&pools[i].high_water, 0);
+        atomic_init(&pools[i].stamp, 0);
+        pools[i].size = 1 << (i + POOL_MIN_BITS);
+        pools[i].mapped = threshold > 0 && pools[i].size >= threshold;
+        pools[i].offset = pools[i].mapped ? pool_alignment - sizeof(struct mlt_release_s) : 0;
+    }
+    atomic_store(&allocated, 0);
 
-        // Generate a name
-        sprintf(name, "%d", i);
+    // Create the thread caches
+    if (!cache_key_valid)
+        cache_key_valid = !pthread_key_create(&cache_key, pool_cache_close);
 
-        // Register with properties
-        mlt_properties_set_data(pools, name, pool, 0, (mlt_destructor) pool_close, NULL);
-    }
+    // Set the budget
+    if (getenv("MLT_POOL_BUDGET"))
+        mlt_pool_set_budget(strtoll(getenv("MLT_POOL_BUDGET"), NULL, 10));
 }
 
 /** Allocate size bytes from the pool.
@@ -297,22 +923,11 @@ void mlt_pool_init()
 
 void *mlt_pool_alloc(int size)
 {
-    // This will be used to obtain the pool to use
-    mlt_pool pool = NULL;
-
-    // Determines the index of the pool to use
-    int index = 8;
-
     // Minimum size pooled is 256 bytes
-    size += sizeof(struct mlt_release_s);
-    while ((1 << index) < size)
-        index++;
-
-    // Now get the pool at the index
-    pool = mlt_properties_get_data_at(pools, index - 8, NULL);
+    int index = pool_index(size + sizeof(struct mlt_release_s));
 
     // Now get the real item
-    return pool_fetch(pool);
+    return index < 0 ? NULL : pool_fetch(&pools[index]);
 }
 
 /** Allocate size bytes from the pool.
@@ -356,33 +971,26 @@ void *mlt_pool_realloc(void *ptr, int size)
 
 /** Purge unused items in the pool.
  *
- * A form of garbage collection.
+ * A form of garbage collection. This frees the blocks in the shared depots
+ * and the calling thread's cache. Other threads return their caches to the
+ * depots the next time they use the pool, or when they exit.
  * \public \memberof mlt_pool_s
  */
 
 void mlt_pool_purge()
 {
     int i = 0;
+    pool_cache cache = pool_cache_get(0);
 
-    // For each pool
-    for (i = 0; i < mlt_properties_count(pools); i++) {
-        // Get the pool
-        mlt_pool self = mlt_properties_get_data_at(pools, i, NULL);
+    atomic_fetch_add_explicit(&trim_generation, 1, memory_order_relaxed);
 
-        // Pointer to unused memory
-        void *release = NULL;
-
-        // Lock the pool
-        pthread_mutex_lock(&self->lock);
+    // For each pool
+    for (i = 0; i < POOL_COUNT; i++) {
+        if (cache)
+            pool_cache_trim(cache, i, 0);
 
         // We'll free all unused items now
-        while ((release = mlt_deque_pop_back(self->stack)) != NULL) {
-            mlt_free((char *) release - sizeof(struct mlt_release_s));
-            self->count--;
-        }
-
-        // Unlock the pool
-        pthread_mutex_unlock(&self->lock);
+        pool_close(&pools[i]);
     }
 }
 
@@ -409,41 +1017,131 @@ void mlt_pool_close()
     mlt_pool_stat();
 #endif
 
-    // Close the properties
-    mlt_properties_close(pools);
+    // Free the unused blocks
+    mlt_pool_purge();
+
+    // Drop the calling thread's cache
+    if (cache_key_valid) {
+        pool_cache_close(pool_cache_get(0));
+        pthread_setspecific(cache_key, NULL);
+    }
+}
+
+/** Get the memory usage of each size class.
+ *
+ * The values are sampled without stopping other threads, so they are only
+ * approximate while the pool is in use.
+ *
+ * \public \memberof mlt_pool_s
+ * \param stats an array to receive the statistics, may be NULL
+ * \param count the number of elements in \p stats
+ * \return the number of size classes
+ */
+
+int mlt_pool_get_stats(mlt_pool_stats *stats, int count)
+{
+    int i;
+    pool_cache cache;
+
+    if (count > POOL_COUNT)
+        count = POOL_COUNT;
+    for (i = 0; stats && i < count; i++) {
+        mlt_pool pool = &pools[i];
+        int total = atomic_load_explicit(&pool->count, memory_order_relaxed);
+        int idle = atomic_load_explicit(&pool->available, memory_order_relaxed);
+        stats[i].size = pool->size - sizeof(struct mlt_release_s);
+        stats[i].free = idle;
+        stats[i].live = total;
+        stats[i].high_water = atomic_load_explicit(&pool->high_water, memory_order_relaxed);
+    }
+    if (stats && count > 0) {
+        pthread_mutex_lock(&caches_mutex);
+        for (cache = caches; cache; cache = cache->next)
+            for (i = 0; i < count; i++)
+                stats[i].free += cache_count(cache, i);
+        pthread_mutex_unlock(&caches_mutex);
+    }
+    for (i = 0; stats && i < count; i++) {
+        int64_t size = pools[i].size;
+        if (stats[i].free > stats[i].live)
+            stats[i].free = stats[i].live;
+        stats[i].live = (stats[i].live - stats[i].free) * size;
+        stats[i].free *= size;
+        stats[i].high_water *= size;
+    }
+
+    return POOL_COUNT;
+}
+
+/** Set the memory budget.
+ *
+ * When the memory allocated by the pool would exceed the budget, idle blocks
+ * are freed in least recently used order. Blocks in use are never freed, so
+ * the budget is exceeded when they alone need more.
+ *
+ * \public \memberof mlt_pool_s
+ * \param bytes the maximum number of bytes or 0 for unlimited
+ */
+
+void mlt_pool_set_budget(int64_t bytes)
+{
+    atomic_store(&budget, bytes > 0 ? bytes : 0);
+    pool_enforce_budget(0);
+}
+
+/** Get the memory budget.
+ *
+ * \public \memberof mlt_pool_s
+ * \return the maximum number of bytes or 0 for unlimited
+ */
+
+int64_t mlt_pool_get_budget()
+{
+    return atomic_load(&budget);
+}
+
+/** Get the number of bytes the pool has allocated from the system.
+ *
+ * \public \memberof mlt_pool_s
+ * \return the number of bytes in use and idle
+ */
+
+int64_t mlt_pool_allocated()
+{
+    return atomic_load(&allocated);
 }
 
 void mlt_pool_stat()
 {
     // Stats dump
-    uint64_t allocated = 0, used = 0, s;
-    int i = 0, c = mlt_properties_count(pools);
+    mlt_pool_stats stats[POOL_COUNT];
+    uint64_t total = 0, used = 0;
+    int i = 0, c = mlt_pool_get_stats(stats, POOL_COUNT);
 
     mlt_log(NULL, MLT_LOG_VERBOSE, "%s: count %d\n", __FUNCTION__, c);
 
     for (i = 0; i < c; i++) {
-        mlt_pool pool = mlt_properties_get_data_at(pools, i, NULL);
-        if (pool->count)
+        if (stats[i].live || stats[i].free)
             mlt_log_verbose(NULL,
-                            "%s: size %d allocated %d returned %d %c\n",
+                            "%s: size %d live %" PRId64 " free %" PRId64 " high water %" PRId64
+                            " %c\n",
                             __FUNCTION__,
-                            pool->size,
-                            pool->count,
-                            mlt_deque_count(pool->stack),
-                            pool->count != mlt_deque_count(pool->stack) ? '*' : ' ');
-        s = pool->size;
-        s *= pool->count;
-        allocated += s;
-        s = pool->count - mlt_deque_count(pool->stack);
-        s *= pool->size;
-        used += s;
+                            pools[i].size,
+                            stats[i].live,
+                            stats[i].free,
+                            stats[i].high_water,
+                            stats[i].live ? '*' : ' ');
+        total += stats[i].live + stats[i].free;
+        used += stats[i].live;
     }
 
     mlt_log_verbose(NULL,
-                    "%s: allocated %" PRIu64 " bytes, used %" PRIu64 " bytes \n",
+                    "%s: allocated %" PRIu64 " bytes, used %" PRIu64 " bytes, budget %" PRId64
+                    " bytes\n",
                     __FUNCTION__,
-                    allocated,
-                    used);
+                    total,
+                    used,
+                    mlt_pool_get_budget());
 }
 
 #endif // NO_MLT_POOL
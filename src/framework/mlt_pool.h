@@ -3,7 +3,7 @@
  * \brief memory pooling functionality
  * \see mlt_pool_s
  *
- * Copyright (C) 2003-2014 Meltytech, LLC
+ * Copyright (C) 2003-2026 Meltytech, LLC
  *
  * This library is free software; you can redistribute it and/or
  * modify it under the terms of the GNU Lesser General Public
@@ -24,6 +24,18 @@
 #define MLT_POOL_H
 
 #include "mlt_export.h"
+#include <stdint.h>
+
+/** \brief The memory usage of one size class of the pool */
+
+typedef struct
+{
+    int size;           /**< the usable size of the blocks in bytes */
+    int64_t live;       /**< the bytes in blocks that are in use */
+    int64_t free;       /**< the bytes in idle blocks kept by the pool */
+    int64_t high_water; /**< the most bytes that were allocated at once */
+} mlt_pool_stats;
+
 MLT_EXPORT void mlt_pool_init();
 MLT_EXPORT void *mlt_pool_alloc(int size);
 MLT_EXPORT void *mlt_pool_realloc(void *ptr, int size);
@@ -31,5 +43,9 @@ MLT_EXPORT void mlt_pool_release(void *release);
 MLT_EXPORT void mlt_pool_purge();
 MLT_EXPORT void mlt_pool_close();
 MLT_EXPORT void mlt_pool_stat();
+MLT_EXPORT int mlt_pool_get_stats(mlt_pool_stats *stats, int count);
+MLT_EXPORT void mlt_pool_set_budget(int64_t bytes);
+MLT_EXPORT int64_t mlt_pool_get_budget();
+MLT_EXPORT int64_t mlt_pool_allocated();
 
 #endif
@@ -56,9 +56,12 @@ typedef struct
     unsigned int used;
 
     char **name;
+    unsigned int *hash;
+    mlt_properties_key *key;
     mlt_property *value;
     int count;
     int size;
+    mlt_property_arena arena;
     mlt_properties mirror;
     int ref_count;
     pthread_mutex_t mutex;
@@ -68,6 +71,30 @@ typedef struct
     int children_count;
 } property_list;
 
+/** \brief An interned property name
+ *
+ * Keys are created once by mlt_properties_intern() and live until the process
+ * exits. Each name has exactly one key, so keys can be compared by address.
+ */
+
+struct mlt_properties_key_s
+{
+    char *name;        ///< the property name
+    unsigned int hash; ///< the hash of the name
+};
+
+/** the table of interned keys */
+
+static mlt_properties_key *keys = NULL;
+static unsigned int keys_mask = 0;
+static unsigned int keys_count = 0;
+static pthread_mutex_t keys_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** keys used by the properties class itself */
+
+static mlt_properties_key key_profile = NULL;
+static pthread_once_t key_profile_once = PTHREAD_ONCE_INIT;
+
 /* Memory leak checks */
 
 //#define _MLT_PROPERTY_CHECKS_ 2
@@ -344,6 +371,97 @@ static inline unsigned int generate_hash(const char *name)
     return hash;
 }
 
+/** Get the key for a property name.
+ *
+ * The key holds the name and its precomputed hash. Use it with the functions
+ * that end in _k, for example mlt_properties_get_int_k(), to skip hashing the
+ * name on every call and to compare names by address. Get keys once, for
+ * example when a service is initialized, not on every frame.
+ * \public \memberof mlt_properties_s
+ * \param name a property name
+ * \return the key, which is never freed, or NULL on error
+ */
+
+mlt_properties_key mlt_properties_intern(const char *name)
+{
+    if (!name)
+        return NULL;
+
+    unsigned int hash = generate_hash(name);
+    mlt_properties_key result = NULL;
+
+    pthread_mutex_lock(&keys_mutex);
+
+    // Grow the table to keep the load factor below 0.5
+    if (keys_count * 2 >= keys_mask) {
+        unsigned int capacity = keys_mask ? (keys_mask + 1) * 2 : 256;
+        mlt_properties_key *table = calloc(capacity, sizeof(mlt_properties_key));
+        if (table) {
+            for (unsigned int i = 0; keys && i <= keys_mask; i++) {
+                if (keys[i]) {
+                    unsigned int j = keys[i]->hash & (capacity - 1);
+                    while (table[j])
+                        j = (j + 1) & (capacity - 1);
+                    table[j] = keys[i];
+                }
+            }
+            free(keys);
+            keys = table;
+            keys_mask = capacity - 1;
+        }
+    }
+
+    if (keys) {
+        unsigned int i = hash & keys_mask;
+        while (keys[i] && (keys[i]->hash != hash || strcmp(keys[i]->name, name)))
+            i = (i + 1) & keys_mask;
+        if (!keys[i]) {
+            struct mlt_properties_key_s *key = malloc(sizeof(struct mlt_properties_key_s));
+            if (key) {
+                key->name = strdup(name);
+                key->hash = hash;
+                keys[i] = key;
+                keys_count++;
+            }
+        }
+        result = keys[i];
+    }
+
+    pthread_mutex_unlock(&keys_mutex);
+
+    return result;
+}
+
+/** Get the name of a key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param key a key from mlt_properties_intern()
+ * \return the property name
+ */
+
+const char *mlt_properties_key_name(mlt_properties_key key)
+{
+    return key ? key->name : NULL;
+}
+
+static void key_profile_init()
+{
+    key_profile = mlt_properties_intern("_profile");
+}
+
+/** Get the frame rate of the profile associated with a properties list.
+ *
+ * \private \memberof mlt_properties_s
+ * \param self a properties list
+ * \return the frames per second or 0 if there is no profile
+ */
+
+static double properties_fps(mlt_properties self)
+{
+    pthread_once(&key_profile_once, key_profile_init);
+    return mlt_profile_fps(mlt_properties_get_data_k(self, key_profile, NULL));
+}
+
 /** Insert an index into the hash bucket array using linear probing.
  *
  * This internal helper handles collisions by searching for the next 
@@ -351,12 +469,11 @@ static inline unsigned int generate_hash(const char *name)
  * \private \memberof mlt_properties_s
  * \param buckets pointer to the array of hash buckets
  * \param mask bitmask for fast modulo operation (capacity - 1)
- * \param name the string key to hash
+ * \param hash the hash of the name
  * \param index the index value to store in the bucket
  */
-static void hash_insert(int *buckets, unsigned int mask, const char *name, int index)
+static void hash_insert(int *buckets, unsigned int mask, unsigned int hash, int index)
 {
-    unsigned int hash = generate_hash(name);
     unsigned int i = hash & mask;
 
     while (buckets[i] != -1) {
@@ -392,7 +509,7 @@ static void check_rehash(property_list *list)
                 // Rehash existing items into the new bucket array
                 for (int i = 0; i < list->count; i++) {
                     if (list->name[i])
-                        hash_insert(new_buckets, new_mask, list->name[i], i);
+                        hash_insert(new_buckets, new_mask, list->hash[i], i);
                 }
                 free(list->buckets);
             }
@@ -604,19 +721,46 @@ int mlt_properties_pass(mlt_properties self, mlt_properties that, const char *pr
     return 0;
 }
 
-/** Locate a property by name.
+/** Determine if an entry of the list has a name.
+ *
+ * Entries that were found by key before remember the key, so the next lookup
+ * is a pointer comparison.
+ * \private \memberof mlt_properties_s
+ * \param list a property list
+ * \param index the index of the entry
+ * \param name the property name
+ * \param hash the hash of the name
+ * \param key the key for the name or NULL
+ * \return true if the entry has the name
+ */
+
+static inline int properties_match(
+    property_list *list, int index, const char *name, unsigned int hash, mlt_properties_key key)
+{
+    if (key && list->key[index] == key)
+        return 1;
+    if (list->hash[index] != hash || !list->name[index] || strcmp(list->name[index], name))
+        return 0;
+    if (key)
+        list->key[index] = key;
+    return 1;
+}
+
+/** Locate a property by name and hash.
  *
  * \private \memberof mlt_properties_s
  * \param self a properties list
  * \param name the property to lookup by name
+ * \param hash the hash of the name
+ * \param key the key for the name or NULL
  * \return the property or NULL for failure
  */
 
-static inline mlt_property mlt_properties_find(mlt_properties self, const char *name)
+static mlt_property properties_lookup(mlt_properties self,
+                                      const char *name,
+                                      unsigned int hash,
+                                      mlt_properties_key key)
 {
-    if (!self || !name)
-        return NULL;
-
     property_list *list = self->local;
     mlt_property value = NULL;
 
@@ -624,13 +768,12 @@ static inline mlt_property mlt_properties_find(mlt_properties self, const char *
 
     // If the hash table is active, it is the authoritative source for O(1) lookups.
     if (list->buckets) {
-        unsigned int hash = generate_hash(name);
         unsigned int i = hash & list->mask;
 
         // Linear probing: traverse the bucket array until an empty slot (-1) is found
         while (list->buckets[i] != -1) {
             int index = list->buckets[i];
-            if (list->name[index] && !strcmp(list->name[index], name)) {
+            if (properties_match(list, index, name, hash, key)) {
                 value = list->value[index];
                 mlt_properties_unlock(self);
                 return value;
@@ -645,7 +788,7 @@ static inline mlt_property mlt_properties_find(mlt_properties self, const char *
 
     // Fallback Linear Search
     for (int i = list->count - 1; i >= 0; i--) {
-        if (list->name[i] && !strcmp(list->name[i], name)) {
+        if (properties_match(list, i, name, hash, key)) {
             value = list->value[i];
             break;
         }
@@ -655,19 +798,51 @@ static inline mlt_property mlt_properties_find(mlt_properties self, const char *
     return value;
 }
 
-/** Add a new property.
+/** Locate a property by name.
  *
  * \private \memberof mlt_properties_s
  * \param self a properties list
- * \param name the name of the new property
- * \return the new property or NULL for failure
+ * \param name the property to lookup by name
+ * \return the property or NULL for failure
  */
 
-static mlt_property mlt_properties_add(mlt_properties self, const char *name)
+static inline mlt_property mlt_properties_find(mlt_properties self, const char *name)
 {
     if (!self || !name)
         return NULL;
+    return properties_lookup(self, name, generate_hash(name), NULL);
+}
+
+/** Locate a property by key.
+ *
+ * \private \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to lookup by key
+ * \return the property or NULL for failure
+ */
+
+static inline mlt_property mlt_properties_find_key(mlt_properties self, mlt_properties_key key)
+{
+    if (!self || !key)
+        return NULL;
+    return properties_lookup(self, key->name, key->hash, key);
+}
 
+/** Add a new property.
+ *
+ * \private \memberof mlt_properties_s
+ * \param self a properties list
+ * \param name the name of the new property
+ * \param hash the hash of the name
+ * \param key the key for the name or NULL
+ * \return the new property or NULL for failure
+ */
+
+static mlt_property mlt_properties_add(mlt_properties self,
+                                       const char *name,
+                                       unsigned int hash,
+                                       mlt_properties_key key)
+{
     property_list *list = self->local;
     mlt_property result;
 
@@ -679,32 +854,43 @@ static mlt_property mlt_properties_add(mlt_properties self, const char *name)
 
         // Use temporary pointers to prevent memory leaks on realloc failure
         char **new_names = realloc(list->name, new_size * sizeof(const char *));
-        mlt_property *new_values = realloc(list->value, new_size * sizeof(mlt_property));
-
-        if (new_names && new_values) {
+        if (new_names)
             list->name = new_names;
+        unsigned int *new_hashes = realloc(list->hash, new_size * sizeof(unsigned int));
+        if (new_hashes)
+            list->hash = new_hashes;
+        mlt_properties_key *new_keys = realloc(list->key, new_size * sizeof(mlt_properties_key));
+        if (new_keys)
+            list->key = new_keys;
+        mlt_property *new_values = realloc(list->value, new_size * sizeof(mlt_property));
+        if (new_values)
             list->value = new_values;
+
+        if (new_names && new_hashes && new_keys && new_values) {
             list->size = new_size;
         } else {
-            // Memory allocation failed; rollback or handle error
-            if (new_names)
-                list->name = new_names;
-            if (new_values)
-                list->value = new_values;
+            // Memory allocation failed
             mlt_properties_unlock(self);
             return NULL;
         }
     }
 
     // Initialize new property entry
-    list->name[list->count] = strdup(name);
-    list->value[list->count] = mlt_property_init();
+    // The property and its name come from the arena; interned names are not copied.
+    list->name[list->count] = key ? key->name : mlt_property_arena_strdup(&list->arena, name);
+    list->hash[list->count] = hash;
+    list->key[list->count] = key;
+    list->value[list->count] = mlt_property_arena_init(&list->arena);
+    if (!list->name[list->count] || !list->value[list->count]) {
+        mlt_properties_unlock(self);
+        return NULL;
+    }
 
     // Update internal hash table for O(1) lookups
     check_rehash(list);
 
     if (list->buckets) {
-        hash_insert(list->buckets, list->mask, name, list->count);
+        hash_insert(list->buckets, list->mask, hash, list->count);
         list->used++;
     }
 
@@ -724,12 +910,41 @@ static mlt_property mlt_properties_add(mlt_properties self, const char *name)
 
 static mlt_property mlt_properties_fetch(mlt_properties self, const char *name)
 {
+    if (!self || !name)
+        return NULL;
+
+    unsigned int hash = generate_hash(name);
+
     // Try to find an existing property first
-    mlt_property property = mlt_properties_find(self, name);
+    mlt_property property = properties_lookup(self, name, hash, NULL);
+
+    // If it wasn't found, create one
+    if (property == NULL)
+        property = mlt_properties_add(self, name, hash, NULL);
+
+    // Return the property
+    return property;
+}
+
+/** Fetch a property by key and add one if not found.
+ *
+ * \private \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to lookup or add
+ * \return the property
+ */
+
+static mlt_property mlt_properties_fetch_key(mlt_properties self, mlt_properties_key key)
+{
+    if (!self || !key)
+        return NULL;
+
+    // Try to find an existing property first
+    mlt_property property = properties_lookup(self, key->name, key->hash, key);
 
     // If it wasn't found, create one
     if (property == NULL)
-        property = mlt_properties_add(self, name);
+        property = mlt_properties_add(self, key->name, key->hash, key);
 
     // Return the property
     return property;
@@ -1145,8 +1360,7 @@ int mlt_properties_get_int(mlt_properties self, const char *name)
     int result = 0;
     mlt_property value = mlt_properties_find(self, name);
     if (value) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         result = mlt_property_get_int(value, fps, list->locale);
     }
@@ -1240,8 +1454,7 @@ double mlt_properties_get_double(mlt_properties self, const char *name)
     double result = 0;
     mlt_property value = mlt_properties_find(self, name);
     if (value) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         result = mlt_property_get_double(value, fps, list->locale);
     }
@@ -1291,8 +1504,7 @@ mlt_position mlt_properties_get_position(mlt_properties self, const char *name)
     mlt_position result = 0;
     mlt_property value = mlt_properties_find(self, name);
     if (value) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         result = mlt_property_get_position(value, fps, list->locale);
     }
@@ -1381,6 +1593,315 @@ int mlt_properties_set_data(mlt_properties self,
     return error;
 }
 
+/** Get a string value by key.
+ *
+ * Do not free the returned string. It's lifetime is controlled by the property
+ * and this properties object.
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to get
+ * \return the property's string value or NULL if it does not exist
+ * \see mlt_properties_get
+ */
+
+char *mlt_properties_get_k(mlt_properties self, mlt_properties_key key)
+{
+    char *result = NULL;
+    mlt_property value = mlt_properties_find_key(self, key);
+    if (value) {
+        property_list *list = self->local;
+        result = mlt_property_get_string_l(value, list->locale);
+    }
+    return result;
+}
+
+/** Set a property to a string by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to set
+ * \param value the property's new value
+ * \return true if error
+ * \see mlt_properties_set_string
+ */
+
+int mlt_properties_set_string_k(mlt_properties self, mlt_properties_key key, const char *value)
+{
+    int error = 1;
+
+    if (!self || !key)
+        return error;
+
+    // Fetch the property to work with
+    mlt_property property = mlt_properties_fetch_key(self, key);
+
+    // Set it if not NULL
+    if (property != NULL) {
+        error = mlt_property_set_string(property, value);
+        mlt_properties_do_mirror(self, key->name);
+        if (value && !strcmp(key->name, "properties"))
+            mlt_properties_preset(self, value);
+    }
+
+    fire_property_changed(self, key->name);
+
+    return error;
+}
+
+/** Get an integer by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to get
+ * \return The integer value, 0 if not found (which may also be a legitimate value)
+ * \see mlt_properties_get_int
+ */
+
+int mlt_properties_get_int_k(mlt_properties self, mlt_properties_key key)
+{
+    int result = 0;
+    mlt_property value = mlt_properties_find_key(self, key);
+    if (value) {
+        double fps = properties_fps(self);
+        property_list *list = self->local;
+        result = mlt_property_get_int(value, fps, list->locale);
+    }
+    return result;
+}
+
+/** Set a property to an integer value by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to set
+ * \param value the integer
+ * \return true if error
+ * \see mlt_properties_set_int
+ */
+
+int mlt_properties_set_int_k(mlt_properties self, mlt_properties_key key, int value)
+{
+    int error = 1;
+
+    if (!self || !key)
+        return error;
+
+    // Fetch the property to work with
+    mlt_property property = mlt_properties_fetch_key(self, key);
+
+    // Set it if not NULL
+    if (property != NULL) {
+        error = mlt_property_set_int(property, value);
+        mlt_properties_do_mirror(self, key->name);
+    }
+
+    fire_property_changed(self, key->name);
+
+    return error;
+}
+
+/** Get a 64-bit integer by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to get
+ * \return the integer value, 0 if not found (which may also be a legitimate value)
+ * \see mlt_properties_get_int64
+ */
+
+int64_t mlt_properties_get_int64_k(mlt_properties self, mlt_properties_key key)
+{
+    mlt_property value = mlt_properties_find_key(self, key);
+    return value == NULL ? 0 : mlt_property_get_int64(value);
+}
+
+/** Set a property to a 64-bit integer value by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to set
+ * \param value the integer
+ * \return true if error
+ * \see mlt_properties_set_int64
+ */
+
+int mlt_properties_set_int64_k(mlt_properties self, mlt_properties_key key, int64_t value)
+{
+    int error = 1;
+
+    if (!self || !key)
+        return error;
+
+    // Fetch the property to work with
+    mlt_property property = mlt_properties_fetch_key(self, key);
+
+    // Set it if not NULL
+    if (property != NULL) {
+        error = mlt_property_set_int64(property, value);
+        mlt_properties_do_mirror(self, key->name);
+    }
+
+    fire_property_changed(self, key->name);
+
+    return error;
+}
+
+/** Get a floating point value by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to get
+ * \return the floating point, 0 if not found (which may also be a legitimate value)
+ * \see mlt_properties_get_double
+ */
+
+double mlt_properties_get_double_k(mlt_properties self, mlt_properties_key key)
+{
+    double result = 0;
+    mlt_property value = mlt_properties_find_key(self, key);
+    if (value) {
+        double fps = properties_fps(self);
+        property_list *list = self->local;
+        result = mlt_property_get_double(value, fps, list->locale);
+    }
+    return result;
+}
+
+/** Set a property to a floating point value by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to set
+ * \param value the floating point value
+ * \return true if error
+ * \see mlt_properties_set_double
+ */
+
+int mlt_properties_set_double_k(mlt_properties self, mlt_properties_key key, double value)
+{
+    int error = 1;
+
+    if (!self || !key)
+        return error;
+
+    // Fetch the property to work with
+    mlt_property property = mlt_properties_fetch_key(self, key);
+
+    // Set it if not NULL
+    if (property != NULL) {
+        error = mlt_property_set_double(property, value);
+        mlt_properties_do_mirror(self, key->name);
+    }
+
+    fire_property_changed(self, key->name);
+
+    return error;
+}
+
+/** Get a position value by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to get
+ * \return the position, 0 if not found (which may also be a legitimate value)
+ * \see mlt_properties_get_position
+ */
+
+mlt_position mlt_properties_get_position_k(mlt_properties self, mlt_properties_key key)
+{
+    mlt_position result = 0;
+    mlt_property value = mlt_properties_find_key(self, key);
+    if (value) {
+        double fps = properties_fps(self);
+        property_list *list = self->local;
+        result = mlt_property_get_position(value, fps, list->locale);
+    }
+    return result;
+}
+
+/** Set a property to a position value by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to set
+ * \param value the position
+ * \return true if error
+ * \see mlt_properties_set_position
+ */
+
+int mlt_properties_set_position_k(mlt_properties self, mlt_properties_key key, mlt_position value)
+{
+    int error = 1;
+
+    if (!self || !key)
+        return error;
+
+    // Fetch the property to work with
+    mlt_property property = mlt_properties_fetch_key(self, key);
+
+    // Set it if not NULL
+    if (property != NULL) {
+        error = mlt_property_set_position(property, value);
+        mlt_properties_do_mirror(self, key->name);
+    }
+
+    fire_property_changed(self, key->name);
+
+    return error;
+}
+
+/** Get a binary data value by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to get
+ * \param[out] length The size of the binary data in bytes, if available (often it is not, you should know)
+ * \see mlt_properties_get_data
+ */
+
+void *mlt_properties_get_data_k(mlt_properties self, mlt_properties_key key, int *length)
+{
+    mlt_property value = mlt_properties_find_key(self, key);
+    return value == NULL ? NULL : mlt_property_get_data(value, length);
+}
+
+/** Store binary data as a property by key.
+ *
+ * \public \memberof mlt_properties_s
+ * \param self a properties list
+ * \param key the property to set
+ * \param value an opaque pointer to binary data
+ * \param length the size of the binary data in bytes (optional)
+ * \param destroy a function to deallocate the binary data when the property is closed (optional)
+ * \param serialise a function that can serialize the binary data as text (optional)
+ * \return true if error
+ * \see mlt_properties_set_data
+ */
+
+int mlt_properties_set_data_k(mlt_properties self,
+                              mlt_properties_key key,
+                              void *value,
+                              int length,
+                              mlt_destructor destroy,
+                              mlt_serialiser serialise)
+{
+    int error = 1;
+
+    if (!self || !key)
+        return error;
+
+    // Fetch the property to work with
+    mlt_property property = mlt_properties_fetch_key(self, key);
+
+    // Set it if not NULL
+    if (property != NULL)
+        error = mlt_property_set_data(property, value, length, destroy, serialise);
+
+    fire_property_changed(self, key->name);
+
+    return error;
+}
+
 /** Rename a property.
  *
  * \public \memberof mlt_properties_s
@@ -1402,8 +1923,10 @@ int mlt_properties_rename(mlt_properties self, const char *source, const char *d
         for (int i = 0; i < list->count; i++) {
             // Check if the property name matches the source.
             if (list->name[i] && !strcmp(list->name[i], source)) {
-                free(list->name[i]);
-                list->name[i] = strdup(dest);
+                // The old name stays in the arena until the list is closed.
+                list->name[i] = mlt_property_arena_strdup(&list->arena, dest);
+                list->hash[i] = generate_hash(dest);
+                list->key[i] = NULL;
                 found = 1;
                 break;
             }
@@ -1416,7 +1939,7 @@ int mlt_properties_rename(mlt_properties self, const char *source, const char *d
 
             for (int j = 0; j < list->count; j++) {
                 if (list->name[j]) {
-                    hash_insert(list->buckets, list->mask, list->name[j], j);
+                    hash_insert(list->buckets, list->mask, list->hash[j], j);
                 }
             }
         }
@@ -1633,10 +2156,9 @@ void mlt_properties_close(mlt_properties self)
 #endif
 
             // Clean up names and values
-            for (index = list->count - 1; index >= 0; index--) {
+            for (index = list->count - 1; index >= 0; index--)
                 mlt_property_close(list->value[index]);
-                free(list->name[index]);
-            }
+            mlt_property_arena_close(&list->arena);
 
 #if defined(__GLIBC__) || defined(__APPLE__)
             // Cleanup locale
@@ -1650,6 +2172,8 @@ void mlt_properties_close(mlt_properties self)
             // Clear up the list
             pthread_mutex_destroy(&list->mutex);
             free(list->name);
+            free(list->hash);
+            free(list->key);
             free(list->value);
 
             if (list->buckets) {
@@ -1666,6 +2190,49 @@ void mlt_properties_close(mlt_properties self)
     }
 }
 
+/** Remove all of the properties and return to the initial state.
+ *
+ * This releases every value like mlt_properties_close() but keeps the memory
+ * of the list so that it can be filled again without allocating. The object
+ * must not be shared: it leaves with a reference count of 1, and without a
+ * mirror or a numeric locale.
+ * \public \memberof mlt_properties_s
+ * \param self a properties object
+ * \return true if the properties object has a custom close function and was not reset
+ */
+
+int mlt_properties_reset(mlt_properties self)
+{
+    if (self == NULL || self->close != NULL)
+        return 1;
+
+    property_list *list = self->local;
+    int index;
+
+    // Release the values in the same order as mlt_properties_close()
+    for (index = list->count - 1; index >= 0; index--)
+        mlt_property_close(list->value[index]);
+    list->count = 0;
+    mlt_property_arena_reset(&list->arena);
+
+    if (list->buckets) {
+        for (unsigned int i = 0; i < list->capacity; i++)
+            list->buckets[i] = -1;
+        list->used = 0;
+    }
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+    if (list->locale)
+        freelocale(list->locale);
+#else
+    free(list->locale);
+#endif
+    list->locale = NULL;
+    list->mirror = NULL;
+    list->ref_count = 1;
+    return 0;
+}
+
 /** Determine if the properties list is really just a sequence or ordered list.
  *
  * \public \memberof mlt_properties_s
@@ -2566,8 +3133,7 @@ mlt_color mlt_properties_get_color(mlt_properties self, const char *name)
     mlt_property value = mlt_properties_find(self, name);
     mlt_color result = {0xff, 0xff, 0xff, 0xff};
     if (value) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         result = mlt_property_get_color(value, fps, list->locale);
     }
@@ -2604,8 +3170,7 @@ extern int mlt_properties_anim_set_color(mlt_properties self,
 
     // Set it if not NULL
     if (property != NULL) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         error = mlt_property_anim_set_color(property,
                                             value,
@@ -2638,8 +3203,7 @@ mlt_color mlt_properties_anim_get_color(mlt_properties self,
                                         int position,
                                         int length)
 {
-    mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-    double fps = mlt_profile_fps(profile);
+    double fps = properties_fps(self);
     property_list *list = self->local;
     mlt_property value = mlt_properties_find(self, name);
     mlt_color color = {0xff, 0xff, 0xff, 0xff};
@@ -2668,8 +3232,7 @@ mlt_color mlt_properties_anim_get_color(mlt_properties self,
 
 char *mlt_properties_anim_get(mlt_properties self, const char *name, int position, int length)
 {
-    mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-    double fps = mlt_profile_fps(profile);
+    double fps = properties_fps(self);
     mlt_property value = mlt_properties_find(self, name);
     property_list *list = self->local;
     return value == NULL ? NULL
@@ -2704,8 +3267,7 @@ int mlt_properties_anim_set(
 
     // Set it if not NULL
     if (property) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         error = mlt_property_anim_set_string(property, value, fps, list->locale, position, length);
         mlt_properties_do_mirror(self, name);
@@ -2729,8 +3291,7 @@ int mlt_properties_anim_set(
 
 int mlt_properties_anim_get_int(mlt_properties self, const char *name, int position, int length)
 {
-    mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-    double fps = mlt_profile_fps(profile);
+    double fps = properties_fps(self);
     property_list *list = self->local;
     mlt_property value = mlt_properties_find(self, name);
     return value == NULL ? 0
@@ -2767,8 +3328,7 @@ int mlt_properties_anim_set_int(mlt_properties self,
 
     // Set it if not NULL
     if (property != NULL) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         error = mlt_property_anim_set_int(property,
                                           value,
@@ -2801,8 +3361,7 @@ double mlt_properties_anim_get_double(mlt_properties self,
                                       int position,
                                       int length)
 {
-    mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-    double fps = mlt_profile_fps(profile);
+    double fps = properties_fps(self);
     property_list *list = self->local;
     mlt_property value = mlt_properties_find(self, name);
     return value == NULL ? 0.0
@@ -2839,8 +3398,7 @@ int mlt_properties_anim_set_double(mlt_properties self,
 
     // Set it if not NULL
     if (property != NULL) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         error = mlt_property_anim_set_double(property,
                                              value,
@@ -2947,8 +3505,7 @@ extern int mlt_properties_anim_set_rect(mlt_properties self,
 
     // Set it if not NULL
     if (property != NULL) {
-        mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-        double fps = mlt_profile_fps(profile);
+        double fps = properties_fps(self);
         property_list *list = self->local;
         error = mlt_property_anim_set_rect(property,
                                            value,
@@ -2981,8 +3538,7 @@ extern mlt_rect mlt_properties_anim_get_rect(mlt_properties self,
                                              int position,
                                              int length)
 {
-    mlt_profile profile = mlt_properties_get_data(self, "_profile", NULL);
-    double fps = mlt_profile_fps(profile);
+    double fps = properties_fps(self);
     property_list *list = self->local;
     mlt_property value = mlt_properties_find(self, name);
     mlt_rect rect = {DBL_MIN, DBL_MIN, DBL_MIN, DBL_MIN, DBL_MIN};
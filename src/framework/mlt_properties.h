@@ -96,6 +96,7 @@ MLT_EXPORT void mlt_properties_debug(mlt_properties self, const char *title, FIL
 MLT_EXPORT int mlt_properties_save(mlt_properties, const char *);
 MLT_EXPORT int mlt_properties_dir_list(mlt_properties, const char *, const char *, int);
 MLT_EXPORT void mlt_properties_close(mlt_properties self);
+MLT_EXPORT int mlt_properties_reset(mlt_properties self);
 MLT_EXPORT int mlt_properties_is_sequence(mlt_properties self);
 MLT_EXPORT mlt_properties mlt_properties_parse_yaml(const char *file);
 MLT_EXPORT char *mlt_properties_serialise_yaml(mlt_properties self);
@@ -104,6 +105,36 @@ MLT_EXPORT void mlt_properties_unlock(mlt_properties self);
 MLT_EXPORT void mlt_properties_clear(mlt_properties self, const char *name);
 MLT_EXPORT int mlt_properties_exists(mlt_properties self, const char *name);
 
+MLT_EXPORT mlt_properties_key mlt_properties_intern(const char *name);
+MLT_EXPORT const char *mlt_properties_key_name(mlt_properties_key key);
+MLT_EXPORT char *mlt_properties_get_k(mlt_properties self, mlt_properties_key key);
+MLT_EXPORT int mlt_properties_set_string_k(mlt_properties self,
+                                           mlt_properties_key key,
+                                           const char *value);
+MLT_EXPORT int mlt_properties_get_int_k(mlt_properties self, mlt_properties_key key);
+MLT_EXPORT int mlt_properties_set_int_k(mlt_properties self, mlt_properties_key key, int value);
+MLT_EXPORT int64_t mlt_properties_get_int64_k(mlt_properties self, mlt_properties_key key);
+MLT_EXPORT int mlt_properties_set_int64_k(mlt_properties self,
+                                          mlt_properties_key key,
+                                          int64_t value);
+MLT_EXPORT double mlt_properties_get_double_k(mlt_properties self, mlt_properties_key key);
+MLT_EXPORT int mlt_properties_set_double_k(mlt_properties self,
+                                           mlt_properties_key key,
+                                           double value);
+MLT_EXPORT mlt_position mlt_properties_get_position_k(mlt_properties self, mlt_properties_key key);
+MLT_EXPORT int mlt_properties_set_position_k(mlt_properties self,
+                                             mlt_properties_key key,
+                                             mlt_position value);
+MLT_EXPORT void *mlt_properties_get_data_k(mlt_properties self,
+                                           mlt_properties_key key,
+                                           int *length);
+MLT_EXPORT int mlt_properties_set_data_k(mlt_properties self,
+                                         mlt_properties_key key,
+                                         void *value,
+                                         int length,
+                                         mlt_destructor,
+                                         mlt_serialiser);
+
 MLT_EXPORT char *mlt_properties_get_time(mlt_properties, const char *name, mlt_time_format);
 MLT_EXPORT char *mlt_properties_frames_to_time(mlt_properties, mlt_position, mlt_time_format);
 MLT_EXPORT mlt_position mlt_properties_time_to_frames(mlt_properties, const char *time);
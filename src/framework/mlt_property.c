@@ -34,6 +34,10 @@
 #include <locale.h>
 #include <math.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -95,27 +99,202 @@ struct mlt_property_s
     mlt_destructor destructor;
     mlt_serialiser serialiser;
 
-    pthread_mutex_t mutex;
+    /// Recursive lock: the owning thread's marker and its nesting depth
+    atomic_uintptr_t owner;
+    int depth;
+
+    /// Whether the memory belongs to a mlt_property_arena
+    int in_arena;
+
     mlt_animation animation;
     mlt_properties properties;
 };
 
+/** \brief Property arena class
+ *
+ * An arena is a chain of memory chunks that property objects and strings are
+ * carved out of. Nothing is released individually; the whole chain is freed
+ * at once by mlt_property_arena_close().
+ */
+
+struct mlt_property_arena_s
+{
+    struct mlt_property_arena_s *next; ///< the previous (full) chunk
+    size_t size;                       ///< the number of bytes in data
+    size_t used;                       ///< the number of bytes handed out
+    char data[];
+};
+
+#define ARENA_MIN_SIZE 512
+#define ARENA_MAX_SIZE 65536
+
+/** A per-thread object whose address identifies the thread owning a property lock */
+
+static _Thread_local char lock_marker;
+
+/** Lock a property.
+ *
+ * Properties are rarely contended and are locked for a short time, so this
+ * is a small recursive spin lock that needs no initialization or cleanup.
+ * \private \memberof mlt_property_s
+ * \param self a property
+ */
+
+static inline void property_lock(mlt_property self)
+{
+    uintptr_t me = (uintptr_t) &lock_marker;
+    uintptr_t expected = 0;
+    int spins = 0;
+
+    // Only this thread can have stored its own marker.
+    if (atomic_load_explicit(&self->owner, memory_order_relaxed) == me) {
+        self->depth++;
+        return;
+    }
+    while (!atomic_compare_exchange_weak_explicit(&self->owner,
+                                                  &expected,
+                                                  me,
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed)) {
+        expected = 0;
+        // A destructor can run with the lock held, so do not burn the CPU.
+        if (++spins > 100)
+            sched_yield();
+    }
+    self->depth = 1;
+}
+
+/** Unlock a property.
+ *
+ * \private \memberof mlt_property_s
+ * \param self a property
+ */
+
+static inline void property_unlock(mlt_property self)
+{
+    if (--self->depth == 0)
+        atomic_store_explicit(&self->owner, 0, memory_order_release);
+}
+
 /** Construct a property and initialize it
  * \public \memberof mlt_property_s
  */
 
 mlt_property mlt_property_init()
 {
-    mlt_property self = calloc(1, sizeof(*self));
+    return calloc(1, sizeof(struct mlt_property_s));
+}
+
+/** Allocate memory from an arena.
+ *
+ * \private \memberof mlt_property_arena_s
+ * \param arena the address of an arena, which may point to NULL to start a new one
+ * \param size the number of bytes needed
+ * \param align the required alignment, a power of two
+ * \return the memory or NULL if out of memory
+ */
+
+static void *arena_alloc(mlt_property_arena *arena, size_t size, size_t align)
+{
+    mlt_property_arena chunk = *arena;
+    uintptr_t start = 0;
+
+    if (chunk) {
+        start = ((uintptr_t) (chunk->data + chunk->used) + align - 1) & ~(uintptr_t) (align - 1);
+        if (start + size <= (uintptr_t) (chunk->data + chunk->size)) {
+            chunk->used = start + size - (uintptr_t) chunk->data;
+            return (void *) start;
+        }
+    }
+
+    // Each new chunk is twice as big as the last to keep the chain short.
+    size_t chunk_size = chunk ? chunk->size * 2 : ARENA_MIN_SIZE;
+    if (chunk_size > ARENA_MAX_SIZE)
+        chunk_size = ARENA_MAX_SIZE;
+    if (chunk_size < size + align)
+        chunk_size = size + align;
+    mlt_property_arena fresh = malloc(sizeof(struct mlt_property_arena_s) + chunk_size);
+    if (!fresh)
+        return NULL;
+    fresh->next = chunk;
+    fresh->size = chunk_size;
+    fresh->used = 0;
+    *arena = fresh;
+    return arena_alloc(arena, size, align);
+}
+
+/** Construct a property in an arena.
+ *
+ * Such a property must still be closed with mlt_property_close() to release
+ * its value, but its memory is only freed by mlt_property_arena_close().
+ * The arena is not thread safe; the caller must serialize access to it.
+ * \public \memberof mlt_property_arena_s
+ * \param arena the address of an arena, which may point to NULL to start a new one
+ * \return a new property or NULL if out of memory
+ */
+
+mlt_property mlt_property_arena_init(mlt_property_arena *arena)
+{
+    mlt_property self = arena_alloc(arena,
+                                    sizeof(struct mlt_property_s),
+                                    alignof(struct mlt_property_s));
     if (self) {
-        pthread_mutexattr_t attr;
-        pthread_mutexattr_init(&attr);
-        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-        pthread_mutex_init(&self->mutex, &attr);
+        memset(self, 0, sizeof(*self));
+        self->in_arena = 1;
     }
     return self;
 }
 
+/** Copy a string into an arena.
+ *
+ * \public \memberof mlt_property_arena_s
+ * \param arena the address of an arena, which may point to NULL to start a new one
+ * \param string the string to copy
+ * \return the copy or NULL if out of memory
+ */
+
+char *mlt_property_arena_strdup(mlt_property_arena *arena, const char *string)
+{
+    size_t length = strlen(string) + 1;
+    char *copy = arena_alloc(arena, length, 1);
+    if (copy)
+        memcpy(copy, string, length);
+    return copy;
+}
+
+/** Empty an arena so that its memory can be used again.
+ *
+ * Only the newest (largest) chunk is kept. Close all of the properties in the
+ * arena before calling this.
+ * \public \memberof mlt_property_arena_s
+ * \param arena the address of an arena
+ */
+
+void mlt_property_arena_reset(mlt_property_arena *arena)
+{
+    mlt_property_arena chunk = *arena;
+    if (chunk) {
+        mlt_property_arena_close(&chunk->next);
+        chunk->used = 0;
+    }
+}
+
+/** Free an arena and everything that was allocated from it.
+ *
+ * Close all of the properties in the arena before calling this.
+ * \public \memberof mlt_property_arena_s
+ * \param arena the address of an arena, which is reset to NULL
+ */
+
+void mlt_property_arena_close(mlt_property_arena *arena)
+{
+    while (*arena) {
+        mlt_property_arena chunk = *arena;
+        *arena = chunk->next;
+        free(chunk);
+    }
+}
+
 /** Clear (0/null) a property.
  *
  * Frees up any associated resources in the process.
@@ -162,9 +341,9 @@ static void clear_property(mlt_property self)
 
 void mlt_property_clear(mlt_property self)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
 }
 
 /** Check if a property is cleared.
@@ -178,9 +357,9 @@ int mlt_property_is_clear(mlt_property self)
 {
     int result = 1;
     if (self) {
-        pthread_mutex_lock(&self->mutex);
+        property_lock(self);
         result = self->types == 0 && self->animation == NULL && self->properties == NULL;
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
     }
     return result;
 }
@@ -195,11 +374,11 @@ int mlt_property_is_clear(mlt_property self)
 
 int mlt_property_set_int(mlt_property self, int value)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
     self->types = mlt_prop_int;
     self->prop_int = value;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -213,11 +392,11 @@ int mlt_property_set_int(mlt_property self, int value)
 
 int mlt_property_set_double(mlt_property self, double value)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
     self->types = mlt_prop_double;
     self->prop_double = value;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -232,11 +411,11 @@ int mlt_property_set_double(mlt_property self, double value)
 
 int mlt_property_set_position(mlt_property self, mlt_position value)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
     self->types = mlt_prop_position;
     self->prop_position = value;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -252,7 +431,7 @@ int mlt_property_set_position(mlt_property self, mlt_position value)
 
 int mlt_property_set_string(mlt_property self, const char *value)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (value != self->prop_string) {
         clear_property(self);
         self->types = mlt_prop_string;
@@ -261,7 +440,7 @@ int mlt_property_set_string(mlt_property self, const char *value)
     } else {
         self->types = mlt_prop_string;
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return self->prop_string == NULL;
 }
 
@@ -275,11 +454,11 @@ int mlt_property_set_string(mlt_property self, const char *value)
 
 int mlt_property_set_int64(mlt_property self, int64_t value)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
     self->types = mlt_prop_int64;
     self->prop_int64 = value;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -304,7 +483,7 @@ int mlt_property_set_data(mlt_property self,
                           mlt_destructor destructor,
                           mlt_serialiser serialiser)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (self->data == value)
         self->destructor = NULL;
     clear_property(self);
@@ -313,7 +492,7 @@ int mlt_property_set_data(mlt_property self,
     self->length = length;
     self->destructor = destructor;
     self->serialiser = serialiser;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -340,7 +519,7 @@ static int time_clock_to_frames(mlt_property self, const char *s, double fps, ml
     char *orig_localename = NULL;
     if (locale) {
         // Protect damaging the global locale from a temporary locale on another thread.
-        pthread_mutex_lock(&self->mutex);
+        property_lock(self);
 
         // Get the current locale
         orig_localename = strdup(setlocale(LC_NUMERIC, NULL));
@@ -380,7 +559,7 @@ static int time_clock_to_frames(mlt_property self, const char *s, double fps, ml
         // Restore the current locale
         setlocale(LC_NUMERIC, orig_localename);
         free(orig_localename);
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
     }
 #endif
 
@@ -491,7 +670,7 @@ static int mlt_property_atoi(mlt_property self, double fps, mlt_locale_t locale)
 
 int mlt_property_get_int(mlt_property self, double fps, mlt_locale_t locale)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     int result = 0;
     if (self->types & mlt_prop_int || self->types & mlt_prop_color)
         result = self->prop_int;
@@ -509,7 +688,7 @@ int mlt_property_get_int(mlt_property self, double fps, mlt_locale_t locale)
         if ((self->types & mlt_prop_string) && self->prop_string)
             result = mlt_property_atoi(self, fps, locale);
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return result;
 }
 
@@ -537,7 +716,7 @@ static double mlt_property_atof(mlt_property self, double fps, mlt_locale_t loca
 #ifdef NEED_LOCALE_SAVE_RESTORE
         if (locale) {
             // Protect damaging the global locale from a temporary locale on another thread.
-            pthread_mutex_lock(&self->mutex);
+            property_lock(self);
 
             // Get the current locale
             orig_localename = strdup(setlocale(LC_NUMERIC, NULL));
@@ -557,7 +736,7 @@ static double mlt_property_atof(mlt_property self, double fps, mlt_locale_t loca
             // Restore the current locale
             setlocale(LC_NUMERIC, orig_localename);
             free(orig_localename);
-            pthread_mutex_unlock(&self->mutex);
+            property_unlock(self);
         }
 #endif
         return result;
@@ -572,7 +751,7 @@ static double mlt_property_atof(mlt_property self, double fps, mlt_locale_t loca
 #elif !defined(_WIN32)
         if (locale) {
             // Protect damaging the global locale from a temporary locale on another thread.
-            pthread_mutex_lock(&self->mutex);
+            property_lock(self);
 
             // Get the current locale
             orig_localename = strdup(setlocale(LC_NUMERIC, NULL));
@@ -591,7 +770,7 @@ static double mlt_property_atof(mlt_property self, double fps, mlt_locale_t loca
             // Restore the current locale
             setlocale(LC_NUMERIC, orig_localename);
             free(orig_localename);
-            pthread_mutex_unlock(&self->mutex);
+            property_unlock(self);
         }
 #endif
 
@@ -611,7 +790,7 @@ static double mlt_property_atof(mlt_property self, double fps, mlt_locale_t loca
 double mlt_property_get_double(mlt_property self, double fps, mlt_locale_t locale)
 {
     double result = 0.0;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (self->types & mlt_prop_double)
         result = self->prop_double;
     else if (self->types & mlt_prop_int || self->types & mlt_prop_color)
@@ -628,7 +807,7 @@ double mlt_property_get_double(mlt_property self, double fps, mlt_locale_t local
         if ((self->types & mlt_prop_string) && self->prop_string)
             result = mlt_property_atof(self, fps, locale);
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return result;
 }
 
@@ -645,7 +824,7 @@ double mlt_property_get_double(mlt_property self, double fps, mlt_locale_t local
 mlt_position mlt_property_get_position(mlt_property self, double fps, mlt_locale_t locale)
 {
     mlt_position result = 0;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (self->types & mlt_prop_position)
         result = self->prop_position;
     else if (self->types & mlt_prop_int || self->types & mlt_prop_color)
@@ -662,7 +841,7 @@ mlt_position mlt_property_get_position(mlt_property self, double fps, mlt_locale
         if ((self->types & mlt_prop_string) && self->prop_string)
             result = (mlt_position) mlt_property_atoi(self, fps, locale);
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return result;
 }
 
@@ -694,7 +873,7 @@ static inline int64_t mlt_property_atoll(const char *value)
 int64_t mlt_property_get_int64(mlt_property self)
 {
     int64_t result = 0;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (self->types & mlt_prop_int64)
         result = self->prop_int64;
     else if (self->types & mlt_prop_int || self->types & mlt_prop_color)
@@ -711,7 +890,7 @@ int64_t mlt_property_get_int64(mlt_property self)
         if ((self->types & mlt_prop_string) && self->prop_string)
             result = mlt_property_atoll(self->prop_string);
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return result;
 }
 
@@ -730,7 +909,7 @@ int64_t mlt_property_get_int64(mlt_property self)
 char *mlt_property_get_string_tf(mlt_property self, mlt_time_format time_format)
 {
     // Construct a string if need be
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (self->animation && self->serialiser) {
         free(self->prop_string);
         self->prop_string = self->serialiser(self->animation, time_format);
@@ -765,7 +944,7 @@ char *mlt_property_get_string_tf(mlt_property self, mlt_time_format time_format)
             self->prop_string = self->serialiser(self->data, self->length);
         }
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
 
     // Return the string (may be NULL)
     return self->prop_string;
@@ -815,7 +994,7 @@ char *mlt_property_get_string_l_tf(mlt_property self,
         return mlt_property_get_string_tf(self, time_format);
 
     // Construct a string if need be
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (self->animation && self->serialiser) {
         free(self->prop_string);
         self->prop_string = self->serialiser(self->animation, time_format);
@@ -872,7 +1051,7 @@ char *mlt_property_get_string_l_tf(mlt_property self,
         free(orig_localename);
 #endif
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
 
     // Return the string (may be NULL)
     return self->prop_string;
@@ -912,7 +1091,7 @@ char *mlt_property_get_string_l(mlt_property self, mlt_locale_t locale)
 void *mlt_property_get_data(mlt_property self, int *length)
 {
     // Return the data (note: there is no conversion here)
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     void *result = NULL;
     if (self->types & mlt_prop_data) {
         result = self->data;
@@ -920,7 +1099,7 @@ void *mlt_property_get_data(mlt_property self, int *length)
         if (length != NULL)
             *length = self->length;
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return result;
 }
 
@@ -933,8 +1112,8 @@ void *mlt_property_get_data(mlt_property self, int *length)
 void mlt_property_close(mlt_property self)
 {
     clear_property(self);
-    pthread_mutex_destroy(&self->mutex);
-    free(self);
+    if (!self->in_arena)
+        free(self);
 }
 
 /** Copy a property.
@@ -948,7 +1127,7 @@ void mlt_property_close(mlt_property self)
  */
 void mlt_property_pass(mlt_property self, mlt_property that)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
 
     self->types = that->types;
@@ -979,7 +1158,7 @@ void mlt_property_pass(mlt_property self, mlt_property that)
         self->types = mlt_prop_string;
         self->prop_string = that->serialiser(that->data, that->length);
     }
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
 }
 
 /** Convert frame count to a SMPTE timecode string.
@@ -1150,7 +1329,7 @@ char *mlt_property_get_time(mlt_property self,
 #endif // _WIN32
 
         // Protect damaging the global locale from a temporary locale on another thread.
-        pthread_mutex_lock(&self->mutex);
+        property_lock(self);
 
         // Get the current locale
         orig_localename = strdup(setlocale(LC_NUMERIC, NULL));
@@ -1161,7 +1340,7 @@ char *mlt_property_get_time(mlt_property self,
 #endif // _WIN32
     {
         // Make sure we have a lock before accessing self->types
-        pthread_mutex_lock(&self->mutex);
+        property_lock(self);
     }
 
     // Convert number to string
@@ -1190,12 +1369,12 @@ char *mlt_property_get_time(mlt_property self,
     if (locale) {
         setlocale(LC_NUMERIC, orig_localename);
         free(orig_localename);
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
     } else
 #endif // _WIN32
     {
         // Make sure we have a lock before accessing self->types
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
     }
 
     // Return the string (may be NULL)
@@ -1230,7 +1409,7 @@ int mlt_property_is_numeric(mlt_property self, mlt_locale_t locale)
 #elif !defined(_WIN32)
         if (locale) {
             // Protect damaging the global locale from a temporary locale on another thread.
-            pthread_mutex_lock(&self->mutex);
+            property_lock(self);
 
             // Get the current locale
             orig_localename = strdup(setlocale(LC_NUMERIC, NULL));
@@ -1247,7 +1426,7 @@ int mlt_property_is_numeric(mlt_property self, mlt_locale_t locale)
             // Restore the current locale
             setlocale(LC_NUMERIC, orig_localename);
             free(orig_localename);
-            pthread_mutex_unlock(&self->mutex);
+            property_unlock(self);
         }
 #endif
 
@@ -1501,19 +1680,19 @@ double mlt_property_anim_get_double(
     mlt_property self, double fps, mlt_locale_t locale, int position, int length)
 {
     double result;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (mlt_property_is_anim(self)) {
         struct mlt_animation_item_s item;
         item.property = mlt_property_init();
 
         refresh_animation(self, fps, locale, length);
         mlt_animation_get_item(self->animation, &item, position);
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_double(item.property, fps, locale);
 
         mlt_property_close(item.property);
     } else {
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_double(self, fps, locale);
     }
     return result;
@@ -1535,19 +1714,19 @@ int mlt_property_anim_get_int(
     mlt_property self, double fps, mlt_locale_t locale, int position, int length)
 {
     int result;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (mlt_property_is_anim(self)) {
         struct mlt_animation_item_s item;
         item.property = mlt_property_init();
 
         refresh_animation(self, fps, locale, length);
         mlt_animation_get_item(self->animation, &item, position);
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_int(item.property, fps, locale);
 
         mlt_property_close(item.property);
     } else {
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_int(self, fps, locale);
     }
     return result;
@@ -1569,7 +1748,7 @@ char *mlt_property_anim_get_string(
     mlt_property self, double fps, mlt_locale_t locale, int position, int length)
 {
     char *result;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (mlt_property_is_anim(self)) {
         struct mlt_animation_item_s item;
         item.property = mlt_property_init();
@@ -1580,9 +1759,9 @@ char *mlt_property_anim_get_string(
 
         free(self->prop_string);
 
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         self->prop_string = mlt_property_get_string_l(item.property, locale);
-        pthread_mutex_lock(&self->mutex);
+        property_lock(self);
 
         if (self->prop_string)
             self->prop_string = strdup(self->prop_string);
@@ -1590,7 +1769,7 @@ char *mlt_property_anim_get_string(
 
         result = self->prop_string;
         mlt_property_close(item.property);
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
     } else {
         const char *raw = mlt_property_get_string_l(self, locale);
         if (raw && raw[0] == '"') {
@@ -1614,7 +1793,7 @@ char *mlt_property_anim_get_string(
         } else {
             result = (char *) raw;
         }
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
     }
     return result;
 }
@@ -1649,11 +1828,11 @@ int mlt_property_anim_set_double(mlt_property self,
     item.keyframe_type = keyframe_type;
     mlt_property_set_double(item.property, value);
 
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     refresh_animation(self, fps, locale, length);
     result = mlt_animation_insert(self->animation, &item);
     mlt_animation_interpolate(self->animation);
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     mlt_property_close(item.property);
 
     return result;
@@ -1689,11 +1868,11 @@ int mlt_property_anim_set_int(mlt_property self,
     item.keyframe_type = keyframe_type;
     mlt_property_set_int(item.property, value);
 
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     refresh_animation(self, fps, locale, length);
     result = mlt_animation_insert(self->animation, &item);
     mlt_animation_interpolate(self->animation);
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     mlt_property_close(item.property);
 
     return result;
@@ -1726,11 +1905,11 @@ int mlt_property_anim_set_string(
     item.keyframe_type = mlt_keyframe_discrete;
     mlt_property_set_string(item.property, value);
 
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     refresh_animation(self, fps, locale, length);
     result = mlt_animation_insert(self->animation, &item);
     mlt_animation_interpolate(self->animation);
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     mlt_property_close(item.property);
 
     return result;
@@ -1747,9 +1926,9 @@ int mlt_property_anim_set_string(
 
 mlt_animation mlt_property_get_animation(mlt_property self)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     mlt_animation result = self->animation;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return result;
 }
 
@@ -1763,12 +1942,12 @@ mlt_animation mlt_property_get_animation(mlt_property self)
 
 int mlt_property_set_color(mlt_property self, mlt_color value)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
     self->types = mlt_prop_color;
     uint32_t int_value = (value.r << 24) | (value.g << 16) | (value.b << 8) | value.a;
     self->prop_int = int_value;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -1855,11 +2034,11 @@ int mlt_property_anim_set_color(mlt_property self,
     item.keyframe_type = keyframe_type;
     mlt_property_set_color(item.property, value);
 
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     refresh_animation(self, fps, locale, length);
     result = mlt_animation_insert(self->animation, &item);
     mlt_animation_interpolate(self->animation);
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     mlt_property_close(item.property);
 
     return result;
@@ -1881,7 +2060,7 @@ mlt_color mlt_property_anim_get_color(
     mlt_property self, double fps, mlt_locale_t locale, int position, int length)
 {
     mlt_color result;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (mlt_property_is_anim(self)) {
         struct mlt_animation_item_s item;
         item.property = mlt_property_init();
@@ -1889,12 +2068,12 @@ mlt_color mlt_property_anim_get_color(
 
         refresh_animation(self, fps, locale, length);
         mlt_animation_get_item(self->animation, &item, position);
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_color(item.property, fps, locale);
 
         mlt_property_close(item.property);
     } else {
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_color(self, fps, locale);
     }
     return result;
@@ -1937,7 +2116,7 @@ static char *serialise_mlt_rect(mlt_rect *rect, int length)
 
 int mlt_property_set_rect(mlt_property self, mlt_rect value)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
     self->types = mlt_prop_rect;
     self->length = sizeof(value);
@@ -1945,7 +2124,7 @@ int mlt_property_set_rect(mlt_property self, mlt_rect value)
     memcpy(self->data, &value, self->length);
     self->destructor = free;
     self->serialiser = (mlt_serialiser) serialise_mlt_rect;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -1982,7 +2161,7 @@ mlt_rect mlt_property_get_rect(mlt_property self, mlt_locale_t locale)
         char *orig_localename = NULL;
         if (locale) {
             // Protect damaging the global locale from a temporary locale on another thread.
-            pthread_mutex_lock(&self->mutex);
+            property_lock(self);
 
             // Get the current locale
             orig_localename = strdup(setlocale(LC_NUMERIC, NULL));
@@ -2040,7 +2219,7 @@ mlt_rect mlt_property_get_rect(mlt_property self, mlt_locale_t locale)
             // Restore the current locale
             setlocale(LC_NUMERIC, orig_localename);
             free(orig_localename);
-            pthread_mutex_unlock(&self->mutex);
+            property_unlock(self);
         }
 #endif
     }
@@ -2077,11 +2256,11 @@ int mlt_property_anim_set_rect(mlt_property self,
     item.keyframe_type = keyframe_type;
     mlt_property_set_rect(item.property, value);
 
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     refresh_animation(self, fps, locale, length);
     result = mlt_animation_insert(self->animation, &item);
     mlt_animation_interpolate(self->animation);
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     mlt_property_close(item.property);
 
     return result;
@@ -2103,7 +2282,7 @@ mlt_rect mlt_property_anim_get_rect(
     mlt_property self, double fps, mlt_locale_t locale, int position, int length)
 {
     mlt_rect result;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     if (mlt_property_is_anim(self)) {
         struct mlt_animation_item_s item;
         item.property = mlt_property_init();
@@ -2111,12 +2290,12 @@ mlt_rect mlt_property_anim_get_rect(
 
         refresh_animation(self, fps, locale, length);
         mlt_animation_get_item(self->animation, &item, position);
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_rect(item.property, locale);
 
         mlt_property_close(item.property);
     } else {
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
         result = mlt_property_get_rect(self, locale);
     }
     return result;
@@ -2132,11 +2311,11 @@ mlt_rect mlt_property_anim_get_rect(
 
 int mlt_property_set_properties(mlt_property self, mlt_properties properties)
 {
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     clear_property(self);
     self->properties = properties;
     mlt_properties_inc_ref(properties);
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return 0;
 }
 
@@ -2150,9 +2329,9 @@ int mlt_property_set_properties(mlt_property self, mlt_properties properties)
 mlt_properties mlt_property_get_properties(mlt_property self)
 {
     mlt_properties properties = NULL;
-    pthread_mutex_lock(&self->mutex);
+    property_lock(self);
     properties = self->properties;
-    pthread_mutex_unlock(&self->mutex);
+    property_unlock(self);
     return properties;
 }
 
@@ -2257,7 +2436,7 @@ extern int mlt_property_is_color(mlt_property self)
 {
     int result = 0;
     if (self) {
-        pthread_mutex_lock(&self->mutex);
+        property_lock(self);
         if (self->types & mlt_prop_color) {
             result = 1;
         } else {
@@ -2268,7 +2447,7 @@ extern int mlt_property_is_color(mlt_property self)
                 result = 1;
             }
         }
-        pthread_mutex_unlock(&self->mutex);
+        property_unlock(self);
     }
     return result;
 }
@@ -3,7 +3,7 @@
  * \brief Property class declaration
  * \see mlt_property_s
  *
- * Copyright (C) 2003-2023 Meltytech, LLC
+ * Copyright (C) 2003-2026 Meltytech, LLC
  *
  * This library is free software; you can redistribute it and/or
  * modify it under the terms of the GNU Lesser General Public
@@ -46,7 +46,13 @@ struct mlt_locale_t;
 typedef char *mlt_locale_t;
 #endif
 
+typedef struct mlt_property_arena_s *mlt_property_arena; /**< pointer to Property Arena */
+
 MLT_EXPORT mlt_property mlt_property_init();
+MLT_EXPORT mlt_property mlt_property_arena_init(mlt_property_arena *arena);
+MLT_EXPORT char *mlt_property_arena_strdup(mlt_property_arena *arena, const char *string);
+MLT_EXPORT void mlt_property_arena_reset(mlt_property_arena *arena);
+MLT_EXPORT void mlt_property_arena_close(mlt_property_arena *arena);
 MLT_EXPORT void mlt_property_clear(mlt_property self);
 MLT_EXPORT int mlt_property_is_clear(mlt_property self);
 MLT_EXPORT int mlt_property_set_int(mlt_property self, int value);
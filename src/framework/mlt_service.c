@@ -1007,6 +1007,37 @@ void mlt_service_cache_set_size(mlt_service self, const char *name, int size)
         mlt_cache_set_size(cache, size);
 }
 
+/** Set the number of bytes to cache for the named cache.
+ *
+ * \public \memberof mlt_service_s
+ * \param self a service
+ * \param name a name for the object that is unique to the service class, but not to the instance
+ * \param bytes the maximum number of bytes or 0 to limit the number of items
+ * \see mlt_cache_set_max_bytes
+ */
+
+void mlt_service_cache_set_max_bytes(mlt_service self, const char *name, int64_t bytes)
+{
+    mlt_cache cache = get_cache(self, name);
+    if (cache)
+        mlt_cache_set_max_bytes(cache, bytes);
+}
+
+/** Charge the named cache against the process-wide cache budget.
+ *
+ * \public \memberof mlt_service_s
+ * \param self a service
+ * \param name a name for the object that is unique to the service class, but not to the instance
+ * \see mlt_cache_share
+ */
+
+void mlt_service_cache_share(mlt_service self, const char *name)
+{
+    mlt_cache cache = get_cache(self, name);
+    if (cache)
+        mlt_cache_share(cache);
+}
+
 /** Get the current maximum size of the named cache.
  *
  * \public \memberof mlt_service_s
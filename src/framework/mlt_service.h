@@ -107,6 +107,8 @@ MLT_EXPORT void mlt_service_cache_put(
 MLT_EXPORT mlt_cache_item mlt_service_cache_get(mlt_service self, const char *name);
 MLT_EXPORT void mlt_service_cache_set_size(mlt_service self, const char *name, int size);
 MLT_EXPORT int mlt_service_cache_get_size(mlt_service self, const char *name);
+MLT_EXPORT void mlt_service_cache_set_max_bytes(mlt_service self, const char *name, int64_t bytes);
+MLT_EXPORT void mlt_service_cache_share(mlt_service self, const char *name);
 MLT_EXPORT void mlt_service_cache_purge(mlt_service self);
 
 #endif
@@ -27,6 +27,7 @@
 
 #include <pthread.h>
 #include <sched.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
 #ifdef _WIN32
@@ -36,6 +37,7 @@
 #include <unistd.h>
 #endif
 
+/** The maximum number of slices, unless the machine has more CPUs than this */
 #define MAX_SLICES 32
 #define ENV_SLICES "MLT_SLICES_COUNT"
 
@@ -49,99 +51,213 @@ typedef enum {
 static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
 static mlt_slices globals[mlt_policy_nb] = {NULL, NULL, NULL};
 
+/** The most threads, including itself, that a thread's slice runs may use (0 for no limit) */
+static _Thread_local int thread_limit = 0;
+
+/** One call of mlt_slices_run(), which lives on the stack of the calling thread */
+
 struct mlt_slices_runtime_s
 {
-    int jobs, done, curr;
+    int jobs;
+    atomic_int curr; ///< the next job index to claim
+    atomic_int refs; ///< the number of queued or running helpers
     mlt_slices_proc proc;
     void *cookie;
-    struct mlt_slices_runtime_s *next;
+};
+
+/** A worker thread and its deque of runs that it was asked to help with */
+
+struct mlt_slices_worker_s
+{
+    mlt_slices ctx;
+    int id;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct mlt_slices_runtime_s **items;
+    int capacity;
+    int head;
+    int count;
 };
 
 struct mlt_slices_s
 {
-    int f_exit;
+    atomic_int f_exit;
     int count;
-    int readys;
     int ref;
-    pthread_mutex_t cond_mutex;
-    pthread_cond_t cond_var_job;
-    pthread_cond_t cond_var_ready;
-    pthread_t threads[MAX_SLICES];
-    struct mlt_slices_runtime_s *head, *tail;
+    int workers_count;
+    struct mlt_slices_worker_s *workers;
+    atomic_uint next_worker;
+    pthread_mutex_t done_mutex;
+    pthread_cond_t done_cond;
     const char *name;
 };
 
-static void *mlt_slices_worker(void *p)
+/** Add a run to the bottom of a worker's deque.
+ *
+ * The worker's mutex must be held.
+ * \private \memberof mlt_slices_s
+ * \param w a worker
+ * \param r a run
+ * \return true if out of memory
+ */
+
+static int deque_push(struct mlt_slices_worker_s *w, struct mlt_slices_runtime_s *r)
 {
-    int id, idx;
-    struct mlt_slices_runtime_s *r;
-    mlt_slices ctx = (mlt_slices) p;
+    if (w->count == w->capacity) {
+        int capacity = w->capacity ? w->capacity * 2 : 16;
+        struct mlt_slices_runtime_s **items = malloc(capacity * sizeof(*items));
+        if (!items)
+            return 1;
+        for (int i = 0; i < w->count; i++)
+            items[i] = w->items[(w->head + i) % w->capacity];
+        free(w->items);
+        w->items = items;
+        w->capacity = capacity;
+        w->head = 0;
+    }
+    w->items[(w->head + w->count++) % w->capacity] = r;
+    return 0;
+}
 
-    mlt_log_debug(NULL, "%s:%d: ctx=[%p][%s] entering\n", __FUNCTION__, __LINE__, ctx, ctx->name);
+/** Take the newest run from the bottom of a worker's deque.
+ *
+ * The worker's mutex must be held.
+ * \private \memberof mlt_slices_s
+ * \param w a worker
+ * \return a run or NULL if the deque is empty
+ */
 
-    pthread_mutex_lock(&ctx->cond_mutex);
+static struct mlt_slices_runtime_s *deque_pop(struct mlt_slices_worker_s *w)
+{
+    if (!w->count)
+        return NULL;
+    return w->items[(w->head + --w->count) % w->capacity];
+}
 
-    id = ctx->readys;
-    ctx->readys++;
+/** Take the oldest run from the top of another worker's deque.
+ *
+ * \private \memberof mlt_slices_s
+ * \param w a worker
+ * \return a run or NULL if the deque is empty
+ */
 
-    while (1) {
-        mlt_log_debug(NULL, "%s:%d: ctx=[%p][%s] waiting\n", __FUNCTION__, __LINE__, ctx, ctx->name);
+static struct mlt_slices_runtime_s *deque_steal(struct mlt_slices_worker_s *w)
+{
+    struct mlt_slices_runtime_s *r = NULL;
+    pthread_mutex_lock(&w->mutex);
+    if (w->count) {
+        r = w->items[w->head];
+        w->head = (w->head + 1) % w->capacity;
+        w->count--;
+    }
+    pthread_mutex_unlock(&w->mutex);
+    return r;
+}
 
-        /* wait for new jobs */
-        while (!ctx->f_exit && !(r = ctx->head))
-            pthread_cond_wait(&ctx->cond_var_job, &ctx->cond_mutex);
+/** Remove every reference to a run from a worker's deque.
+ *
+ * \private \memberof mlt_slices_s
+ * \param w a worker
+ * \param r a run
+ * \return the number of references removed
+ */
 
-        if (ctx->f_exit)
-            break;
+static int deque_remove(struct mlt_slices_worker_s *w, struct mlt_slices_runtime_s *r)
+{
+    int removed = 0;
+    pthread_mutex_lock(&w->mutex);
+    for (int i = 0; i < w->count; i++) {
+        struct mlt_slices_runtime_s *item = w->items[(w->head + i) % w->capacity];
+        if (item == r)
+            removed++;
+        else if (removed)
+            w->items[(w->head + i - removed) % w->capacity] = item;
+    }
+    w->count -= removed;
+    pthread_mutex_unlock(&w->mutex);
+    return removed;
+}
 
-        if (!r)
-            continue;
+/** Claim and run the jobs of a run until there are none left.
+ *
+ * \private \memberof mlt_slices_s
+ * \param r a run
+ * \param id the id of the thread doing the work
+ */
 
-        /* check if no new job */
-        if (r->curr == r->jobs) {
-            ctx->head = ctx->head->next;
-            if (!ctx->head)
-                ctx->tail = NULL;
-            mlt_log_debug(NULL, "%s:%d: new ctx->head=%p\n", __FUNCTION__, __LINE__, ctx->head);
-            continue;
-        };
+static void run_jobs(struct mlt_slices_runtime_s *r, int id)
+{
+    int idx;
+    while ((idx = atomic_fetch_add(&r->curr, 1)) < r->jobs)
+        r->proc(id, idx, r->jobs, r->cookie);
+}
 
-        /* new job id */
-        idx = r->curr;
-        r->curr++;
+/** Drop a helper's reference to a run and wake its caller if it was the last.
+ *
+ * The run must not be touched after this because the caller may return.
+ * \private \memberof mlt_slices_s
+ * \param ctx context pointer
+ * \param r a run
+ * \param count the number of references to drop
+ */
+
+static void run_release(mlt_slices ctx, struct mlt_slices_runtime_s *r, int count)
+{
+    if (count && atomic_fetch_sub(&r->refs, count) == count) {
+        pthread_mutex_lock(&ctx->done_mutex);
+        pthread_cond_broadcast(&ctx->done_cond);
+        pthread_mutex_unlock(&ctx->done_mutex);
+    }
+}
+
+static void *mlt_slices_worker(void *p)
+{
+    struct mlt_slices_worker_s *self = (struct mlt_slices_worker_s *) p;
+    mlt_slices ctx = self->ctx;
+    struct mlt_slices_runtime_s *r;
 
-        /* run job */
-        pthread_mutex_unlock(&ctx->cond_mutex);
+    mlt_log_debug(NULL, "%s:%d: ctx=[%p][%s] entering\n", __FUNCTION__, __LINE__, ctx, ctx->name);
+
+    pthread_mutex_lock(&self->mutex);
+    while (!atomic_load(&ctx->f_exit)) {
+        /* prefer our own newest run, then steal the oldest run of another worker */
+        r = deque_pop(self);
+        if (!r) {
+            pthread_mutex_unlock(&self->mutex);
+            for (int i = 1; !r && i < ctx->workers_count; i++)
+                r = deque_steal(&ctx->workers[(self->id - 1 + i) % ctx->workers_count]);
+            pthread_mutex_lock(&self->mutex);
+        }
+        if (!r) {
+            /* wait for new jobs */
+            if (!self->count && !atomic_load(&ctx->f_exit))
+                pthread_cond_wait(&self->cond, &self->mutex);
+            continue;
+        }
+
+        /* run jobs */
+        pthread_mutex_unlock(&self->mutex);
         mlt_log_debug(NULL,
-                      "%s:%d: running job: id=%d, idx=%d/%d, pool=[%s]\n",
+                      "%s:%d: running jobs: id=%d, jobs=%d, pool=[%s]\n",
                       __FUNCTION__,
                       __LINE__,
-                      id,
-                      idx,
+                      self->id,
                       r->jobs,
                       ctx->name);
-        r->proc(id, idx, r->jobs, r->cookie);
-        pthread_mutex_lock(&ctx->cond_mutex);
-
-        /* increase done jobs counter */
-        r->done++;
-
-        /* notify we fininished last job */
-        if (r->done == r->jobs) {
-            mlt_log_debug(NULL,
-                          "%s:%d: pthread_cond_signal( &ctx->cond_var_ready )\n",
-                          __FUNCTION__,
-                          __LINE__);
-            pthread_cond_broadcast(&ctx->cond_var_ready);
-        }
+        run_jobs(r, self->id);
+        run_release(ctx, r, 1);
+        pthread_mutex_lock(&self->mutex);
     }
-
-    pthread_mutex_unlock(&ctx->cond_mutex);
+    pthread_mutex_unlock(&self->mutex);
 
     return NULL;
 }
 
 /** Initialize a sliced threading context
+ *
+ * The calling thread of mlt_slices_run() works on its own slices, so only
+ * threads - 1 worker threads are started.
  *
  * \private \memberof mlt_slices_s
  * \param threads number of threads to use for job list, 0 for the number of CPUs
@@ -189,15 +305,18 @@ static mlt_slices mlt_slices_init(int threads, int policy, int priority)
         else if (!threads)
             threads = env_val;
     }
-    if (threads > MAX_SLICES)
-        threads = MAX_SLICES;
+    if (threads > MAX(MAX_SLICES, cpus))
+        threads = MAX(MAX_SLICES, cpus);
+    if (threads < 1)
+        threads = 1;
 
     ctx->count = threads;
+    ctx->workers_count = threads - 1;
+    ctx->workers = calloc(ctx->workers_count + 1, sizeof(struct mlt_slices_worker_s));
 
     /* init attributes */
-    pthread_mutex_init(&ctx->cond_mutex, NULL);
-    pthread_cond_init(&ctx->cond_var_job, NULL);
-    pthread_cond_init(&ctx->cond_var_ready, NULL);
+    pthread_mutex_init(&ctx->done_mutex, NULL);
+    pthread_cond_init(&ctx->done_cond, NULL);
     pthread_attr_init(&tattr);
     if (policy < 0)
         policy = SCHED_OTHER;
@@ -207,10 +326,17 @@ static mlt_slices mlt_slices_init(int threads, int policy, int priority)
     param.sched_priority = priority;
     pthread_attr_setschedparam(&tattr, &param);
 
-    /* run worker threads */
-    for (i = 0; i < ctx->count; i++) {
-        pthread_create(&ctx->threads[i], &tattr, mlt_slices_worker, ctx);
-        pthread_setschedparam(ctx->threads[i], policy, &param);
+    /* run worker threads, id 0 is used by the calling thread */
+    for (i = 0; i < ctx->workers_count; i++) {
+        struct mlt_slices_worker_s *w = &ctx->workers[i];
+        w->ctx = ctx;
+        w->id = i + 1;
+        pthread_mutex_init(&w->mutex, NULL);
+        pthread_cond_init(&w->cond, NULL);
+    }
+    for (i = 0; i < ctx->workers_count; i++) {
+        pthread_create(&ctx->workers[i].thread, &tattr, mlt_slices_worker, &ctx->workers[i]);
+        pthread_setschedparam(ctx->workers[i].thread, policy, &param);
     }
 
     pthread_attr_destroy(&tattr);
@@ -249,26 +375,36 @@ static void mlt_slices_close(mlt_slices ctx)
     pthread_mutex_unlock(&g_lock);
 
     /* notify to exit */
-    ctx->f_exit = 1;
-    pthread_mutex_lock(&ctx->cond_mutex);
-    pthread_cond_broadcast(&ctx->cond_var_job);
-    pthread_cond_broadcast(&ctx->cond_var_ready);
-    pthread_mutex_unlock(&ctx->cond_mutex);
+    atomic_store(&ctx->f_exit, 1);
+    for (j = 0; j < ctx->workers_count; j++) {
+        pthread_mutex_lock(&ctx->workers[j].mutex);
+        pthread_cond_broadcast(&ctx->workers[j].cond);
+        pthread_mutex_unlock(&ctx->workers[j].mutex);
+    }
 
     /* wait for threads exit */
-    for (j = 0; j < ctx->count; j++)
-        pthread_join(ctx->threads[j], NULL);
+    for (j = 0; j < ctx->workers_count; j++)
+        pthread_join(ctx->workers[j].thread, NULL);
 
     /* destroy vars */
-    pthread_cond_destroy(&ctx->cond_var_ready);
-    pthread_cond_destroy(&ctx->cond_var_job);
-    pthread_mutex_destroy(&ctx->cond_mutex);
+    for (j = 0; j < ctx->workers_count; j++) {
+        pthread_cond_destroy(&ctx->workers[j].cond);
+        pthread_mutex_destroy(&ctx->workers[j].mutex);
+        free(ctx->workers[j].items);
+    }
+    pthread_cond_destroy(&ctx->done_cond);
+    pthread_mutex_destroy(&ctx->done_mutex);
 
     /* free context */
+    free(ctx->workers);
     free(ctx);
 }
 
 /** Run sliced execution
+ *
+ * The run is offered to as many workers as it has spare jobs, and the
+ * calling thread claims jobs too, so a run never waits behind the queued
+ * work of other callers. Idle workers steal runs queued on busy workers.
  *
  * \private \memberof mlt_slices_s
  * \param ctx context pointer
@@ -284,9 +420,7 @@ static void mlt_slices_run(mlt_slices ctx, int jobs, mlt_slices_proc proc, void
         return;
     }
     struct mlt_slices_runtime_s runtime, *r = &runtime;
-
-    /* lock */
-    pthread_mutex_lock(&ctx->cond_mutex);
+    int i, helpers;
 
     /* check jobs count */
     if (jobs < 0)
@@ -296,35 +430,38 @@ static void mlt_slices_run(mlt_slices ctx, int jobs, mlt_slices_proc proc, void
 
     /* setup runtime args */
     r->jobs = jobs;
-    r->done = 0;
-    r->curr = 0;
+    atomic_init(&r->curr, 0);
     r->proc = proc;
     r->cookie = cookie;
-    r->next = NULL;
-
-    /* attach job */
-    if (ctx->tail) {
-        ctx->tail->next = r;
-        ctx->tail = r;
-    } else {
-        ctx->head = ctx->tail = r;
+    helpers = MIN(jobs - 1, ctx->workers_count);
+    if (thread_limit > 0)
+        helpers = MIN(helpers, thread_limit - 1);
+    atomic_init(&r->refs, helpers);
+
+    /* offer the run to the workers */
+    unsigned int first = atomic_fetch_add(&ctx->next_worker, helpers);
+    for (i = 0; i < helpers; i++) {
+        struct mlt_slices_worker_s *w = &ctx->workers[(first + i) % ctx->workers_count];
+        pthread_mutex_lock(&w->mutex);
+        if (deque_push(w, r))
+            run_release(ctx, r, 1);
+        else
+            pthread_cond_signal(&w->cond);
+        pthread_mutex_unlock(&w->mutex);
     }
 
-    /* notify workers */
-    pthread_cond_broadcast(&ctx->cond_var_job);
-
-    /* wait for end of task */
-    while (!ctx->f_exit && (r->done < r->jobs)) {
-        pthread_cond_wait(&ctx->cond_var_ready, &ctx->cond_mutex);
-        mlt_log_debug(NULL,
-                      "%s:%d: ctx=[%p][%s] signalled\n",
-                      __FUNCTION__,
-                      __LINE__,
-                      ctx,
-                      ctx->name);
+    /* help with our own jobs */
+    run_jobs(r, 0);
+
+    /* take back the offers no worker got to, and wait for the ones that did */
+    if (atomic_load(&r->refs) > 0) {
+        for (i = 0; i < ctx->workers_count; i++)
+            run_release(ctx, r, deque_remove(&ctx->workers[i], r));
+        pthread_mutex_lock(&ctx->done_mutex);
+        while (atomic_load(&r->refs) > 0)
+            pthread_cond_wait(&ctx->done_cond, &ctx->done_mutex);
+        pthread_mutex_unlock(&ctx->done_mutex);
     }
-
-    pthread_mutex_unlock(&ctx->cond_mutex);
 }
 
 /** Get a global shared sliced threading context.
@@ -419,6 +556,26 @@ void mlt_slices_run_fifo(int jobs, mlt_slices_proc proc, void *cookie)
     return mlt_slices_run(mlt_slices_get_global(mlt_policy_fifo), jobs, proc, cookie);
 }
 
+/** Limit the number of threads used by the slices of the calling thread.
+ *
+ * This lets a thread that is one of several working in parallel, such as a
+ * consumer's frame rendering threads, share the CPUs with the others instead
+ * of each fanning out to all of them. It does not change the number of jobs
+ * or the value of mlt_slices_count_normal() and friends; the calling thread
+ * simply runs more of its jobs itself.
+ *
+ * \public \memberof mlt_slices_s
+ * \param threads the most threads to use, including the calling thread, or 0 for no limit
+ * \return the previous limit
+ */
+
+int mlt_slices_set_thread_limit(int threads)
+{
+    int previous = thread_limit;
+    thread_limit = MAX(threads, 0);
+    return previous;
+}
+
 /** Compute size of a slice.
  *
  * This a helper function for use in a mlt_slices_proc() to get the number of
@@ -3,7 +3,7 @@
  * \brief sliced threading processing helper
  * \see mlt_slices_s
  *
- * Copyright (C) 2016-2022 Meltytech, LLC
+ * Copyright (C) 2016-2026 Meltytech, LLC
  *
  * This library is free software; you can redistribute it and/or
  * modify it under the terms of the GNU Lesser General Public
@@ -32,6 +32,12 @@
 
 struct mlt_slices_s;
 
+/** A function that processes one slice.
+ *
+ * \p id identifies the thread running the slice, where 0 is the thread that
+ * called mlt_slices_run_*() and helps with its own slices; \p idx is the
+ * slice index from 0 to \p jobs - 1.
+ */
 typedef int (*mlt_slices_proc)(int id, int idx, int jobs, void *cookie);
 
 MLT_EXPORT int mlt_slices_count_normal();
@@ -46,6 +52,8 @@ MLT_EXPORT void mlt_slices_run_rr(int jobs, mlt_slices_proc proc, void *cookie);
 
 MLT_EXPORT void mlt_slices_run_fifo(int jobs, mlt_slices_proc proc, void *cookie);
 
+MLT_EXPORT int mlt_slices_set_thread_limit(int threads);
+
 MLT_EXPORT int mlt_slices_size_slice(int jobs, int index, int input_size, int *start);
 
 #endif
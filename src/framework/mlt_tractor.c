@@ -28,10 +28,64 @@
 #include "mlt_transition.h"
 
 #include <ctype.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/** The interned names of the properties used when harvesting the tracks */
+
+static struct
+{
+    mlt_properties_key resize_alpha;
+    mlt_properties_key distort;
+    mlt_properties_key consumer;
+    mlt_properties_key width;
+    mlt_properties_key height;
+    mlt_properties_key format;
+    mlt_properties_key aspect_ratio;
+    mlt_properties_key audio_frequency;
+    mlt_properties_key audio_channels;
+    mlt_properties_key audio_samples;
+    mlt_properties_key multitrack;
+    mlt_properties_key producer;
+    mlt_properties_key last_track;
+    mlt_properties_key fx_cut;
+    mlt_properties_key hide;
+    mlt_properties_key image_count;
+    mlt_properties_key progressive;
+    mlt_properties_key original_producer;
+    mlt_properties_key test_audio;
+    mlt_properties_key test_image;
+    mlt_properties_key parallel_tracks;
+} keys;
+static pthread_once_t keys_once = PTHREAD_ONCE_INIT;
+
+static void keys_init()
+{
+    keys.resize_alpha = mlt_properties_intern("resize_alpha");
+    keys.distort = mlt_properties_intern("distort");
+    keys.consumer = mlt_properties_intern("consumer");
+    keys.width = mlt_properties_intern("width");
+    keys.height = mlt_properties_intern("height");
+    keys.format = mlt_properties_intern("format");
+    keys.aspect_ratio = mlt_properties_intern("aspect_ratio");
+    keys.audio_frequency = mlt_properties_intern("audio_frequency");
+    keys.audio_channels = mlt_properties_intern("audio_channels");
+    keys.audio_samples = mlt_properties_intern("audio_samples");
+    keys.multitrack = mlt_properties_intern("multitrack");
+    keys.producer = mlt_properties_intern("producer");
+    keys.last_track = mlt_properties_intern("last_track");
+    keys.fx_cut = mlt_properties_intern("fx_cut");
+    keys.hide = mlt_properties_intern("hide");
+    keys.image_count = mlt_properties_intern("image_count");
+    keys.progressive = mlt_properties_intern("progressive");
+    keys.original_producer = mlt_properties_intern("_producer");
+    keys.test_audio = mlt_properties_intern("test_audio");
+    keys.test_image = mlt_properties_intern("test_image");
+    keys.parallel_tracks = mlt_properties_intern("parallel_tracks");
+}
+
 /* Forward references to static methods.
 */
 
@@ -49,6 +103,7 @@ static void mlt_tractor_listener(mlt_multitrack tracks, mlt_tractor self);
 
 mlt_tractor mlt_tractor_init()
 {
+    pthread_once(&keys_once, keys_init);
     mlt_tractor self = calloc(1, sizeof(struct mlt_tractor_s));
     if (self != NULL) {
         mlt_producer producer = &self->parent;
@@ -84,6 +139,7 @@ mlt_tractor mlt_tractor_init()
 
 mlt_tractor mlt_tractor_new()
 {
+    pthread_once(&keys_once, keys_init);
     mlt_tractor self = calloc(1, sizeof(struct mlt_tractor_s));
     if (self != NULL) {
         mlt_producer producer = &self->parent;
@@ -358,28 +414,28 @@ static int producer_get_image(mlt_frame self,
     mlt_frame frame = mlt_frame_pop_service(self);
     mlt_properties frame_properties = MLT_FRAME_PROPERTIES(frame);
 
-    mlt_properties_set_int(frame_properties,
-                           "resize_alpha",
-                           mlt_properties_get_int(properties, "resize_alpha"));
-    mlt_properties_set_int(frame_properties,
-                           "distort",
-                           mlt_properties_get_int(properties, "distort"));
+    mlt_properties_set_int_k(frame_properties,
+                             keys.resize_alpha,
+                             mlt_properties_get_int_k(properties, keys.resize_alpha));
+    mlt_properties_set_int_k(frame_properties,
+                             keys.distort,
+                             mlt_properties_get_int_k(properties, keys.distort));
     mlt_properties_copy(frame_properties, properties, "consumer.");
     // WebVfx uses this to setup a consumer-stopping event handler.
-    mlt_properties_set_data(frame_properties,
-                            "consumer",
-                            mlt_properties_get_data(properties, "consumer", NULL),
-                            0,
-                            NULL,
-                            NULL);
+    mlt_properties_set_data_k(frame_properties,
+                              keys.consumer,
+                              mlt_properties_get_data_k(properties, keys.consumer, NULL),
+                              0,
+                              NULL,
+                              NULL);
 
     mlt_frame_get_image(frame, buffer, format, width, height, writable);
     mlt_frame_set_image(self, *buffer, 0, NULL);
 
-    mlt_properties_set_int(properties, "width", *width);
-    mlt_properties_set_int(properties, "height", *height);
-    mlt_properties_set_int(properties, "format", *format);
-    mlt_properties_set_double(properties, "aspect_ratio", mlt_frame_get_aspect_ratio(frame));
+    mlt_properties_set_int_k(properties, keys.width, *width);
+    mlt_properties_set_int_k(properties, keys.height, *height);
+    mlt_properties_set_int_k(properties, keys.format, *format);
+    mlt_properties_set_double_k(properties, keys.aspect_ratio, mlt_frame_get_aspect_ratio(frame));
     // Pass all required frame properties
     mlt_properties_pass_list(
         properties,
@@ -449,9 +505,9 @@ static int producer_get_audio(mlt_frame self,
                         *format,
                         mlt_audio_format_size(*format, *samples, *channels),
                         NULL);
-    mlt_properties_set_int(properties, "audio_frequency", *frequency);
-    mlt_properties_set_int(properties, "audio_channels", *channels);
-    mlt_properties_set_int(properties, "audio_samples", *samples);
+    mlt_properties_set_int_k(properties, keys.audio_frequency, *frequency);
+    mlt_properties_set_int_k(properties, keys.audio_channels, *channels);
+    mlt_properties_set_int_k(properties, keys.audio_samples, *samples);
     return 0;
 }
 
@@ -480,10 +536,10 @@ static int producer_get_frame(mlt_producer parent, mlt_frame_ptr frame, int trac
         mlt_properties properties = MLT_PRODUCER_PROPERTIES(parent);
 
         // Try to obtain the multitrack associated to the tractor
-        mlt_multitrack multitrack = mlt_properties_get_data(properties, "multitrack", NULL);
+        mlt_multitrack multitrack = mlt_properties_get_data_k(properties, keys.multitrack, NULL);
 
         // Or a specific producer
-        mlt_producer producer = mlt_properties_get_data(properties, "producer", NULL);
+        mlt_producer producer = mlt_properties_get_data_k(properties, keys.producer, NULL);
 
         // If we don't have one, we're in trouble...
         if (multitrack != NULL) {
@@ -508,6 +564,9 @@ static int producer_get_frame(mlt_producer parent, mlt_frame_ptr frame, int trac
             // Temporary properties
             mlt_properties temp_properties = NULL;
 
+            // Let transitions get the images of their tracks at the same time
+            int parallel = mlt_properties_get_int_k(properties, keys.parallel_tracks);
+
             // Get the multitrack's producer
             mlt_producer target = MLT_MULTITRACK_PRODUCER(multitrack);
             mlt_producer_seek(target, mlt_producer_frame(parent));
@@ -547,13 +606,16 @@ static int producer_get_frame(mlt_producer parent, mlt_frame_ptr frame, int trac
                     (*frame)->convert_audio = temp->convert_audio;
 
                 // Check for last track
-                done = mlt_properties_get_int(temp_properties, "last_track");
+                done = mlt_properties_get_int_k(temp_properties, keys.last_track);
 
                 // Handle fx only tracks
-                if (mlt_properties_get_int(temp_properties, "fx_cut")) {
-                    mlt_properties_set_int(temp_properties, "hide", 3);
+                if (mlt_properties_get_int_k(temp_properties, keys.fx_cut)) {
+                    mlt_properties_set_int_k(temp_properties, keys.hide, 3);
                 }
 
+                if (parallel)
+                    mlt_properties_set_int_k(temp_properties, keys.parallel_tracks, 1);
+
                 // We store all frames with a destructor on the output frame
                 snprintf(label, sizeof(label), "mlt_tractor %s_%d", id, count++);
                 mlt_properties_set_data(frame_properties,
@@ -565,7 +627,7 @@ static int producer_get_frame(mlt_producer parent, mlt_frame_ptr frame, int trac
 
                 // Pick up first video and audio frames
                 if (!done && !mlt_frame_is_test_audio(temp)
-                    && !(mlt_properties_get_int(temp_properties, "hide") & 2)) {
+                    && !(mlt_properties_get_int_k(temp_properties, keys.hide) & 2)) {
                     // Order of frame creation is starting to get problematic
                     if (audio != NULL) {
                         mlt_deque_push_front(MLT_FRAME_AUDIO_STACK(temp), producer_get_audio);
@@ -574,7 +636,7 @@ static int producer_get_frame(mlt_producer parent, mlt_frame_ptr frame, int trac
                     audio = temp;
                 }
                 if (!done && !mlt_frame_is_test_card(temp)
-                    && !(mlt_properties_get_int(temp_properties, "hide") & 1)) {
+                    && !(mlt_properties_get_int_k(temp_properties, keys.hide) & 1)) {
                     if (video != NULL) {
                         mlt_deque_push_front(MLT_FRAME_IMAGE_STACK(temp), producer_get_image);
                         mlt_deque_push_front(MLT_FRAME_IMAGE_STACK(temp), video);
@@ -583,7 +645,9 @@ static int producer_get_frame(mlt_producer parent, mlt_frame_ptr frame, int trac
                     if (first_video == NULL)
                         first_video = temp;
 
-                    mlt_properties_set_int(MLT_FRAME_PROPERTIES(temp), "image_count", ++image_count);
+                    mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(temp),
+                                             keys.image_count,
+                                             ++image_count);
                     image_count = 1;
                 }
             }
@@ -598,37 +662,38 @@ static int producer_get_frame(mlt_producer parent, mlt_frame_ptr frame, int trac
                 mlt_properties video_properties = MLT_FRAME_PROPERTIES(first_video);
                 mlt_frame_push_service(*frame, video);
                 mlt_frame_push_service(*frame, producer_get_image);
-                mlt_properties_set_int(frame_properties,
-                                       "width",
-                                       mlt_properties_get_int(video_properties, "width"));
-                mlt_properties_set_int(frame_properties,
-                                       "height",
-                                       mlt_properties_get_int(video_properties, "height"));
-                mlt_properties_set_int(frame_properties,
-                                       "format",
-                                       mlt_properties_get_int(video_properties, "format"));
+                mlt_properties_set_int_k(frame_properties,
+                                         keys.width,
+                                         mlt_properties_get_int_k(video_properties, keys.width));
+                mlt_properties_set_int_k(frame_properties,
+                                         keys.height,
+                                         mlt_properties_get_int_k(video_properties, keys.height));
+                mlt_properties_set_int_k(frame_properties,
+                                         keys.format,
+                                         mlt_properties_get_int_k(video_properties, keys.format));
                 mlt_properties_pass_list(frame_properties,
                                          video_properties,
                                          "meta.media.width, meta.media.height");
-                mlt_properties_set_int(frame_properties,
-                                       "progressive",
-                                       mlt_properties_get_int(video_properties, "progressive"));
-                mlt_properties_set_double(frame_properties,
-                                          "aspect_ratio",
-                                          mlt_properties_get_double(video_properties,
-                                                                    "aspect_ratio"));
-                mlt_properties_set_int(frame_properties, "image_count", image_count);
-                mlt_properties_set_data(frame_properties,
-                                        "_producer",
-                                        mlt_frame_get_original_producer(first_video),
-                                        0,
-                                        NULL,
-                                        NULL);
+                mlt_properties_set_int_k(frame_properties,
+                                         keys.progressive,
+                                         mlt_properties_get_int_k(video_properties,
+                                                                  keys.progressive));
+                mlt_properties_set_double_k(frame_properties,
+                                            keys.aspect_ratio,
+                                            mlt_properties_get_double_k(video_properties,
+                                                                    keys.aspect_ratio));
+                mlt_properties_set_int_k(frame_properties, keys.image_count, image_count);
+                mlt_properties_set_data_k(frame_properties,
+                                          keys.original_producer,
+                                          mlt_frame_get_original_producer(first_video),
+                                          0,
+                                          NULL,
+                                          NULL);
             }
 
             mlt_frame_set_position(*frame, mlt_producer_frame(parent));
-            mlt_properties_set_int(MLT_FRAME_PROPERTIES(*frame), "test_audio", audio == NULL);
-            mlt_properties_set_int(MLT_FRAME_PROPERTIES(*frame), "test_image", video == NULL);
+            mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(*frame), keys.test_audio, audio == NULL);
+            mlt_properties_set_int_k(MLT_FRAME_PROPERTIES(*frame), keys.test_image, video == NULL);
         } else if (producer != NULL) {
             mlt_producer_seek(producer, mlt_producer_frame(parent));
             mlt_producer_set_speed(producer, mlt_producer_get_speed(parent));
@@ -34,6 +34,10 @@
  * \properties \em multitrack holds a reference to the multitrack object that a tractor manages
  * \properties \em field holds a reference to the field object that a tractor manages
  * \properties \em producer holds a reference to an encapsulated producer
+ * \properties \em parallel_tracks set to 1 to let transitions get the images of their a and b
+ * tracks at the same time, on the slices thread pool, when the b image they request does not
+ * depend on the a image and the consumer is progressive. The track frames carry the property too
+ * so that transitions can see it.
  */
 
 struct mlt_tractor_s
@@ -375,7 +375,10 @@ static int get_image_b(mlt_frame b_frame,
                                    mlt_profile_sar(
                                        mlt_service_profile(MLT_TRANSITION_SERVICE(self))));
 
+    // The a frame may be getting its image on another thread
+    mlt_properties_lock(a_props);
     mlt_properties_copy(b_props, a_props, "consumer.");
+    mlt_properties_unlock(a_props);
 
     return mlt_frame_get_image(b_frame, image, format, width, height, writable);
 }
@@ -305,6 +305,8 @@ typedef struct mlt_slices_s *mlt_slices; /**< pointer to Sliced processing conte
 typedef struct mlt_link_s *mlt_link;     /**< pointer to Link object */
 typedef struct mlt_chain_s *mlt_chain;   /**< pointer to Chain object */
 
+typedef const struct mlt_properties_key_s *mlt_properties_key; /**< pointer to Properties Key */
+
 typedef void (*mlt_destructor)(void *);              /**< pointer to destructor function */
 typedef char *(*mlt_serialiser)(void *, int length); /**< pointer to serialization function */
 typedef void *(*mlt_thread_function_t)(void *);      /**< generic thread function pointer */
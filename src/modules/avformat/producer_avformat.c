@@ -62,19 +62,46 @@
 #include <math.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <wchar.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #define POSITION_INITIAL (-2)
 #define POSITION_INVALID (-1)
 
+#define KEYFRAMES_MAGIC "MLTKEYF2"
+#define REVERSE_CACHE_BYTES (256 * 1024 * 1024)
+#define MAX_DECODE_AHEAD (100)
+
 #define MAX_AUDIO_STREAMS (32)
 #define MAX_AUDIO_FRAME_SIZE (192000) // 1 second of 48khz 32bit audio
 #define IMAGE_ALIGN (1)
 #define VFR_THRESHOLD \
     (3) // The minimum number of video frames with differing durations to be considered VFR.
 
+// A scaler context and the parameters with which it was initialised
+struct sws_cache_s
+{
+    struct SwsContext *context;
+    int width, height, src_format, dst_format, flags;
+    int src_v_chr_pos, dst_v_chr_pos;
+    int src_colorspace, dst_colorspace, src_full_range, dst_full_range;
+    int transfer_error; // the result of mlt_set_luma_transfer()
+};
+
+// The fixed slots of producer_avformat_s.sws_cache; slices use the ones after these
+enum {
+    SWS_CACHE_INTERMEDIATE,
+    SWS_CACHE_MAIN,
+    SWS_CACHE_SLICES,
+};
+
 struct producer_avformat_s
 {
     mlt_producer parent;
@@ -127,6 +154,25 @@ struct producer_avformat_s
     pthread_cond_t packets_cond;
     int packets_thread_ret; // latest non-zero non-EGAIN return on av_read_frame() in packets_thread
     int packets_thread_stop; // non-zero when packets_thread is to stop
+    int packets_reading; // non-zero while packets_thread reads without holding packets_mutex
+    int64_t packets_bytes;     // size of the packets in vpackets
+    int64_t readahead_bytes;   // how many bytes of video packets packets_thread may queue
+    double readahead_duration; // how many seconds of video packets packets_thread may queue
+    struct
+    {
+        struct keyframe_s
+        {
+            int64_t pts;    // the presentation time stamp of a key frame
+            int64_t pos;    // the byte offset of its packet or -1
+            int64_t closed; // non-zero if the next entry is the next key frame
+        } *entries;         // sorted by pts
+        int count;
+        int size;
+        int last;   // the entry of the last key frame read since a seek or -1
+        int loaded; // whether the demuxer index and the cache file were read
+        int dirty;  // whether there are entries that are not in the cache file
+        char *path; // the cache file
+    } keyframes;
     int is_thread_init;
     AVRational video_time_base;
     mlt_frame last_good_frame; // for video error concealment
@@ -150,6 +196,27 @@ struct producer_avformat_s
         AVFilterContext *filter_in;
         AVFilterContext *filter_out;
     } hwaccel;
+    struct sws_cache_s *sws_cache; // only used while holding video_mutex
+    int sws_cache_count;
+    mlt_cache reverse_cache; // pictures kept while playing backwards, only used holding video_mutex
+    int64_t reverse_request; // the last position requested to decode, only used holding video_mutex
+    int reverse_run;         // the number of requests in a row for a lower position, likewise
+    struct
+    {
+        pthread_t thread;
+        pthread_mutex_t mutex;
+        pthread_cond_t cond;
+        int is_init;
+        int stop;
+        int frames;                // how many frames to keep ready after the last request
+        int clamped;               // the decode_ahead last reduced, only used holding video_mutex
+        mlt_position position;     // the last position requested during normal play or -1
+        mlt_position next;         // the next position to decode
+        mlt_image_format format;   // the image format of the last request
+        int width;                 // the image width of the last request
+        int height;                // the image height of the last request
+        mlt_properties properties; // the consumer properties of the last request
+    } ahead; // decode-ahead of the positions following a request during normal play
 };
 typedef struct producer_avformat_s *producer_avformat;
 
@@ -162,6 +229,11 @@ static int producer_probe(mlt_producer producer);
 static void producer_avformat_close(producer_avformat);
 static void producer_close(mlt_producer parent);
 static void producer_set_up_video(producer_avformat self, mlt_frame frame);
+static void decode_ahead_update(producer_avformat self,
+                                mlt_frame frame,
+                                mlt_image_format format,
+                                int width,
+                                int height);
 static void producer_set_up_audio(producer_avformat self, mlt_frame frame);
 static void apply_properties(void *obj, mlt_properties properties, int flags);
 static int video_codec_init(producer_avformat self, int index, mlt_properties properties);
@@ -1690,8 +1762,390 @@ static int producer_open(
     return error;
 }
 
+/** Find the last key frame at or before a time stamp.
+ *
+ * \return the index of the entry or -1
+ */
+
+static int keyframes_find(producer_avformat self, int64_t pts)
+{
+    int lo = 0, hi = self->keyframes.count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (self->keyframes.entries[mid].pts <= pts)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo - 1;
+}
+
+/** Remove a key frame from the index. */
+
+static void keyframes_remove(producer_avformat self, int i)
+{
+    // The range before it is only known to have no key frame if the range after it was too
+    if (i > 0)
+        self->keyframes.entries[i - 1].closed &= self->keyframes.entries[i].closed;
+    memmove(&self->keyframes.entries[i],
+            &self->keyframes.entries[i + 1],
+            (self->keyframes.count - i - 1) * sizeof(struct keyframe_s));
+    if (self->keyframes.last == i)
+        self->keyframes.last = -1;
+    else if (self->keyframes.last > i)
+        self->keyframes.last--;
+    self->keyframes.count--;
+    self->keyframes.dirty = 1;
+}
+
+/** Add a key frame to the index.
+ *
+ * \return the index of the entry or -1 on error
+ */
+
+static int keyframes_add(producer_avformat self, int64_t pts, int64_t pos)
+{
+    int i = keyframes_find(self, pts);
+
+    if (i >= 0 && self->keyframes.entries[i].pts == pts) {
+        if (self->keyframes.entries[i].pos < 0 && pos >= 0) {
+            self->keyframes.entries[i].pos = pos;
+            self->keyframes.dirty = 1;
+        }
+        return i;
+    }
+    // Correct the estimated time stamp of an entry of the same packet
+    if (pos >= 0) {
+        int j;
+        for (j = i; j <= i + 1; j++) {
+            if (j >= 0 && j < self->keyframes.count && self->keyframes.entries[j].pos == pos) {
+                // The binary search needs the time stamps in order
+                if ((j == 0 || self->keyframes.entries[j - 1].pts < pts)
+                    && (j + 1 == self->keyframes.count
+                        || pts < self->keyframes.entries[j + 1].pts)) {
+                    self->keyframes.entries[j].pts = pts;
+                    self->keyframes.dirty = 1;
+                    return j;
+                }
+                keyframes_remove(self, j);
+                i = keyframes_find(self, pts);
+                break;
+            }
+        }
+    }
+    if (self->keyframes.count == self->keyframes.size) {
+        int size = self->keyframes.size ? self->keyframes.size * 2 : 256;
+        struct keyframe_s *entries = realloc(self->keyframes.entries, size * sizeof(*entries));
+        if (!entries)
+            return -1;
+        self->keyframes.entries = entries;
+        self->keyframes.size = size;
+    }
+    i++;
+    memmove(&self->keyframes.entries[i + 1],
+            &self->keyframes.entries[i],
+            (self->keyframes.count - i) * sizeof(struct keyframe_s));
+    self->keyframes.entries[i].pts = pts;
+    self->keyframes.entries[i].pos = pos;
+    // A key frame can not be inside of a range that is known to have none
+    self->keyframes.entries[i].closed = i > 0 && self->keyframes.entries[i - 1].closed;
+    if (self->keyframes.last >= i)
+        self->keyframes.last++;
+    self->keyframes.count++;
+    self->keyframes.dirty = 1;
+    return i;
+}
+
+/** Record a video packet read in sequence.
+ *
+ * Two key frames read one after the other close the range between them.
+ * The caller must hold packets_mutex.
+ */
+
+static void keyframes_observe(producer_avformat self, AVPacket *pkt)
+{
+    int64_t pts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+
+    if (!(pkt->flags & AV_PKT_FLAG_KEY) || pts == AV_NOPTS_VALUE)
+        return;
+    int last = self->keyframes.last;
+    int i = keyframes_add(self, pts, pkt->pos);
+    if (i > 0 && last >= 0 && last == i - 1 && !self->keyframes.entries[last].closed) {
+        self->keyframes.entries[last].closed = 1;
+        self->keyframes.dirty = 1;
+    }
+    self->keyframes.last = i;
+}
+
+static uint64_t keyframes_hash(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *p = data;
+    while (size--)
+        hash = (hash ^ *p++) * UINT64_C(0x100000001b3);
+    return hash;
+}
+
+/** Fill the index from the demuxer and the cache file.
+ *
+ * The cache file is in the directory of the keyframe_cache property or the
+ * MLT_AVFORMAT_KEYFRAME_CACHE environment variable. It is named by a hash of
+ * the file name, size, modification time, and video stream.
+ */
+
+static void keyframes_load(producer_avformat self)
+{
+    AVFormatContext *context = self->video_format;
+
+    self->keyframes.loaded = 1;
+    self->keyframes.last = -1;
+
+#if LIBAVFORMAT_VERSION_INT >= ((58 << 16) + (78 << 8) + 100)
+    AVStream *stream = context->streams[self->video_index];
+    int i, n = avformat_index_get_entries_count(stream);
+
+    // The index has decoding time stamps. When frames are reordered, estimate the
+    // presentation time stamps from the first key frame. Reading a key frame corrects it.
+    int64_t delay = 0;
+    if (stream->codecpar->video_delay > 0) {
+        for (i = 0; i < n && !(avformat_index_get_entry(stream, i)->flags & AVINDEX_KEYFRAME); i++)
+            ;
+        if (i == n || self->first_pts == AV_NOPTS_VALUE)
+            n = 0;
+        else
+            delay = self->first_pts - avformat_index_get_entry(stream, i)->timestamp;
+    }
+
+    // The QuickTime demuxer indexes every key frame
+    int complete = strstr(context->iformat->name, "mov") != NULL;
+    for (i = 0; i < n; i++) {
+        const AVIndexEntry *entry = avformat_index_get_entry(stream, i);
+        if (entry->flags & AVINDEX_KEYFRAME) {
+            int j = keyframes_add(self, entry->timestamp + delay, entry->pos);
+            if (complete && j > 0 && self->keyframes.last == j - 1)
+                self->keyframes.entries[j - 1].closed = 1;
+            self->keyframes.last = j;
+        }
+    }
+    self->keyframes.last = -1;
+#endif
+    self->keyframes.dirty = 0;
+
+    const char *directory = mlt_properties_get(MLT_PRODUCER_PROPERTIES(self->parent),
+                                               "keyframe_cache");
+    if (!directory)
+        directory = getenv("MLT_AVFORMAT_KEYFRAME_CACHE");
+    struct stat info;
+    if (!directory || !*directory || !context->url || stat(context->url, &info))
+        return;
+
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    int64_t size = info.st_size, mtime = info.st_mtime;
+    hash = keyframes_hash(hash, context->url, strlen(context->url));
+    hash = keyframes_hash(hash, &size, sizeof(size));
+    hash = keyframes_hash(hash, &mtime, sizeof(mtime));
+    hash = keyframes_hash(hash, &self->video_index, sizeof(self->video_index));
+    self->keyframes.path = av_asprintf("%s/%016" PRIx64 ".keyframes", directory, hash);
+
+    FILE *file = self->keyframes.path ? fopen(self->keyframes.path, "rb") : NULL;
+    if (file) {
+        char magic[sizeof(KEYFRAMES_MAGIC) - 1];
+        int64_t count = 0;
+        struct keyframe_s entry;
+        if (fread(magic, sizeof(magic), 1, file) == 1
+            && !memcmp(magic, KEYFRAMES_MAGIC, sizeof(magic))
+            && fread(&count, sizeof(count), 1, file) == 1) {
+            while (count-- > 0 && fread(&entry, sizeof(entry), 1, file) == 1) {
+                int j = keyframes_add(self, entry.pts, entry.pos);
+                if (j >= 0 && entry.closed)
+                    self->keyframes.entries[j].closed = 1;
+            }
+        }
+        fclose(file);
+    }
+    self->keyframes.dirty = 0;
+}
+
+static void keyframes_save(producer_avformat self)
+{
+    if (self->keyframes.dirty && self->keyframes.path) {
+        char *temp = av_asprintf("%s.tmp", self->keyframes.path);
+        FILE *file = temp ? fopen(temp, "wb") : NULL;
+        if (file) {
+            int64_t count = self->keyframes.count;
+            int error = fwrite(KEYFRAMES_MAGIC, sizeof(KEYFRAMES_MAGIC) - 1, 1, file) != 1
+                        || fwrite(&count, sizeof(count), 1, file) != 1
+                        || fwrite(self->keyframes.entries,
+                                  sizeof(struct keyframe_s),
+                                  count,
+                                  file)
+                               != count;
+            error |= fclose(file);
+            if (error || rename(temp, self->keyframes.path))
+                remove(temp);
+        }
+        av_free(temp);
+        self->keyframes.dirty = 0;
+    }
+}
+
+static void keyframes_close(producer_avformat self)
+{
+    keyframes_save(self);
+    free(self->keyframes.entries);
+    av_free(self->keyframes.path);
+    memset(&self->keyframes, 0, sizeof(self->keyframes));
+}
+
+/** Change the video stream and forget the key frames of the previous one.
+ *
+ * The index of the new stream is loaded on the next seek.
+ */
+
+static void keyframes_set_video_index(producer_avformat self, int index)
+{
+    pthread_mutex_lock(&self->packets_mutex);
+    if (index != self->video_index)
+        keyframes_close(self);
+    self->video_index = index;
+    pthread_mutex_unlock(&self->packets_mutex);
+}
+
+/** Wait until packets_worker is not reading from the video format context.
+ *
+ * The caller must hold packets_mutex.
+ */
+
+static void wait_packets_reader(producer_avformat self)
+{
+    while (self->packets_reading)
+        pthread_cond_wait(&self->packets_cond, &self->packets_mutex);
+}
+
+static void vpackets_push(producer_avformat self, AVPacket *pkt)
+{
+    if (pkt) {
+        mlt_deque_push_back(self->vpackets, pkt);
+        self->packets_bytes += pkt->size;
+    }
+}
+
+static AVPacket *vpackets_pop(producer_avformat self)
+{
+    AVPacket *pkt = mlt_deque_pop_front(self->vpackets);
+    if (pkt)
+        self->packets_bytes -= pkt->size;
+    return pkt;
+}
+
+static void vpackets_clear(producer_avformat self)
+{
+    while (mlt_deque_count(self->vpackets) > 0) {
+        AVPacket *tmp = vpackets_pop(self);
+        av_packet_free(&tmp);
+    }
+}
+
+/** Determine if packets_worker has read far enough ahead of the decoder.
+ *
+ * Without a readahead_bytes or readahead_duration, only one packet is queued.
+ */
+
+static int vpackets_full(producer_avformat self)
+{
+    int count = mlt_deque_count(self->vpackets);
+
+    if (count < 1)
+        return 0;
+    if (self->readahead_bytes <= 0 && self->readahead_duration <= 0.0)
+        return 1;
+    if (self->readahead_bytes > 0 && self->packets_bytes >= self->readahead_bytes)
+        return 1;
+    if (self->readahead_duration > 0.0 && count > 1) {
+        AVPacket *first = mlt_deque_peek_front(self->vpackets);
+        AVPacket *last = mlt_deque_peek_back(self->vpackets);
+        AVRational time_base = self->video_format->streams[self->video_index]->time_base;
+        if (first->dts != AV_NOPTS_VALUE && last->dts != AV_NOPTS_VALUE
+            && (last->dts - first->dts) * av_q2d(time_base) >= self->readahead_duration)
+            return 1;
+    }
+    return 0;
+}
+
+/** Release the pictures kept for reverse playback. */
+
+static void reverse_clear(producer_avformat self)
+{
+    mlt_cache_close(self->reverse_cache);
+    self->reverse_cache = NULL;
+}
+
+static void reverse_frame_close(void *data)
+{
+    AVFrame *frame = data;
+    av_frame_free(&frame);
+}
+
+/** Get the cache key of a position, which must not be negative. */
+
+static inline void *reverse_key(int64_t position)
+{
+    return (void *) (intptr_t) (position + 1);
+}
+
+/** Keep a reference to a picture decoded for a request.
+ *
+ * The pictures are charged to the shared cache budget. When they exceed max_bytes,
+ * the least recently decoded are released first, which are the ones farthest from
+ * the requested position since every seek goes back to an earlier key frame.
+ */
+
+static void reverse_put(producer_avformat self, AVFrame *frame, int64_t position, int64_t max_bytes)
+{
+    int64_t bytes = 0;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && frame->buf[i]; i++)
+        bytes += frame->buf[i]->size;
+    if (position < 0 || bytes > max_bytes || bytes > INT_MAX)
+        return;
+
+    if (!self->reverse_cache) {
+        self->reverse_cache = mlt_cache_init();
+        if (!self->reverse_cache)
+            return;
+        mlt_cache_share(self->reverse_cache);
+    }
+    mlt_cache_set_max_bytes(self->reverse_cache, max_bytes);
+    AVFrame *clone = av_frame_clone(frame);
+    if (clone)
+        mlt_cache_put(self->reverse_cache,
+                      reverse_key(position),
+                      clone,
+                      (int) bytes,
+                      reverse_frame_close);
+}
+
+/** Get a new reference to the kept picture at a position or NULL.
+ *
+ * The picture is released from the cache since playing backwards does not return to it.
+ */
+
+static AVFrame *reverse_get(producer_avformat self, int64_t position)
+{
+    if (!self->reverse_cache || position < 0)
+        return NULL;
+    AVFrame *frame = NULL;
+    mlt_cache_item item = mlt_cache_get(self->reverse_cache, reverse_key(position));
+    if (item) {
+        frame = av_frame_clone(mlt_cache_item_data(item, NULL));
+        mlt_cache_item_close(item);
+        mlt_cache_purge(self->reverse_cache, reverse_key(position));
+    }
+    return frame;
+}
+
 static void prepare_reopen(producer_avformat self)
 {
+    // The callers hold packets_mutex
+    wait_packets_reader(self);
     mlt_service_lock(MLT_PRODUCER_SERVICE(self->parent));
     pthread_mutex_lock(&self->audio_mutex);
     pthread_mutex_lock(&self->open_mutex);
@@ -1706,6 +2160,7 @@ static void prepare_reopen(producer_avformat self)
     }
     avcodec_free_context(&self->video_codec);
     av_frame_unref(self->video_frame);
+    reverse_clear(self);
     av_buffer_unref(&self->hwaccel.device_ctx);
     self->hwaccel.device_ctx = NULL;
     if (self->seekable && self->audio_format)
@@ -1741,6 +2196,8 @@ static void prepare_reopen(producer_avformat self)
         mlt_deque_close(self->vpackets);
         self->vpackets = NULL;
     }
+    self->packets_bytes = 0;
+    keyframes_close(self);
     pthread_mutex_unlock(&self->audio_mutex);
     mlt_service_unlock(MLT_PRODUCER_SERVICE(self->parent));
 }
@@ -1846,6 +2303,22 @@ static void find_first_pts(producer_avformat self, int video_index)
     av_seek_frame(context, -1, 0, AVSEEK_FLAG_BACKWARD);
 }
 
+/** Convert a position in source frames to a time stamp of the video stream.
+ */
+
+static int64_t position_timestamp(producer_avformat self, int64_t req_position, double source_fps)
+{
+    AVFormatContext *context = self->video_format;
+    int64_t timestamp = req_position / (av_q2d(self->video_time_base) * source_fps);
+    if (req_position <= 0)
+        timestamp = 0;
+    else if (self->first_pts != AV_NOPTS_VALUE)
+        timestamp += self->first_pts;
+    else if (context->start_time != AV_NOPTS_VALUE)
+        timestamp += context->start_time;
+    return timestamp;
+}
+
 static int seek_video(producer_avformat self,
                       mlt_position position,
                       int64_t req_position,
@@ -1859,6 +2332,7 @@ static int seek_video(producer_avformat self,
         seek_threshold = 64;
 
     pthread_mutex_lock(&self->packets_mutex);
+    wait_packets_reader(self);
 
     if (self->video_seekable && (position != self->video_expected || self->last_position < 0)) {
         // Fetch the video format context
@@ -1871,22 +2345,34 @@ static int seek_video(producer_avformat self,
         if (self->first_pts == AV_NOPTS_VALUE && self->last_position == POSITION_INITIAL)
             find_first_pts(self, self->video_index);
 
+        if (!self->keyframes.loaded && self->video_index >= 0)
+            keyframes_load(self);
+
+        // Calculate the timestamp for the requested frame
+        int64_t timestamp = position_timestamp(self, req_position, source_fps);
+
+        // Find the GOP of the requested frame when the index knows it
+        int keyframe = keyframes_find(self, timestamp);
+        if (keyframe >= 0
+            && !(keyframe + 1 < self->keyframes.count && self->keyframes.entries[keyframe].closed
+                 && self->keyframes.entries[keyframe + 1].pts > timestamp))
+            keyframe = -1;
+
+        // Seek forward only if the requested frame is in a later GOP than the current one
+        int seek_forward = position - self->video_expected >= seek_threshold;
+        if (keyframe >= 0 && self->last_position >= 0)
+            seek_forward = self->keyframes.entries[keyframe].pts
+                           > position_timestamp(self, self->last_position, source_fps);
+
         if (self->video_frame && position + 1 == self->video_expected) {
             // We're paused - use last image
             paused = 1;
-        } else if (position < self->video_expected
-                   || position - self->video_expected >= seek_threshold
-                   || self->last_position < 0) {
-            // Calculate the timestamp for the requested frame
-            int64_t timestamp = req_position / (av_q2d(self->video_time_base) * source_fps);
-            if (req_position <= 0)
-                timestamp = 0;
-            else if (self->first_pts != AV_NOPTS_VALUE)
-                timestamp += self->first_pts;
-            else if (context->start_time != AV_NOPTS_VALUE)
-                timestamp += context->start_time;
+        } else if (position < self->video_expected || seek_forward || self->last_position < 0) {
             if (preseek && av_q2d(self->video_time_base) != 0)
                 timestamp -= 2 / av_q2d(self->video_time_base);
+            else if (keyframe >= 0)
+                // Go directly to the key frame that starts the GOP
+                timestamp = self->keyframes.entries[keyframe].pts;
             if (timestamp < 0)
                 timestamp = 0;
             // cppcheck-suppress syntaxError
@@ -1898,9 +2384,19 @@ static int seek_video(producer_avformat self,
                           self->video_expected,
                           self->last_position);
 
-            // Seek to the timestamp
+            // Seek by byte offset where timestamps are unreliable, otherwise by timestamp
             self->video_codec->skip_loop_filter = AVDISCARD_NONREF;
-            av_seek_frame(context, self->video_index, timestamp, AVSEEK_FLAG_BACKWARD);
+            int byte_seek = !preseek && keyframe >= 0 && self->keyframes.entries[keyframe].pos >= 0
+                            && (context->iformat->flags & AVFMT_TS_DISCONT)
+                            && !(context->iformat->flags & AVFMT_NO_BYTE_SEEK);
+            if (!byte_seek
+                || av_seek_frame(context,
+                                 self->video_index,
+                                 self->keyframes.entries[keyframe].pos,
+                                 AVSEEK_FLAG_BYTE)
+                       < 0)
+                av_seek_frame(context, self->video_index, timestamp, AVSEEK_FLAG_BACKWARD);
+            self->keyframes.last = -1;
 
             // flush any pictures still in decode buffer
             avcodec_flush_buffers(self->video_codec);
@@ -1912,12 +2408,9 @@ static int seek_video(producer_avformat self,
             }
 
             // empty vpackets
-            while (mlt_deque_count(self->vpackets) > 0) {
-                AVPacket *tmp = (AVPacket *) mlt_deque_pop_front(self->vpackets);
-                av_packet_free(&tmp);
-            }
+            vpackets_clear(self);
 
-            pthread_cond_signal(&self->packets_cond);
+            pthread_cond_broadcast(&self->packets_cond);
 
             // Remove the cached info relating to the previous position
             self->current_position = POSITION_INVALID;
@@ -2108,6 +2601,87 @@ static void property_changed(mlt_service owner, producer_avformat self, char *na
     }
 }
 
+/** Get an initialised scaler context from a slot of the cache.
+ *
+ * The context in the slot is reused when it was created with the same
+ * parameters, otherwise it is replaced. The caller must hold video_mutex, and
+ * a slot must not be used by more than one thread at a time.
+ */
+static struct SwsContext *sws_cache_get(producer_avformat self,
+                                        int slot,
+                                        const struct sws_cache_s *key,
+                                        int *transfer_error)
+{
+    struct sws_cache_s *entry = &self->sws_cache[slot];
+
+    size_t key_size = offsetof(struct sws_cache_s, transfer_error)
+                      - offsetof(struct sws_cache_s, width);
+
+    if (!entry->context || memcmp(&entry->width, &key->width, key_size)) {
+        struct SwsContext *context = sws_alloc_context();
+        int ret;
+
+        sws_freeContext(entry->context);
+        *entry = *key;
+        entry->context = NULL;
+        if (!context)
+            return NULL;
+        av_opt_set_int(context, "srcw", key->width, 0);
+        av_opt_set_int(context, "srch", key->height, 0);
+        av_opt_set_int(context, "src_format", key->src_format, 0);
+        av_opt_set_int(context, "dstw", key->width, 0);
+        av_opt_set_int(context, "dsth", key->height, 0);
+        av_opt_set_int(context, "dst_format", key->dst_format, 0);
+        av_opt_set_int(context, "sws_flags", key->flags, 0);
+        av_opt_set_int(context, "src_h_chr_pos", -513, 0);
+        av_opt_set_int(context, "src_v_chr_pos", key->src_v_chr_pos, 0);
+        av_opt_set_int(context, "dst_h_chr_pos", -513, 0);
+        av_opt_set_int(context, "dst_v_chr_pos", key->dst_v_chr_pos, 0);
+        if ((ret = sws_init_context(context, NULL, NULL)) < 0) {
+            mlt_log_error(MLT_PRODUCER_SERVICE(self->parent),
+                          "%s:%d: sws_init_context failed, ret=%d\n",
+                          __FUNCTION__,
+                          __LINE__,
+                          ret);
+            sws_freeContext(context);
+            return NULL;
+        }
+        entry->transfer_error = mlt_set_luma_transfer(context,
+                                                      key->src_colorspace,
+                                                      key->dst_colorspace,
+                                                      key->src_full_range,
+                                                      key->dst_full_range);
+        entry->context = context;
+    }
+    if (transfer_error)
+        *transfer_error = entry->transfer_error;
+    return entry->context;
+}
+
+static int sws_cache_reserve(producer_avformat self, int count)
+{
+    if (count > self->sws_cache_count) {
+        struct sws_cache_s *cache = realloc(self->sws_cache, count * sizeof(*cache));
+        if (!cache)
+            return 1;
+        memset(cache + self->sws_cache_count,
+               0,
+               (count - self->sws_cache_count) * sizeof(*cache));
+        self->sws_cache = cache;
+        self->sws_cache_count = count;
+    }
+    return 0;
+}
+
+static void sws_cache_close(producer_avformat self)
+{
+    for (int i = 0; i < self->sws_cache_count; i++)
+        sws_freeContext(self->sws_cache[i].context);
+    free(self->sws_cache);
+    self->sws_cache = NULL;
+    self->sws_cache_count = 0;
+}
+
 struct sliced_pix_fmt_conv_t
 {
     int width, height, slice_w;
@@ -2118,6 +2692,7 @@ struct sliced_pix_fmt_conv_t
     const AVPixFmtDescriptor *src_desc, *dst_desc;
     int flags, src_full_range, dst_full_range;
     mlt_colorspace src_colorspace, dst_colorspace;
+    producer_avformat self;
 };
 
 static int sliced_h_pix_fmt_conv_proc(int id, int idx, int jobs, void *cookie)
@@ -2125,8 +2700,8 @@ static int sliced_h_pix_fmt_conv_proc(int id, int idx, int jobs, void *cookie)
     uint8_t *out[4];
     const uint8_t *in[4];
     int in_stride[4], out_stride[4];
-    int src_v_chr_pos = -513, dst_v_chr_pos = -513, ret, i, slice_x, slice_w, h, mul, field, slices,
-        interlaced = 0;
+    int src_v_chr_pos = -513, dst_v_chr_pos = -513, i, slice_x, slice_w, h, mul, field, slices,
+        interlaced = 0, job = idx;
 
     struct SwsContext *sws;
     struct sliced_pix_fmt_conv_t *ctx = (struct sliced_pix_fmt_conv_t *) cookie;
@@ -2175,32 +2750,22 @@ static int sliced_h_pix_fmt_conv_proc(int id, int idx, int jobs, void *cookie)
     if (slice_w <= 0)
         return 0;
 
-    sws = sws_alloc_context();
-
-    av_opt_set_int(sws, "srcw", slice_w, 0);
-    av_opt_set_int(sws, "srch", h, 0);
-    av_opt_set_int(sws, "src_format", ctx->src_format, 0);
-    av_opt_set_int(sws, "dstw", slice_w, 0);
-    av_opt_set_int(sws, "dsth", h, 0);
-    av_opt_set_int(sws, "dst_format", ctx->dst_format, 0);
-    av_opt_set_int(sws, "sws_flags", ctx->flags, 0);
-
-    av_opt_set_int(sws, "src_h_chr_pos", -513, 0);
-    av_opt_set_int(sws, "src_v_chr_pos", src_v_chr_pos, 0);
-    av_opt_set_int(sws, "dst_h_chr_pos", -513, 0);
-    av_opt_set_int(sws, "dst_v_chr_pos", dst_v_chr_pos, 0);
-
-    if ((ret = sws_init_context(sws, NULL, NULL)) < 0) {
-        mlt_log_error(NULL, "%s:%d: sws_init_context failed, ret=%d\n", __FUNCTION__, __LINE__, ret);
-        sws_freeContext(sws);
+    struct sws_cache_s key = {
+        .width = slice_w,
+        .height = h,
+        .src_format = ctx->src_format,
+        .dst_format = ctx->dst_format,
+        .flags = ctx->flags,
+        .src_v_chr_pos = src_v_chr_pos,
+        .dst_v_chr_pos = dst_v_chr_pos,
+        .src_colorspace = ctx->src_colorspace,
+        .dst_colorspace = ctx->dst_colorspace,
+        .src_full_range = ctx->src_full_range,
+        .dst_full_range = ctx->dst_full_range,
+    };
+    sws = sws_cache_get(ctx->self, SWS_CACHE_SLICES + job, &key, NULL);
+    if (!sws)
         return 0;
-    }
-
-    mlt_set_luma_transfer(sws,
-                          ctx->src_colorspace,
-                          ctx->dst_colorspace,
-                          ctx->src_full_range,
-                          ctx->dst_full_range);
 
 #define PIX_DESC_BPP(DESC) (DESC.step)
 
@@ -2227,8 +2792,6 @@ static int sliced_h_pix_fmt_conv_proc(int id, int idx, int jobs, void *cookie)
 
     sws_scale(sws, in, in_stride, 0, h, out, out_stride);
 
-    sws_freeContext(sws);
-
     return 0;
 }
 
@@ -2291,34 +2854,35 @@ static mlt_colorspace convert_image_yuvp(producer_avformat self,
         intermediate_frame->format = intermediate_pix_fmt;
         av_frame_get_buffer(intermediate_frame, 1);
 
-        int flags
-            = mlt_get_sws_flags(width, height, src_pix_fmt, width, height, intermediate_pix_fmt);
-        struct SwsContext *context1 = sws_getContext(width,
-                                                     height,
-                                                     src_pix_fmt,
-                                                     width,
-                                                     height,
-                                                     intermediate_pix_fmt,
-                                                     flags,
-                                                     NULL,
-                                                     NULL,
-                                                     NULL);
-
         // Keep the intermediate in the source range
-        mlt_set_luma_transfer(context1,
-                              self->yuv_colorspace,
-                              self->yuv_colorspace,
-                              self->full_range,
-                              self->full_range);
+        struct sws_cache_s key = {
+            .width = width,
+            .height = height,
+            .src_format = src_pix_fmt,
+            .dst_format = intermediate_pix_fmt,
+            .flags = mlt_get_sws_flags(width,
+                                       height,
+                                       src_pix_fmt,
+                                       width,
+                                       height,
+                                       intermediate_pix_fmt),
+            .src_v_chr_pos = -513,
+            .dst_v_chr_pos = -513,
+            .src_colorspace = self->yuv_colorspace,
+            .dst_colorspace = self->yuv_colorspace,
+            .src_full_range = self->full_range,
+            .dst_full_range = self->full_range,
+        };
+        struct SwsContext *context1 = sws_cache_get(self, SWS_CACHE_INTERMEDIATE, &key, NULL);
 
-        sws_scale(context1,
-                  (const uint8_t *const *) frame->data,
-                  frame->linesize,
-                  0,
-                  height,
-                  intermediate_frame->data,
-                  intermediate_frame->linesize);
-        sws_freeContext(context1);
+        if (context1)
+            sws_scale(context1,
+                      (const uint8_t *const *) frame->data,
+                      frame->linesize,
+                      0,
+                      height,
+                      intermediate_frame->data,
+                      intermediate_frame->linesize);
 
         // Now use the intermediate frame
         frame = intermediate_frame;
@@ -2326,9 +2890,6 @@ static mlt_colorspace convert_image_yuvp(producer_avformat self,
     }
 
     // Main conversion
-    int flags = mlt_get_sws_flags(width, height, src_pix_fmt, width, height, dst_pix_fmt);
-    struct SwsContext *context = sws_getContext(
-        width, height, src_pix_fmt, width, height, dst_pix_fmt, flags, NULL, NULL, NULL);
     uint8_t *out_data[4];
     int out_stride[4];
 
@@ -2341,20 +2902,33 @@ static mlt_colorspace convert_image_yuvp(producer_avformat self,
                                   ? 1
                                   : self->full_range;
 
-    if (!mlt_set_luma_transfer(context,
-                               self->yuv_colorspace,
-                               dst_colorspace,
-                               effective_src_range,
-                               dst_full_range))
-        result = dst_colorspace;
-    sws_scale(context,
-              (const uint8_t *const *) frame->data,
-              frame->linesize,
-              0,
-              height,
-              out_data,
-              out_stride);
-    sws_freeContext(context);
+    struct sws_cache_s key = {
+        .width = width,
+        .height = height,
+        .src_format = src_pix_fmt,
+        .dst_format = dst_pix_fmt,
+        .flags = mlt_get_sws_flags(width, height, src_pix_fmt, width, height, dst_pix_fmt),
+        .src_v_chr_pos = -513,
+        .dst_v_chr_pos = -513,
+        .src_colorspace = self->yuv_colorspace,
+        .dst_colorspace = dst_colorspace,
+        .src_full_range = effective_src_range,
+        .dst_full_range = dst_full_range,
+    };
+    int transfer_error = 1;
+    struct SwsContext *context = sws_cache_get(self, SWS_CACHE_MAIN, &key, &transfer_error);
+
+    if (context) {
+        if (!transfer_error)
+            result = dst_colorspace;
+        sws_scale(context,
+                  (const uint8_t *const *) frame->data,
+                  frame->linesize,
+                  0,
+                  height,
+                  out_data,
+                  out_stride);
+    }
 
     av_frame_free(&intermediate_frame);
 
@@ -2372,36 +2946,38 @@ static void convert_image_rgb(producer_avformat self,
                               int dst_pix_fmt,
                               int dst_full_range)
 {
-    int flags = mlt_get_sws_flags(width, height, src_pix_fmt, width, height, dst_pix_fmt);
     uint8_t *out_data[4];
     int out_stride[4];
-
+    int interlaced;
 #if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
-    if (src_pix_fmt == AV_PIX_FMT_YUV420P && (frame->flags & AV_FRAME_FLAG_INTERLACED)) {
+    interlaced = src_pix_fmt == AV_PIX_FMT_YUV420P && (frame->flags & AV_FRAME_FLAG_INTERLACED);
 #else
-    if (src_pix_fmt == AV_PIX_FMT_YUV420P && frame->interlaced_frame) {
+    interlaced = src_pix_fmt == AV_PIX_FMT_YUV420P && frame->interlaced_frame;
 #endif
-        // Perform field-aware conversion for 4:2:0
-        int field_height = height / 2;
+    // Perform field-aware conversion for 4:2:0
+    int field_height = interlaced ? height / 2 : height;
+    // libswscale wants the RGB colorspace to be SWS_CS_DEFAULT, which is = SWS_CS_ITU601.
+    struct sws_cache_s key = {
+        .width = width,
+        .height = field_height,
+        .src_format = src_pix_fmt,
+        .dst_format = dst_pix_fmt,
+        .flags = mlt_get_sws_flags(width, height, src_pix_fmt, width, height, dst_pix_fmt),
+        .src_v_chr_pos = -513,
+        .dst_v_chr_pos = -513,
+        .src_colorspace = self->yuv_colorspace,
+        .dst_colorspace = mlt_colorspace_bt601,
+        .src_full_range = self->full_range,
+        .dst_full_range = 1,
+    };
+    struct SwsContext *context = sws_cache_get(self, SWS_CACHE_MAIN, &key, NULL);
+
+    if (!context)
+        return;
+    av_image_fill_arrays(out_data, out_stride, buffer, dst_pix_fmt, width, height, IMAGE_ALIGN);
+    if (interlaced) {
         const uint8_t *in_data[4];
         int in_stride[4];
-        struct SwsContext *context = sws_getContext(width,
-                                                    field_height,
-                                                    src_pix_fmt,
-                                                    width,
-                                                    field_height,
-                                                    dst_pix_fmt,
-                                                    flags,
-                                                    NULL,
-                                                    NULL,
-                                                    NULL);
-        // libswscale wants the RGB colorspace to be SWS_CS_DEFAULT, which is = SWS_CS_ITU601.
-        mlt_set_luma_transfer(context,
-                              self->yuv_colorspace,
-                              mlt_colorspace_bt601,
-                              self->full_range,
-                              1);
-        av_image_fill_arrays(out_data, out_stride, buffer, dst_pix_fmt, width, height, IMAGE_ALIGN);
         // Copy the input frame arrays
         for (int i = 0; i < 4; i++) {
             in_data[i] = frame->data[i];
@@ -2421,17 +2997,7 @@ static void convert_image_rgb(producer_avformat self,
         }
         // Convert the second field
         sws_scale(context, in_data, in_stride, 0, field_height, out_data, out_stride);
-        sws_freeContext(context);
     } else {
-        struct SwsContext *context = sws_getContext(
-            width, height, src_pix_fmt, width, height, dst_pix_fmt, flags, NULL, NULL, NULL);
-        av_image_fill_arrays(out_data, out_stride, buffer, dst_pix_fmt, width, height, IMAGE_ALIGN);
-        // libswscale wants the RGB colorspace to be SWS_CS_DEFAULT, which is = SWS_CS_ITU601.
-        mlt_set_luma_transfer(context,
-                              self->yuv_colorspace,
-                              mlt_colorspace_bt601,
-                              self->full_range,
-                              1);
         sws_scale(context,
                   (const uint8_t *const *) frame->data,
                   frame->linesize,
@@ -2439,7 +3005,6 @@ static void convert_image_rgb(producer_avformat self,
                   height,
                   out_data,
                   out_stride);
-        sws_freeContext(context);
     }
 }
 
@@ -2557,6 +3122,7 @@ static void convert_image(producer_avformat self,
             .dst_colorspace = dst_colorspace,
             .src_full_range = self->full_range,
             .dst_full_range = dst_full_range,
+            .self = self,
         };
         ctx.src_format = (self->full_range && src_pix_fmt == AV_PIX_FMT_YUV422P)
                              ? AV_PIX_FMT_YUVJ422P
@@ -2596,7 +3162,8 @@ static void convert_image(producer_avformat self,
 #else
             c *= frame->interlaced_frame ? 2 : 1;
 #endif
-            mlt_slices_run_normal(c, sliced_h_pix_fmt_conv_proc, &ctx);
+            if (!sws_cache_reserve(self, SWS_CACHE_SLICES + c))
+                mlt_slices_run_normal(c, sliced_h_pix_fmt_conv_proc, &ctx);
         } else {
 #if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
             c = (frame->flags & AV_FRAME_FLAG_INTERLACED) ? 2 : 1;
@@ -2604,8 +3171,9 @@ static void convert_image(producer_avformat self,
             c = frame->interlaced_frame ? 2 : 1;
 #endif
             ctx.slice_w = width;
-            for (i = 0; i < c; i++)
-                sliced_h_pix_fmt_conv_proc(i, i, c, &ctx);
+            if (!sws_cache_reserve(self, SWS_CACHE_SLICES + c))
+                for (i = 0; i < c; i++)
+                    sliced_h_pix_fmt_conv_proc(i, i, c, &ctx);
         }
 
         colorspace = dst_colorspace;
@@ -2677,6 +3245,43 @@ static int is_album_art(producer_avformat self)
                & AV_DISPOSITION_ATTACHED_PIC);
 }
 
+#if defined(POSIX_FADV_WILLNEED)
+/** Ask the kernel to start reading the bytes that packets_worker reads next.
+ *
+ * This only applies to local files, but these include network file systems
+ * where a synchronous read would otherwise stall the decoder.
+ */
+
+static void packets_prefetch(producer_avformat self, int *fd, AVFormatContext **file, int64_t *end)
+{
+    AVFormatContext *context = self->video_format;
+
+    if (*file != context) {
+        // Open the file behind the format context
+        if (*fd >= 0)
+            close(*fd);
+        *fd = -1;
+        *file = context;
+        *end = 0;
+        const char *url = context->url;
+        const char *protocol = url ? avio_find_protocol_name(url) : NULL;
+        if (protocol && !strcmp(protocol, "file")) {
+            av_strstart(url, "file:", &url);
+            *fd = open(url, O_RDONLY);
+        }
+    }
+    if (*fd >= 0 && context->pb) {
+        int64_t offset = avio_tell(context->pb);
+        // Hint again when half of the previous range was read or after a seek
+        if (offset + self->readahead_bytes / 2 > *end
+            || offset + self->readahead_bytes < *end) {
+            posix_fadvise(*fd, offset, self->readahead_bytes, POSIX_FADV_WILLNEED);
+            *end = offset + self->readahead_bytes;
+        }
+    }
+}
+#endif
+
 static void *packets_worker(void *param)
 {
     producer_avformat self = param;
@@ -2685,6 +3290,11 @@ static void *packets_worker(void *param)
         mlt_log_fatal(MLT_PRODUCER_SERVICE(self->parent), "av_packet_alloc failed\n");
         exit(EXIT_FAILURE);
     }
+#if defined(POSIX_FADV_WILLNEED)
+    int prefetch_fd = -1;
+    AVFormatContext *prefetch_file = NULL;
+    int64_t prefetch_end = 0;
+#endif
 
     pthread_mutex_lock(&self->packets_mutex);
     for (;;) {
@@ -2692,23 +3302,41 @@ static void *packets_worker(void *param)
         if (self->packets_thread_stop) {
             av_packet_free(&pkt);
             pthread_mutex_unlock(&self->packets_mutex);
+#if defined(POSIX_FADV_WILLNEED)
+            if (prefetch_fd >= 0)
+                close(prefetch_fd);
+#endif
             return NULL;
         }
 
-        if (mlt_deque_count(self->vpackets) >= 1 || self->packets_thread_ret < 0) {
+        if (!self->video_format || !self->vpackets || vpackets_full(self)
+            || self->packets_thread_ret < 0) {
             pthread_cond_wait(&self->packets_cond, &self->packets_mutex);
             goto check_stop;
         }
 
-        int ret = av_read_frame(self->video_format, pkt);
+#if defined(POSIX_FADV_WILLNEED)
+        if (self->readahead_bytes > 0)
+            packets_prefetch(self, &prefetch_fd, &prefetch_file, &prefetch_end);
+#endif
+
+        // Let the decoder take queued packets while reading
+        AVFormatContext *context = self->video_format;
+        self->packets_reading = 1;
+        pthread_mutex_unlock(&self->packets_mutex);
+        int ret = av_read_frame(context, pkt);
+        pthread_mutex_lock(&self->packets_mutex);
+        self->packets_reading = 0;
 
-        // don't bother signalling on EAGAIN
+        // don't bother reporting EAGAIN
         if (ret != AVERROR(EAGAIN)) {
             self->packets_thread_ret = ret;
 
             if (ret == 0) {
                 if (pkt->stream_index == self->video_index) {
-                    mlt_deque_push_back(self->vpackets, av_packet_clone(pkt));
+                    if (self->keyframes.loaded)
+                        keyframes_observe(self, pkt);
+                    vpackets_push(self, av_packet_clone(pkt));
                 } else if (!self->video_seekable && pkt->stream_index == self->audio_index
                            && !is_album_art(self)) {
                     mlt_deque_push_back(self->apackets, av_packet_clone(pkt));
@@ -2719,9 +3347,9 @@ static void *packets_worker(void *param)
                                 "av_read_frame returned error %d inside packets_worker\n",
                                 ret);
             }
-
-            pthread_cond_signal(&self->packets_cond);
         }
+        // Also wake anyone waiting in wait_packets_reader()
+        pthread_cond_broadcast(&self->packets_cond);
     }
 }
 
@@ -2746,11 +3374,109 @@ static void init_cache(mlt_properties properties, mlt_cache *cache)
     // set cache size if supplied
     if (*cache && cache_supplied)
         mlt_cache_set_size(*cache, cache_size);
+    // let busy producers take memory from idle ones within the shared budget
+    if (*cache)
+        mlt_cache_share(*cache);
 }
 
 /** Get an image from a frame.
 */
 
+/** Correct the scan type and field order of a decoded picture, filter it and convert it.
+ *
+ * \return 1 if the image was set on the frame, 0 if it could not be allocated, or -1 if
+ * the picture could not be filtered
+ */
+static int process_video_frame(producer_avformat self,
+                               mlt_frame frame,
+                               AVFrame *video_frame,
+                               AVCodecParameters *codec_params,
+                               uint8_t **buffer,
+                               mlt_image_format *format,
+                               int *width,
+                               int *height,
+                               uint8_t **alpha,
+                               int dst_colorspace,
+                               int dst_full_range,
+                               int *image_size)
+{
+    mlt_properties properties = MLT_PRODUCER_PROPERTIES(self->parent);
+
+    // Detect and correct scan type
+    if (mlt_properties_get(properties, "force_progressive")) {
+        self->progressive = !!mlt_properties_get_int(properties, "force_progressive");
+    } else if (video_frame && codec_params) {
+#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
+        self->progressive = !(video_frame->flags & AV_FRAME_FLAG_INTERLACED)
+#else
+        self->progressive = !video_frame->interlaced_frame
+#endif
+                            && (codec_params->field_order == AV_FIELD_PROGRESSIVE
+                                || codec_params->field_order == AV_FIELD_UNKNOWN);
+    } else {
+        self->progressive = 0;
+    }
+#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
+    if (!self->progressive)
+        video_frame->flags |= AV_FRAME_FLAG_INTERLACED;
+    else
+        video_frame->flags &= ~AV_FRAME_FLAG_INTERLACED;
+#else
+    video_frame->interlaced_frame = !self->progressive;
+#endif
+    // Detect and correct field order
+    if (mlt_properties_get(properties, "force_tff")) {
+        self->top_field_first = !!mlt_properties_get_int(properties, "force_tff");
+    } else {
+#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
+        self->top_field_first = (video_frame->flags & AV_FRAME_FLAG_TOP_FIELD_FIRST)
+#else
+        self->top_field_first = video_frame->top_field_first
+#endif
+                                || codec_params->field_order == AV_FIELD_TT
+                                || codec_params->field_order == AV_FIELD_TB;
+    }
+#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
+    if (self->top_field_first)
+        video_frame->flags |= AV_FRAME_FLAG_TOP_FIELD_FIRST;
+    else
+        video_frame->flags &= ~AV_FRAME_FLAG_TOP_FIELD_FIRST;
+#else
+    video_frame->top_field_first = self->top_field_first;
+#endif
+    const char *lut = mlt_properties_get(properties, "lut");
+    if (self->autorotate || mlt_properties_exists(properties, "filtergraph") || (lut && *lut)) {
+        if (!setup_filters(self) && self->vfilter_graph && self->vfilter_in && self->vfilter_out) {
+            int ret = av_buffersrc_add_frame(self->vfilter_in, video_frame);
+            if (ret < 0)
+                return -1;
+            while (ret >= 0) {
+                ret = av_buffersink_get_frame_flags(self->vfilter_out, video_frame, 0);
+                if (ret < 0) {
+                    ret = 0;
+                    break;
+                }
+            }
+        }
+    }
+
+    set_image_size(self, width, height);
+    if (!(*image_size = allocate_buffer(frame, codec_params, buffer, *format, *width, *height)))
+        return 0;
+    convert_image(self,
+                  MLT_FRAME_PROPERTIES(frame),
+                  video_frame,
+                  *buffer,
+                  video_frame->format,
+                  format,
+                  *width,
+                  *height,
+                  alpha,
+                  dst_colorspace,
+                  dst_full_range);
+    return 1;
+}
+
 static int producer_get_image(mlt_frame frame,
                               uint8_t **buffer,
                               mlt_image_format *format,
@@ -2797,6 +3523,7 @@ static int producer_get_image(mlt_frame frame,
         mlt_cache_close(self->image_cache);
         self->image_cache = NULL;
         av_frame_free(&self->video_frame);
+        reverse_clear(self);
     }
 
     // Fetch the video format context
@@ -2861,10 +3588,25 @@ static int producer_get_image(mlt_frame frame,
 
     double delay = mlt_properties_get_double(properties, "video_delay");
 
-    // Seek if necessary
+    // Keep the pictures that precede the requested one only while playing backwards, which
+    // includes a link or filter requesting descending positions at a positive speed
     double speed = mlt_producer_get_speed(producer);
+    int64_t reverse_bytes = mlt_properties_get(properties, "reverse_cache_bytes")
+                                ? mlt_properties_get_int64(properties, "reverse_cache_bytes")
+                                : REVERSE_CACHE_BYTES;
+    if (req_position < self->reverse_request)
+        self->reverse_run++;
+    else if (req_position > self->reverse_request)
+        self->reverse_run = 0;
+    self->reverse_request = req_position;
+    int reverse = must_decode && reverse_bytes > 0 && (speed < 0.0 || self->reverse_run >= 2);
+    AVFrame *reverse_frame = reverse ? reverse_get(self, req_position) : NULL;
+    if (!reverse)
+        reverse_clear(self);
+
+    // Seek if necessary
     int preseek = must_decode && self->video_codec->has_b_frames && speed >= 0.0 && speed <= 1.0;
-    int paused = seek_video(self, position, req_position, preseek);
+    int paused = reverse_frame ? 0 : seek_video(self, position, req_position, preseek);
 
     // Seek might have reopened the file
     context = self->video_format;
@@ -2876,11 +3618,26 @@ static int producer_get_image(mlt_frame frame,
                                                   : codec_params->format,
                                 *format);
 
-    // Duplicate the last image if necessary
-    if (self->video_frame && self->video_frame->linesize[0]
+    if (reverse_frame) {
+        // Use a picture decoded along with an earlier request
+        got_picture = process_video_frame(self,
+                                          frame,
+                                          reverse_frame,
+                                          codec_params,
+                                          buffer,
+                                          format,
+                                          width,
+                                          height,
+                                          &alpha,
+                                          dst_colorspace,
+                                          dst_full_range,
+                                          &image_size)
+                      > 0;
+        av_frame_free(&reverse_frame);
+    } else if (self->video_frame && self->video_frame->linesize[0]
         && (self->pkt.stream_index == self->video_index)
         && (paused || self->current_position >= req_position)) {
-        // Duplicate it
+        // Duplicate the last image
         set_image_size(self, width, height);
         if ((image_size = allocate_buffer(frame, codec_params, buffer, *format, *width, *height))) {
             convert_image(self,
@@ -2906,6 +3663,19 @@ static int producer_get_image(mlt_frame frame,
         else
             av_frame_unref(self->video_frame);
 
+        // Bound the packets that packets_worker reads ahead of the decoder
+        int64_t readahead_bytes = mlt_properties_get_int64(properties, "readahead_bytes");
+        double readahead_duration = mlt_properties_get_double(properties, "readahead_duration");
+        if (readahead_bytes != self->readahead_bytes
+            || readahead_duration != self->readahead_duration) {
+            pthread_mutex_lock(&self->packets_mutex);
+            self->readahead_bytes = readahead_bytes;
+            self->readahead_duration = readahead_duration;
+            if (self->is_thread_init)
+                pthread_cond_broadcast(&self->packets_cond);
+            pthread_mutex_unlock(&self->packets_mutex);
+        }
+
         if (!self->is_thread_init) {
             pthread_cond_init(&self->packets_cond, NULL);
             pthread_create(&self->packets_thread, NULL, packets_worker, self);
@@ -2923,11 +3693,12 @@ static int producer_get_image(mlt_frame frame,
                     pthread_cond_wait(&self->packets_cond, &self->packets_mutex);
                 }
 
-                if (self->packets_thread_ret == 0) {
-                    AVPacket *tmp = (AVPacket *) mlt_deque_pop_front(self->vpackets);
+                // Drain the queued packets before reporting an error or the end
+                if (mlt_deque_count(self->vpackets) > 0) {
+                    AVPacket *tmp = vpackets_pop(self);
                     av_packet_ref(&self->pkt, tmp);
                     av_packet_free(&tmp);
-                    pthread_cond_signal(&self->packets_cond);
+                    pthread_cond_broadcast(&self->packets_cond);
                 } else {
                     if (self->packets_thread_ret == AVERROR_EOF) {
                         self->pkt.stream_index = self->video_index;
@@ -2935,7 +3706,7 @@ static int producer_get_image(mlt_frame frame,
 
                     // notify packets_worker that we've seen the error
                     self->packets_thread_ret = 0;
-                    pthread_cond_signal(&self->packets_cond);
+                    pthread_cond_broadcast(&self->packets_cond);
 
                     if (!self->video_seekable && mlt_properties_get_int(properties, "reconnect")) {
                         // Try to reconnect to live sources by closing context and codecs,
@@ -3117,6 +3888,8 @@ static int producer_get_image(mlt_frame frame,
                                                   + 0.5);
                     }
 
+                    if (reverse)
+                        reverse_put(self, self->video_frame, int_position, reverse_bytes);
                     if (int_position < req_position)
                         got_picture = 0;
                     else if (int_position >= req_position)
@@ -3135,89 +3908,25 @@ static int producer_get_image(mlt_frame frame,
 
             // Now handle the picture if we have one
             if (got_picture) {
-                // Detect and correct scan type
-                if (mlt_properties_get(properties, "force_progressive")) {
-                    self->progressive = !!mlt_properties_get_int(properties, "force_progressive");
-                } else if (self->video_frame && codec_params) {
-#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
-                    self->progressive = !(self->video_frame->flags & AV_FRAME_FLAG_INTERLACED)
-#else
-                    self->progressive = !self->video_frame->interlaced_frame
-#endif
-                                        && (codec_params->field_order == AV_FIELD_PROGRESSIVE
-                                            || codec_params->field_order == AV_FIELD_UNKNOWN);
-                } else {
-                    self->progressive = 0;
-                }
-#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
-                if (!self->progressive)
-                    self->video_frame->flags |= AV_FRAME_FLAG_INTERLACED;
-                else
-                    self->video_frame->flags &= ~AV_FRAME_FLAG_INTERLACED;
-#else
-                self->video_frame->interlaced_frame = !self->progressive;
-#endif
-                // Detect and correct field order
-                if (mlt_properties_get(properties, "force_tff")) {
-                    self->top_field_first = !!mlt_properties_get_int(properties, "force_tff");
-                } else {
-#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
-                    self->top_field_first = (self->video_frame->flags
-                                             & AV_FRAME_FLAG_TOP_FIELD_FIRST)
-#else
-                    self->top_field_first = self->video_frame->top_field_first
-#endif
-                                            || codec_params->field_order == AV_FIELD_TT
-                                            || codec_params->field_order == AV_FIELD_TB;
-                }
-#if LIBAVUTIL_VERSION_INT >= ((58 << 16) + (7 << 8) + 100)
-                if (self->top_field_first)
-                    self->video_frame->flags |= AV_FRAME_FLAG_TOP_FIELD_FIRST;
-                else
-                    self->video_frame->flags &= ~AV_FRAME_FLAG_TOP_FIELD_FIRST;
-#else
-                self->video_frame->top_field_first = self->top_field_first;
-#endif
-                const char *lut = mlt_properties_get(properties, "lut");
-                if (self->autorotate || mlt_properties_exists(properties, "filtergraph")
-                    || (lut && *lut)) {
-                    if (!setup_filters(self) && self->vfilter_graph && self->vfilter_in
-                        && self->vfilter_out) {
-                        int ret = av_buffersrc_add_frame(self->vfilter_in, self->video_frame);
-                        if (ret < 0) {
-                            got_picture = 0;
-                            break;
-                        }
-                        while (ret >= 0) {
-                            ret = av_buffersink_get_frame_flags(self->vfilter_out,
-                                                                self->video_frame,
-                                                                0);
-                            if (ret < 0) {
-                                ret = 0;
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                set_image_size(self, width, height);
-                if ((image_size
-                     = allocate_buffer(frame, codec_params, buffer, *format, *width, *height))) {
-                    convert_image(self,
-                                  frame_properties,
-                                  self->video_frame,
-                                  *buffer,
-                                  self->video_frame->format,
-                                  format,
-                                  *width,
-                                  *height,
-                                  &alpha,
-                                  dst_colorspace,
-                                  dst_full_range);
-                    self->current_position = int_position;
-                } else {
+                int ret = process_video_frame(self,
+                                              frame,
+                                              self->video_frame,
+                                              codec_params,
+                                              buffer,
+                                              format,
+                                              width,
+                                              height,
+                                              &alpha,
+                                              dst_colorspace,
+                                              dst_full_range,
+                                              &image_size);
+                if (ret < 0) {
                     got_picture = 0;
+                    break;
                 }
+                got_picture = ret;
+                if (got_picture)
+                    self->current_position = int_position;
             }
 
             // Free packet data if not video and not live audio packet
@@ -3277,6 +3986,8 @@ static int producer_get_image(mlt_frame frame,
     self->video_expected = position + 1;
 
 exit_get_image:
+    if (!mlt_properties_get_int(frame_properties, "avformat.decode_ahead"))
+        decode_ahead_update(self, frame, *format, *width, *height);
     pthread_mutex_unlock(&self->video_mutex);
 
     mlt_properties_set_int(frame_properties, "progressive", self->progressive);
@@ -3293,6 +4004,137 @@ exit_get_image:
     return !got_picture;
 }
 
+/** Decode the positions that follow the last request into the image cache.
+ *
+ * This fetches private frames through producer_get_image() so that the pictures are
+ * decoded and converted exactly as the next requests will want them.
+ */
+
+static void *decode_ahead_worker(void *param)
+{
+    producer_avformat self = param;
+    mlt_service service = MLT_PRODUCER_SERVICE(self->parent);
+
+    pthread_mutex_lock(&self->ahead.mutex);
+    while (!self->ahead.stop) {
+        if (self->ahead.position < 0
+            || self->ahead.next > self->ahead.position + self->ahead.frames) {
+            pthread_cond_wait(&self->ahead.cond, &self->ahead.mutex);
+            continue;
+        }
+        mlt_position position = self->ahead.next;
+        mlt_image_format format = self->ahead.format;
+        int width = self->ahead.width;
+        int height = self->ahead.height;
+        mlt_frame frame = mlt_frame_init(service);
+        if (frame) {
+            mlt_properties frame_properties = MLT_FRAME_PROPERTIES(frame);
+            mlt_properties_pass_list(frame_properties,
+                                     self->ahead.properties,
+                                     "consumer.color_range consumer.scale");
+            mlt_properties_set_int(frame_properties, "avformat.decode_ahead", 1);
+            mlt_properties_set_position(frame_properties, "original_position", position);
+            mlt_frame_set_position(frame, position);
+        }
+        pthread_mutex_unlock(&self->ahead.mutex);
+
+        if (frame) {
+            uint8_t *image = NULL;
+            mlt_frame_push_service(frame, self);
+            producer_get_image(frame, &image, &format, &width, &height, 0);
+            mlt_frame_close(frame);
+        }
+
+        pthread_mutex_lock(&self->ahead.mutex);
+        // A seek while decoding moved the next position elsewhere
+        if (self->ahead.next == position)
+            self->ahead.next = position + 1;
+    }
+    pthread_mutex_unlock(&self->ahead.mutex);
+    return NULL;
+}
+
+/** Tell the decode-ahead thread about a request, starting it if necessary.
+ *
+ * The caller holds video_mutex.
+ */
+
+static void decode_ahead_update(producer_avformat self,
+                                mlt_frame frame,
+                                mlt_image_format format,
+                                int width,
+                                int height)
+{
+    mlt_properties properties = MLT_PRODUCER_PROPERTIES(self->parent);
+    int frames = mlt_properties_get_int(properties, "decode_ahead");
+    int playing = mlt_producer_get_speed(self->parent) == 1.0 && !is_album_art(self);
+
+    if (frames > MAX_DECODE_AHEAD) {
+        if (frames != self->ahead.clamped)
+            mlt_log_warning(MLT_PRODUCER_SERVICE(self->parent),
+                            "decode_ahead %d is more than the maximum %d\n",
+                            frames,
+                            MAX_DECODE_AHEAD);
+        self->ahead.clamped = frames;
+        frames = MAX_DECODE_AHEAD;
+    }
+    if (frames <= 0 || !playing || !self->image_cache || format == mlt_image_none) {
+        if (self->ahead.is_init) {
+            pthread_mutex_lock(&self->ahead.mutex);
+            self->ahead.position = -1;
+            pthread_mutex_unlock(&self->ahead.mutex);
+        }
+        return;
+    }
+    if (!self->ahead.is_init) {
+        pthread_mutex_init(&self->ahead.mutex, NULL);
+        pthread_cond_init(&self->ahead.cond, NULL);
+        self->ahead.properties = mlt_properties_new();
+        self->ahead.position = -1;
+        if (pthread_create(&self->ahead.thread, NULL, decode_ahead_worker, self)) {
+            mlt_properties_close(self->ahead.properties);
+            pthread_cond_destroy(&self->ahead.cond);
+            pthread_mutex_destroy(&self->ahead.mutex);
+            return;
+        }
+        self->ahead.is_init = 1;
+    }
+    // Keep the pictures until they are requested
+    if (self->image_cache && mlt_cache_get_size(self->image_cache) < frames + 1)
+        mlt_cache_set_size(self->image_cache, frames + 1);
+
+    mlt_position position = mlt_frame_original_position(frame);
+    pthread_mutex_lock(&self->ahead.mutex);
+    // Start again after the request on a seek
+    if (self->ahead.next <= position || self->ahead.next > position + frames + 1)
+        self->ahead.next = position + 1;
+    self->ahead.position = position;
+    self->ahead.frames = frames;
+    self->ahead.format = format;
+    self->ahead.width = width;
+    self->ahead.height = height;
+    mlt_properties_pass_list(self->ahead.properties,
+                             MLT_FRAME_PROPERTIES(frame),
+                             "consumer.color_range consumer.scale");
+    pthread_cond_signal(&self->ahead.cond);
+    pthread_mutex_unlock(&self->ahead.mutex);
+}
+
+static void decode_ahead_close(producer_avformat self)
+{
+    if (self->ahead.is_init) {
+        pthread_mutex_lock(&self->ahead.mutex);
+        self->ahead.stop = 1;
+        pthread_cond_signal(&self->ahead.cond);
+        pthread_mutex_unlock(&self->ahead.mutex);
+        pthread_join(self->ahead.thread, NULL);
+        pthread_cond_destroy(&self->ahead.cond);
+        pthread_mutex_destroy(&self->ahead.mutex);
+        mlt_properties_close(self->ahead.properties);
+        self->ahead.is_init = 0;
+    }
+}
+
 /** Process properties as AVOptions and apply to AV context obj
 */
 
@@ -3531,7 +4373,7 @@ static int pick_video_stream(producer_avformat self)
     if (mlt_properties_get_int(properties, "video_index") != absolute_index) {
         // Update the absolute index
         mlt_properties_set_int(properties, "video_index", absolute_index);
-        self->video_index = absolute_index;
+        keyframes_set_video_index(self, absolute_index);
     }
     return absolute_index;
 }
@@ -3595,7 +4437,7 @@ static void producer_set_up_video(producer_avformat self, mlt_frame frame)
     // Update the video properties if the index changed
     if (context && index > -1 && index != self->video_index) {
         // Reset the video properties if the index changed
-        self->video_index = index;
+        keyframes_set_video_index(self, index);
         mlt_properties_set_int(properties, "_probe_complete", 0);
         pthread_mutex_lock(&self->open_mutex);
         avcodec_free_context(&self->video_codec);
@@ -3678,6 +4520,7 @@ static int seek_audio(producer_avformat self, mlt_position position, double time
     int paused = 0;
 
     pthread_mutex_lock(&self->packets_mutex);
+    wait_packets_reader(self);
 
     // Seek if necessary
     if (self->seekable && (position != self->audio_expected || self->last_position < 0)) {
@@ -4050,9 +4893,10 @@ static int producer_get_audio(mlt_frame frame,
                 av_packet_ref(&pkt, tmp);
                 av_packet_free(&tmp);
             } else {
+                wait_packets_reader(self);
                 ret = av_read_frame(context, &pkt);
                 if (ret >= 0 && !self->seekable && pkt.stream_index == self->video_index) {
-                    mlt_deque_push_back(self->vpackets, av_packet_clone(&pkt));
+                    vpackets_push(self, av_packet_clone(&pkt));
                 } else if (ret == AVERROR(EAGAIN)) {
                     ret = 0;
                     pthread_mutex_unlock(&self->packets_mutex);
@@ -4577,6 +5421,8 @@ static void producer_avformat_close(producer_avformat self)
         mlt_events_disconnect(MLT_PRODUCER_PROPERTIES(self->parent), self);
     pthread_mutex_unlock(&self->close_mutex);
 
+    decode_ahead_close(self);
+
     // Cleanup av contexts
     av_packet_unref(&self->pkt);
     av_frame_free(&self->video_frame);
@@ -4596,11 +5442,14 @@ static void producer_avformat_close(producer_avformat self)
     if (self->is_thread_init) {
         pthread_mutex_lock(&self->packets_mutex);
         self->packets_thread_stop = 1;
-        pthread_cond_signal(&self->packets_cond);
+        pthread_cond_broadcast(&self->packets_cond);
         pthread_mutex_unlock(&self->packets_mutex);
         pthread_join(self->packets_thread, NULL);
         pthread_cond_destroy(&self->packets_cond);
     }
+    keyframes_close(self);
+    sws_cache_close(self);
+    reverse_clear(self);
     if (self->dummy_context)
         avformat_close_input(&self->dummy_context);
     if (self->seekable && self->audio_format)
@@ -22,6 +22,7 @@
 #include <framework/mlt_image.h>
 #include <framework/mlt_log.h>
 #include <framework/mlt_pool.h>
+#include <framework/mlt_slices.h>
 
 #include <stdlib.h>
 
@@ -55,73 +56,59 @@
 #define YUV2RGB_601 YUV2RGB_601_UNSCALED
 #endif
 
-static void convert_yuv422_to_rgba(mlt_image src, mlt_image dst)
-{
-    int yy, uu, vv;
-    int r, g, b;
-
-    mlt_image_set_values(dst, NULL, mlt_image_rgba, src->width, src->height);
-    mlt_image_alloc_data(dst);
-
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
-        uint8_t *pAlpha = src->planes[3] + src->strides[3] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        int total = src->width / 2 + 1;
-
-        if (pAlpha)
-            while (--total) {
-                yy = pSrc[0];
-                uu = pSrc[1];
-                vv = pSrc[3];
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[0] = r;
-                pDst[1] = g;
-                pDst[2] = b;
-                pDst[3] = *pAlpha++;
-                yy = pSrc[2];
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[4] = r;
-                pDst[5] = g;
-                pDst[6] = b;
-                pDst[7] = *pAlpha++;
-                pSrc += 4;
-                pDst += 8;
-            }
-        else
-            while (--total) {
-                yy = pSrc[0];
-                uu = pSrc[1];
-                vv = pSrc[3];
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[0] = r;
-                pDst[1] = g;
-                pDst[2] = b;
-                pDst[3] = 0xff;
-                yy = pSrc[2];
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[4] = r;
-                pDst[5] = g;
-                pDst[6] = b;
-                pDst[7] = 0xff;
-                pSrc += 4;
-                pDst += 8;
-            }
-    }
-}
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+// These convert as many leading multiples of 8 pixels of a line as they can.
+int convert_yuv422_to_rgba_line_sse2(const uint8_t *src,
+                                     const uint8_t *alpha,
+                                     uint8_t *dst,
+                                     int width);
+int convert_yuv420p_to_rgba_line_sse2(const uint8_t *src_y,
+                                      const uint8_t *src_u,
+                                      const uint8_t *src_v,
+                                      const uint8_t *alpha,
+                                      uint8_t *dst,
+                                      int width);
+int convert_rgba_to_yuv422_line_sse2(const uint8_t *src, uint8_t *dst, uint8_t *alpha, int width);
+#endif
 
-static void convert_yuv422_to_rgb(mlt_image src, mlt_image dst)
+static void convert_yuv422_to_rgba(mlt_image src, mlt_image dst, int line)
 {
     int yy, uu, vv;
     int r, g, b;
 
-    mlt_image_set_values(dst, NULL, mlt_image_rgb, src->width, src->height);
-    mlt_image_alloc_data(dst);
-
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        int total = src->width / 2 + 1;
+    uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
+    uint8_t *pAlpha = src->planes[3] + src->strides[3] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    int total = src->width / 2 + 1;
+
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+    int done = convert_yuv422_to_rgba_line_sse2(pSrc, pAlpha, pDst, src->width);
+    pSrc += done * 2;
+    pDst += done * 4;
+    if (pAlpha)
+        pAlpha += done;
+    total -= done / 2;
+#endif
+    if (pAlpha)
+        while (--total) {
+            yy = pSrc[0];
+            uu = pSrc[1];
+            vv = pSrc[3];
+            YUV2RGB_601(yy, uu, vv, r, g, b);
+            pDst[0] = r;
+            pDst[1] = g;
+            pDst[2] = b;
+            pDst[3] = *pAlpha++;
+            yy = pSrc[2];
+            YUV2RGB_601(yy, uu, vv, r, g, b);
+            pDst[4] = r;
+            pDst[5] = g;
+            pDst[6] = b;
+            pDst[7] = *pAlpha++;
+            pSrc += 4;
+            pDst += 8;
+        }
+    else
         while (--total) {
             yy = pSrc[0];
             uu = pSrc[1];
@@ -130,130 +117,183 @@ static void convert_yuv422_to_rgb(mlt_image src, mlt_image dst)
             pDst[0] = r;
             pDst[1] = g;
             pDst[2] = b;
+            pDst[3] = 0xff;
             yy = pSrc[2];
             YUV2RGB_601(yy, uu, vv, r, g, b);
-            pDst[3] = r;
-            pDst[4] = g;
-            pDst[5] = b;
+            pDst[4] = r;
+            pDst[5] = g;
+            pDst[6] = b;
+            pDst[7] = 0xff;
             pSrc += 4;
-            pDst += 6;
+            pDst += 8;
         }
+}
+
+static void convert_yuv422_to_rgb(mlt_image src, mlt_image dst, int line)
+{
+    int yy, uu, vv;
+    int r, g, b;
+
+    uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    int total = src->width / 2 + 1;
+    while (--total) {
+        yy = pSrc[0];
+        uu = pSrc[1];
+        vv = pSrc[3];
+        YUV2RGB_601(yy, uu, vv, r, g, b);
+        pDst[0] = r;
+        pDst[1] = g;
+        pDst[2] = b;
+        yy = pSrc[2];
+        YUV2RGB_601(yy, uu, vv, r, g, b);
+        pDst[3] = r;
+        pDst[4] = g;
+        pDst[5] = b;
+        pSrc += 4;
+        pDst += 6;
     }
 }
 
-static void convert_rgba_to_yuv422(mlt_image src, mlt_image dst)
+static void convert_rgba_to_yuv422(mlt_image src, mlt_image dst, int line)
 {
     int y0, y1, u0, u1, v0, v1;
     int r, g, b;
 
-    mlt_image_set_values(dst, NULL, mlt_image_yuv422, src->width, src->height);
-    mlt_image_alloc_data(dst);
-    mlt_image_alloc_alpha(dst);
-
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        uint8_t *pAlpha = dst->planes[3] + dst->strides[3] * line;
-        int j = src->width / 2 + 1;
-        while (--j) {
-            r = *pSrc++;
-            g = *pSrc++;
-            b = *pSrc++;
-            *pAlpha++ = *pSrc++;
-            RGB2YUV_601(r, g, b, y0, u0, v0);
-            r = *pSrc++;
-            g = *pSrc++;
-            b = *pSrc++;
-            *pAlpha++ = *pSrc++;
-            RGB2YUV_601(r, g, b, y1, u1, v1);
-            *pDst++ = y0;
-            *pDst++ = (u0 + u1) >> 1;
-            *pDst++ = y1;
-            *pDst++ = (v0 + v1) >> 1;
-        }
-        if (src->width % 2) {
-            r = *pSrc++;
-            g = *pSrc++;
-            b = *pSrc++;
-            *pAlpha++ = *pSrc++;
-            RGB2YUV_601(r, g, b, y0, u0, v0);
-            *pDst++ = y0;
-            *pDst++ = u0;
-        }
+    uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    uint8_t *pAlpha = dst->planes[3] + dst->strides[3] * line;
+    int j = src->width / 2 + 1;
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+    int done = convert_rgba_to_yuv422_line_sse2(pSrc, pDst, pAlpha, src->width);
+    pSrc += done * 4;
+    pDst += done * 2;
+    pAlpha += done;
+    j -= done / 2;
+#endif
+    while (--j) {
+        r = *pSrc++;
+        g = *pSrc++;
+        b = *pSrc++;
+        *pAlpha++ = *pSrc++;
+        RGB2YUV_601(r, g, b, y0, u0, v0);
+        r = *pSrc++;
+        g = *pSrc++;
+        b = *pSrc++;
+        *pAlpha++ = *pSrc++;
+        RGB2YUV_601(r, g, b, y1, u1, v1);
+        *pDst++ = y0;
+        *pDst++ = (u0 + u1) >> 1;
+        *pDst++ = y1;
+        *pDst++ = (v0 + v1) >> 1;
+    }
+    if (src->width % 2) {
+        r = *pSrc++;
+        g = *pSrc++;
+        b = *pSrc++;
+        *pAlpha++ = *pSrc++;
+        RGB2YUV_601(r, g, b, y0, u0, v0);
+        *pDst++ = y0;
+        *pDst++ = u0;
     }
 }
 
-static void convert_rgb_to_yuv422(mlt_image src, mlt_image dst)
+static void convert_rgb_to_yuv422(mlt_image src, mlt_image dst, int line)
 {
     int y0, y1, u0, u1, v0, v1;
     int r, g, b;
 
-    mlt_image_set_values(dst, NULL, mlt_image_yuv422, src->width, src->height);
-    mlt_image_alloc_data(dst);
-
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        int j = src->width / 2 + 1;
-        while (--j) {
-            r = *pSrc++;
-            g = *pSrc++;
-            b = *pSrc++;
-            RGB2YUV_601(r, g, b, y0, u0, v0);
-            r = *pSrc++;
-            g = *pSrc++;
-            b = *pSrc++;
-            RGB2YUV_601(r, g, b, y1, u1, v1);
-            *pDst++ = y0;
-            *pDst++ = (u0 + u1) >> 1;
-            *pDst++ = y1;
-            *pDst++ = (v0 + v1) >> 1;
-        }
-        if (src->width % 2) {
-            r = *pSrc++;
-            g = *pSrc++;
-            b = *pSrc++;
-            RGB2YUV_601(r, g, b, y0, u0, v0);
-            *pDst++ = y0;
-            *pDst++ = u0;
-        }
+    uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    int j = src->width / 2 + 1;
+    while (--j) {
+        r = *pSrc++;
+        g = *pSrc++;
+        b = *pSrc++;
+        RGB2YUV_601(r, g, b, y0, u0, v0);
+        r = *pSrc++;
+        g = *pSrc++;
+        b = *pSrc++;
+        RGB2YUV_601(r, g, b, y1, u1, v1);
+        *pDst++ = y0;
+        *pDst++ = (u0 + u1) >> 1;
+        *pDst++ = y1;
+        *pDst++ = (v0 + v1) >> 1;
+    }
+    if (src->width % 2) {
+        r = *pSrc++;
+        g = *pSrc++;
+        b = *pSrc++;
+        RGB2YUV_601(r, g, b, y0, u0, v0);
+        *pDst++ = y0;
+        *pDst++ = u0;
     }
 }
 
-static void convert_yuv420p_to_yuv422(mlt_image src, mlt_image dst)
+static void convert_yuv420p_to_yuv422(mlt_image src, mlt_image dst, int line)
 {
-    mlt_image_set_values(dst, NULL, mlt_image_yuv422, src->width, src->height);
-    mlt_image_alloc_data(dst);
-
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrcY = src->planes[0] + src->strides[0] * line;
-        uint8_t *pSrcU = src->planes[1] + src->strides[1] * line / 2;
-        uint8_t *pSrcV = src->planes[2] + src->strides[2] * line / 2;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        int j = src->width / 2 + 1;
-        while (--j) {
-            *pDst++ = *pSrcY++;
-            *pDst++ = *pSrcU++;
-            *pDst++ = *pSrcY++;
-            *pDst++ = *pSrcV++;
-        }
+    uint8_t *pSrcY = src->planes[0] + src->strides[0] * line;
+    uint8_t *pSrcU = src->planes[1] + src->strides[1] * (line / 2);
+    uint8_t *pSrcV = src->planes[2] + src->strides[2] * (line / 2);
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    int j = src->width / 2 + 1;
+    while (--j) {
+        *pDst++ = *pSrcY++;
+        *pDst++ = *pSrcU++;
+        *pDst++ = *pSrcY++;
+        *pDst++ = *pSrcV++;
     }
 }
 
-static void convert_yuv420p_to_rgb(mlt_image src, mlt_image dst)
+static void convert_yuv420p_to_rgb(mlt_image src, mlt_image dst, int line)
 {
     int yy, uu, vv;
     int r, g, b;
 
-    mlt_image_set_values(dst, NULL, mlt_image_rgb, src->width, src->height);
-    mlt_image_alloc_data(dst);
+    uint8_t *pSrcY = src->planes[0] + src->strides[0] * line;
+    uint8_t *pSrcU = src->planes[1] + src->strides[1] * (line / 2);
+    uint8_t *pSrcV = src->planes[2] + src->strides[2] * (line / 2);
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    int total = src->width / 2 + 1;
+    while (--total) {
+        yy = *pSrcY++;
+        uu = *pSrcU++;
+        vv = *pSrcV++;
+        YUV2RGB_601(yy, uu, vv, r, g, b);
+        pDst[0] = r;
+        pDst[1] = g;
+        pDst[2] = b;
+        yy = *pSrcY++;
+        YUV2RGB_601(yy, uu, vv, r, g, b);
+        pDst[3] = r;
+        pDst[4] = g;
+        pDst[5] = b;
+        pDst += 6;
+    }
+}
 
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrcY = src->planes[0] + src->strides[0] * line;
-        uint8_t *pSrcU = src->planes[1] + src->strides[1] * line / 2;
-        uint8_t *pSrcV = src->planes[2] + src->strides[2] * line / 2;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        int total = src->width / 2 + 1;
+static void convert_yuv420p_to_rgba(mlt_image src, mlt_image dst, int line)
+{
+    int yy, uu, vv;
+    int r, g, b;
+
+    uint8_t *pSrcY = src->planes[0] + src->strides[0] * line;
+    uint8_t *pSrcU = src->planes[1] + src->strides[1] * (line / 2);
+    uint8_t *pSrcV = src->planes[2] + src->strides[2] * (line / 2);
+    uint8_t *pSrcA = src->planes[3] + src->strides[3] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    int total = src->width / 2 + 1;
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+    int done = convert_yuv420p_to_rgba_line_sse2(pSrcY, pSrcU, pSrcV, pSrcA, pDst, src->width);
+    pSrcY += done;
+    pSrcU += done / 2;
+    pSrcV += done / 2;
+    pDst += done * 4;
+    if (pSrcA)
+        pSrcA += done;
+    total -= done / 2;
+#endif
+    if (pSrcA)
         while (--total) {
             yy = *pSrcY++;
             uu = *pSrcU++;
@@ -262,180 +302,401 @@ static void convert_yuv420p_to_rgb(mlt_image src, mlt_image dst)
             pDst[0] = r;
             pDst[1] = g;
             pDst[2] = b;
+            pDst[3] = *pSrcA++;
             yy = *pSrcY++;
             YUV2RGB_601(yy, uu, vv, r, g, b);
-            pDst[3] = r;
-            pDst[4] = g;
-            pDst[5] = b;
-            pDst += 6;
+            pDst[4] = r;
+            pDst[5] = g;
+            pDst[6] = b;
+            pDst[7] = *pSrcA++;
+            pDst += 8;
+        }
+    else
+        while (--total) {
+            yy = *pSrcY++;
+            uu = *pSrcU++;
+            vv = *pSrcV++;
+            YUV2RGB_601(yy, uu, vv, r, g, b);
+            pDst[0] = r;
+            pDst[1] = g;
+            pDst[2] = b;
+            pDst[3] = 0xff;
+            yy = *pSrcY++;
+            YUV2RGB_601(yy, uu, vv, r, g, b);
+            pDst[4] = r;
+            pDst[5] = g;
+            pDst[6] = b;
+            pDst[7] = 0xff;
+            pDst += 8;
         }
-    }
 }
 
-static void convert_yuv420p_to_rgba(mlt_image src, mlt_image dst)
+static void convert_yuv422_to_yuv420p(mlt_image src, mlt_image dst, int line)
 {
-    int yy, uu, vv;
-    int r, g, b;
+    uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
 
-    mlt_image_set_values(dst, NULL, mlt_image_rgba, src->width, src->height);
-    mlt_image_alloc_data(dst);
-
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrcY = src->planes[0] + src->strides[0] * line;
-        uint8_t *pSrcU = src->planes[1] + src->strides[1] * line / 2;
-        uint8_t *pSrcV = src->planes[2] + src->strides[2] * line / 2;
-        uint8_t *pSrcA = src->planes[3] + src->strides[3] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        int total = src->width / 2 + 1;
-        if (pSrcA)
-            while (--total) {
-                yy = *pSrcY++;
-                uu = *pSrcU++;
-                vv = *pSrcV++;
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[0] = r;
-                pDst[1] = g;
-                pDst[2] = b;
-                pDst[3] = *pSrcA++;
-                yy = *pSrcY++;
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[4] = r;
-                pDst[5] = g;
-                pDst[6] = b;
-                pDst[7] = *pSrcA++;
-                pDst += 8;
-            }
-        else
-            while (--total) {
-                yy = *pSrcY++;
-                uu = *pSrcU++;
-                vv = *pSrcV++;
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[0] = r;
-                pDst[1] = g;
-                pDst[2] = b;
-                pDst[3] = 0xff;
-                yy = *pSrcY++;
-                YUV2RGB_601(yy, uu, vv, r, g, b);
-                pDst[4] = r;
-                pDst[5] = g;
-                pDst[6] = b;
-                pDst[7] = 0xff;
-                pDst += 8;
-            }
+    // Y
+    for (int pixel = 0; pixel < src->width; pixel++) {
+        *pDst++ = *pSrc;
+        pSrc += 2;
     }
-}
-
-static void convert_yuv422_to_yuv420p(mlt_image src, mlt_image dst)
-{
-    int lines = src->height;
-    int pixels = src->width;
-
-    mlt_image_set_values(dst, NULL, mlt_image_yuv420p, src->width, src->height);
-    mlt_image_alloc_data(dst);
 
-    // Y
-    for (int line = 0; line < lines; line++) {
+    // U and V from the even lines
+    if (line % 2 == 0 && line / 2 < src->height / 2) {
         uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        for (int pixel = 0; pixel < pixels; pixel++) {
-            *pDst++ = *pSrc;
-            pSrc += 2;
+        uint8_t *pDstU = dst->planes[1] + dst->strides[1] * (line / 2);
+        uint8_t *pDstV = dst->planes[2] + dst->strides[2] * (line / 2);
+        for (int pixel = 0; pixel < src->width / 2; pixel++) {
+            *pDstU++ = pSrc[1];
+            *pDstV++ = pSrc[3];
+            pSrc += 4;
         }
     }
+}
 
-    lines = src->height / 2;
-    pixels = src->width / 2;
+static void convert_rgb_to_rgba(mlt_image src, mlt_image dst, int line)
+{
 
-    // U
-    for (int line = 0; line < lines; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line * 2 + 1;
-        uint8_t *pDst = dst->planes[1] + dst->strides[1] * line;
-        for (int pixel = 0; pixel < pixels; pixel++) {
-            *pDst++ = *pSrc;
-            pSrc += 4;
+    uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
+    uint8_t *pAlpha = src->planes[3] + src->strides[3] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    int total = src->width + 1;
+    if (pAlpha)
+        while (--total) {
+            *pDst++ = pSrc[0];
+            *pDst++ = pSrc[1];
+            *pDst++ = pSrc[2];
+            *pDst++ = *pAlpha++;
+            pSrc += 3;
+        }
+    else
+        while (--total) {
+            *pDst++ = pSrc[0];
+            *pDst++ = pSrc[1];
+            *pDst++ = pSrc[2];
+            *pDst++ = 0xff;
+            pSrc += 3;
         }
+}
+
+static void convert_rgba_to_rgb(mlt_image src, mlt_image dst, int line)
+{
+
+    uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
+    uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
+    uint8_t *pAlpha = dst->planes[3] + dst->strides[3] * line;
+    int total = src->width + 1;
+    while (--total) {
+        *pDst++ = pSrc[0];
+        *pDst++ = pSrc[1];
+        *pDst++ = pSrc[2];
+        *pAlpha++ = pSrc[3];
+        pSrc += 4;
     }
+}
 
-    // V
-    for (int line = 0; line < lines; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line * 2 + 3;
-        uint8_t *pDst = dst->planes[2] + dst->strides[2] * line;
-        for (int pixel = 0; pixel < pixels; pixel++) {
-            *pDst++ = *pSrc;
-            pSrc += 4;
+/* The formats with more than 8 bits per component are converted through lines of 16-bit
+ * samples, four per pixel: Y U V A or R G B A. Y'CbCr scales 8-bit values by 256 and
+ * RGB and alpha by 257, so that 0-255 maps to the full 0-65535.
+ */
+
+#define SAMPLES_CHUNK (256)
+
+static int is_rgb(mlt_image_format format)
+{
+    return format == mlt_image_rgb || format == mlt_image_rgba || format == mlt_image_rgba64;
+}
+
+static int has_alpha_channel(mlt_image_format format)
+{
+    return format == mlt_image_rgba || format == mlt_image_rgba64;
+}
+
+static inline uint16_t clamp16(int64_t value)
+{
+    return value < 0 ? 0 : value > 65535 ? 65535 : value;
+}
+
+static inline uint8_t yuv16_to_8(int value)
+{
+    value = (value + 128) >> 8;
+    return value > 255 ? 255 : value;
+}
+
+static inline uint16_t yuv16_to_10(int value)
+{
+    value = (value + 32) >> 6;
+    return value > 1023 ? 1023 : value;
+}
+
+/** Read samples from a line of an image starting at pixel x. */
+
+static void read_samples(mlt_image src, int line, int x, int count, uint16_t *samples)
+{
+    const uint8_t *alpha = src->planes[3] ? src->planes[3] + src->strides[3] * line + x : NULL;
+    int chroma_width = src->width / 2 > 0 ? src->width / 2 : 1;
+
+    for (int i = 0; i < count; i++) {
+        int p = x + i;
+        int c = MIN(p / 2, chroma_width - 1);
+        uint16_t *s = samples + i * 4;
+        const uint8_t *p8;
+        const uint16_t *p16;
+
+        s[3] = alpha ? alpha[i] * 257 : 65535;
+        switch (src->format) {
+        case mlt_image_rgb:
+            p8 = src->planes[0] + src->strides[0] * line + p * 3;
+            s[0] = p8[0] * 257;
+            s[1] = p8[1] * 257;
+            s[2] = p8[2] * 257;
+            break;
+        case mlt_image_rgba:
+            p8 = src->planes[0] + src->strides[0] * line + p * 4;
+            s[0] = p8[0] * 257;
+            s[1] = p8[1] * 257;
+            s[2] = p8[2] * 257;
+            s[3] = p8[3] * 257;
+            break;
+        case mlt_image_rgba64:
+            p16 = (const uint16_t *) (src->planes[0] + src->strides[0] * line) + p * 4;
+            s[0] = p16[0];
+            s[1] = p16[1];
+            s[2] = p16[2];
+            s[3] = p16[3];
+            break;
+        case mlt_image_yuv422:
+            p8 = src->planes[0] + src->strides[0] * line;
+            s[0] = p8[p * 2] << 8;
+            s[1] = p8[c * 4 + 1] << 8;
+            s[2] = p8[c * 4 + 3] << 8;
+            break;
+        case mlt_image_yuv420p:
+            s[0] = src->planes[0][src->strides[0] * line + p] << 8;
+            s[1] = src->planes[1][src->strides[1] * (line / 2) + c] << 8;
+            s[2] = src->planes[2][src->strides[2] * (line / 2) + c] << 8;
+            break;
+        case mlt_image_yuv422p16:
+            s[0] = ((const uint16_t *) (src->planes[0] + src->strides[0] * line))[p];
+            s[1] = ((const uint16_t *) (src->planes[1] + src->strides[1] * line))[c];
+            s[2] = ((const uint16_t *) (src->planes[2] + src->strides[2] * line))[c];
+            break;
+        case mlt_image_yuv420p10:
+            s[0] = ((const uint16_t *) (src->planes[0] + src->strides[0] * line))[p] << 6;
+            s[1] = ((const uint16_t *) (src->planes[1] + src->strides[1] * (line / 2)))[c] << 6;
+            s[2] = ((const uint16_t *) (src->planes[2] + src->strides[2] * (line / 2)))[c] << 6;
+            break;
+        case mlt_image_yuv444p10:
+            s[0] = ((const uint16_t *) (src->planes[0] + src->strides[0] * line))[p] << 6;
+            s[1] = ((const uint16_t *) (src->planes[1] + src->strides[1] * line))[p] << 6;
+            s[2] = ((const uint16_t *) (src->planes[2] + src->strides[2] * line))[p] << 6;
+            break;
+        default:
+            break;
         }
     }
 }
 
-static void convert_rgb_to_rgba(mlt_image src, mlt_image dst)
-{
-    mlt_image_set_values(dst, NULL, mlt_image_rgba, src->width, src->height);
-    mlt_image_alloc_data(dst);
+/** Write samples to a line of an image starting at pixel x, an even number.
+ *
+ * Subsampled chroma takes the average of each pair of pixels, and 4:2:0 takes it from
+ * the even lines.
+ */
 
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
-        uint8_t *pAlpha = src->planes[3] + src->strides[3] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        int total = src->width + 1;
-        if (pAlpha)
-            while (--total) {
-                *pDst++ = pSrc[0];
-                *pDst++ = pSrc[1];
-                *pDst++ = pSrc[2];
-                *pDst++ = *pAlpha++;
-                pSrc += 3;
+static void write_samples(mlt_image dst, int line, int x, int count, const uint16_t *samples)
+{
+    uint8_t *alpha = dst->planes[3] && !has_alpha_channel(dst->format)
+                         ? dst->planes[3] + dst->strides[3] * line + x
+                         : NULL;
+    int chroma_line = dst->format == mlt_image_yuv420p || dst->format == mlt_image_yuv420p10
+                          ? (line % 2 == 0 && line / 2 < dst->height / 2 ? line / 2 : -1)
+                          : line;
+
+    for (int i = 0; i < count; i++) {
+        int p = x + i;
+        const uint16_t *s = samples + i * 4;
+        // The chroma of this pixel and the next one if it is the first of a pair
+        int pair = p % 2 == 0 && i + 1 < count;
+        int u = pair ? (s[1] + s[5]) >> 1 : s[1];
+        int v = pair ? (s[2] + s[6]) >> 1 : s[2];
+        uint8_t *p8;
+        uint16_t *p16;
+
+        if (alpha)
+            alpha[i] = s[3] >> 8;
+        switch (dst->format) {
+        case mlt_image_rgb:
+            p8 = dst->planes[0] + dst->strides[0] * line + p * 3;
+            p8[0] = s[0] >> 8;
+            p8[1] = s[1] >> 8;
+            p8[2] = s[2] >> 8;
+            break;
+        case mlt_image_rgba:
+            p8 = dst->planes[0] + dst->strides[0] * line + p * 4;
+            p8[0] = s[0] >> 8;
+            p8[1] = s[1] >> 8;
+            p8[2] = s[2] >> 8;
+            p8[3] = s[3] >> 8;
+            break;
+        case mlt_image_rgba64:
+            p16 = (uint16_t *) (dst->planes[0] + dst->strides[0] * line) + p * 4;
+            p16[0] = s[0];
+            p16[1] = s[1];
+            p16[2] = s[2];
+            p16[3] = s[3];
+            break;
+        case mlt_image_yuv422:
+            p8 = dst->planes[0] + dst->strides[0] * line + p * 2;
+            p8[0] = yuv16_to_8(s[0]);
+            if (p % 2 == 0)
+                p8[1] = yuv16_to_8(u);
+            if (pair)
+                p8[3] = yuv16_to_8(v);
+            break;
+        case mlt_image_yuv420p:
+            dst->planes[0][dst->strides[0] * line + p] = yuv16_to_8(s[0]);
+            if (p % 2 == 0 && chroma_line >= 0 && p / 2 < dst->width / 2) {
+                dst->planes[1][dst->strides[1] * chroma_line + p / 2] = yuv16_to_8(u);
+                dst->planes[2][dst->strides[2] * chroma_line + p / 2] = yuv16_to_8(v);
             }
-        else
-            while (--total) {
-                *pDst++ = pSrc[0];
-                *pDst++ = pSrc[1];
-                *pDst++ = pSrc[2];
-                *pDst++ = 0xff;
-                pSrc += 3;
+            break;
+        case mlt_image_yuv422p16:
+            ((uint16_t *) (dst->planes[0] + dst->strides[0] * line))[p] = s[0];
+            if (p % 2 == 0 && p / 2 < dst->width / 2) {
+                ((uint16_t *) (dst->planes[1] + dst->strides[1] * line))[p / 2] = u;
+                ((uint16_t *) (dst->planes[2] + dst->strides[2] * line))[p / 2] = v;
             }
+            break;
+        case mlt_image_yuv420p10:
+            ((uint16_t *) (dst->planes[0] + dst->strides[0] * line))[p] = yuv16_to_10(s[0]);
+            if (p % 2 == 0 && chroma_line >= 0 && p / 2 < dst->width / 2) {
+                ((uint16_t *) (dst->planes[1] + dst->strides[1] * chroma_line))[p / 2]
+                    = yuv16_to_10(u);
+                ((uint16_t *) (dst->planes[2] + dst->strides[2] * chroma_line))[p / 2]
+                    = yuv16_to_10(v);
+            }
+            break;
+        case mlt_image_yuv444p10:
+            ((uint16_t *) (dst->planes[0] + dst->strides[0] * line))[p] = yuv16_to_10(s[0]);
+            ((uint16_t *) (dst->planes[1] + dst->strides[1] * line))[p] = yuv16_to_10(s[1]);
+            ((uint16_t *) (dst->planes[2] + dst->strides[2] * line))[p] = yuv16_to_10(s[2]);
+            break;
+        default:
+            break;
+        }
     }
 }
 
-static void convert_rgba_to_rgb(mlt_image src, mlt_image dst)
-{
-    mlt_image_set_values(dst, NULL, mlt_image_rgb, src->width, src->height);
-    mlt_image_alloc_data(dst);
-    mlt_image_alloc_alpha(dst);
+/** Convert samples between Y'CbCr and RGB with the coefficients of YUV2RGB_601_SCALED and
+ * RGB2YUV_601_SCALED.
+ */
 
-    for (int line = 0; line < src->height; line++) {
-        uint8_t *pSrc = src->planes[0] + src->strides[0] * line;
-        uint8_t *pDst = dst->planes[0] + dst->strides[0] * line;
-        uint8_t *pAlpha = dst->planes[3] + dst->strides[3] * line;
-        int total = src->width + 1;
-        while (--total) {
-            *pDst++ = pSrc[0];
-            *pDst++ = pSrc[1];
-            *pDst++ = pSrc[2];
-            *pAlpha++ = pSrc[3];
-            pSrc += 4;
+static void convert_samples(uint16_t *samples, int count, int to_rgb)
+{
+    for (int i = 0; i < count; i++) {
+        uint16_t *s = samples + i * 4;
+        if (to_rgb) {
+            int64_t y = 1192 * (s[0] - 4096);
+            int64_t u = s[1] - 32768;
+            int64_t v = s[2] - 32768;
+            s[0] = clamp16(((y + 1634 * v) * 257) >> 18);
+            s[1] = clamp16(((y - 832 * v - 401 * u) * 257) >> 18);
+            s[2] = clamp16(((y + 2066 * u) * 257) >> 18);
+        } else {
+            int64_t r = s[0], g = s[1], b = s[2];
+            s[0] = clamp16((((263 * r + 516 * g + 100 * b) * 256 / 257) >> 10) + 4096);
+            s[1] = clamp16((((-152 * r - 300 * g + 450 * b) * 256 / 257) >> 10) + 32768);
+            s[2] = clamp16((((450 * r - 377 * g - 73 * b) * 256 / 257) >> 10) + 32768);
         }
     }
 }
 
-typedef void (*conversion_function)(mlt_image src, mlt_image dst);
+static void convert_samples_line(mlt_image src, mlt_image dst, int line)
+{
+    uint16_t samples[SAMPLES_CHUNK * 4];
+    int convert = is_rgb(src->format) != is_rgb(dst->format);
+
+    for (int x = 0; x < src->width; x += SAMPLES_CHUNK) {
+        int count = MIN(SAMPLES_CHUNK, src->width - x);
+        read_samples(src, line, x, count, samples);
+        if (convert)
+            convert_samples(samples, count, is_rgb(dst->format));
+        write_samples(dst, line, x, count, samples);
+    }
+}
+
+typedef void (*conversion_function)(mlt_image src, mlt_image dst, int line);
+
+#define SAMPLES convert_samples_line
 
 static conversion_function conversion_matrix[mlt_image_invalid - 1][mlt_image_invalid - 1] = {
-    {NULL, convert_rgb_to_rgba, convert_rgb_to_yuv422, NULL, NULL, NULL, NULL},
-    {convert_rgba_to_rgb, NULL, convert_rgba_to_yuv422, NULL, NULL, NULL, NULL},
-    {convert_yuv422_to_rgb, convert_yuv422_to_rgba, NULL, convert_yuv422_to_yuv420p, NULL, NULL, NULL},
+    {NULL,
+     convert_rgb_to_rgba,
+     convert_rgb_to_yuv422,
+     NULL,
+     NULL,
+     NULL,
+     SAMPLES,
+     SAMPLES,
+     SAMPLES,
+     SAMPLES},
+    {convert_rgba_to_rgb,
+     NULL,
+     convert_rgba_to_yuv422,
+     NULL,
+     NULL,
+     NULL,
+     SAMPLES,
+     SAMPLES,
+     SAMPLES,
+     SAMPLES},
+    {convert_yuv422_to_rgb,
+     convert_yuv422_to_rgba,
+     NULL,
+     convert_yuv422_to_yuv420p,
+     NULL,
+     NULL,
+     SAMPLES,
+     SAMPLES,
+     SAMPLES,
+     SAMPLES},
     {convert_yuv420p_to_rgb,
      convert_yuv420p_to_rgba,
      convert_yuv420p_to_yuv422,
      NULL,
      NULL,
      NULL,
-     NULL},
-    {NULL, NULL, NULL, NULL, NULL, NULL, NULL},
-    {NULL, NULL, NULL, NULL, NULL, NULL, NULL},
-    {NULL, NULL, NULL, NULL, NULL, NULL, NULL},
+     SAMPLES,
+     SAMPLES,
+     SAMPLES,
+     SAMPLES},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL},
+    {SAMPLES, SAMPLES, SAMPLES, SAMPLES, NULL, NULL, NULL, SAMPLES, SAMPLES, SAMPLES},
+    {SAMPLES, SAMPLES, SAMPLES, SAMPLES, NULL, NULL, SAMPLES, NULL, SAMPLES, SAMPLES},
+    {SAMPLES, SAMPLES, SAMPLES, SAMPLES, NULL, NULL, SAMPLES, SAMPLES, NULL, SAMPLES},
+    {SAMPLES, SAMPLES, SAMPLES, SAMPLES, NULL, NULL, SAMPLES, SAMPLES, SAMPLES, NULL},
 };
 
+struct sliced_desc
+{
+    mlt_image src;
+    mlt_image dst;
+    conversion_function converter;
+};
+
+static int sliced_proc(int id, int index, int jobs, void *cookie)
+{
+    (void) id; // unused
+    struct sliced_desc *desc = cookie;
+    int start, height = mlt_slices_size_slice(jobs, index, desc->src->height, &start);
+
+    for (int line = start; line < start + height; line++)
+        desc->converter(desc->src, desc->dst, line);
+    return 0;
+}
+
 static int convert_image(mlt_frame frame,
                          uint8_t **buffer,
                          mlt_image_format *format,
@@ -461,18 +722,24 @@ static int convert_image(mlt_frame frame,
                       height);
         if (converter) {
             struct mlt_image_s src;
-            struct mlt_image_s dst;
+            struct mlt_image_s dst = {0};
             mlt_image_set_values(&src, *buffer, *format, width, height);
-            if (requested_format == mlt_image_rgba && mlt_frame_get_alpha(frame)) {
+            if (has_alpha_channel(requested_format) && mlt_frame_get_alpha(frame)) {
                 // imageconvert leaves the alpha buffer alone except in the case of rgba.
                 // For rgba input, an alpha buffer will be created and added to the frame.
                 // For rgba output, the alpha buffer will be copied to the rgba and the buffer is removed from the frame.
                 src.planes[3] = mlt_frame_get_alpha(frame);
                 src.strides[3] = src.width;
             }
-            converter(&src, &dst);
+            mlt_image_set_values(&dst, NULL, requested_format, width, height);
+            mlt_image_alloc_data(&dst);
+            if (has_alpha_channel(*format) && !has_alpha_channel(requested_format))
+                mlt_image_alloc_alpha(&dst);
+
+            struct sliced_desc desc = {&src, &dst, converter};
+            mlt_slices_run_normal(0, sliced_proc, &desc);
             mlt_frame_set_image(frame, dst.data, 0, dst.release_data);
-            if (requested_format == mlt_image_rgba) {
+            if (has_alpha_channel(requested_format)) {
                 // Clear the alpha buffer on the frame
                 mlt_frame_set_alpha(frame, NULL, 0, NULL);
             } else if (dst.alpha) {
@@ -17,16 +17,39 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <framework/mlt_factory.h>
 #include <framework/mlt_filter.h>
 #include <framework/mlt_frame.h>
 #include <framework/mlt_log.h>
 #include <framework/mlt_profile.h>
+#include <framework/mlt_slices.h>
 
 #include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+void scale_rgba_row_sse2(const uint8_t *src,
+                         uint16_t *dst,
+                         const int *start,
+                         const int16_t *weights,
+                         int taps,
+                         int width);
+void scale_rgba64_row_sse2(const uint16_t *src,
+                           uint16_t *dst,
+                           const int *start,
+                           const int16_t *weights,
+                           int taps,
+                           int width);
+// These scale as many leading multiples of 8 samples of a line as they can.
+int scale_column_line8_sse2(
+    const uint16_t *src, int stride, const int16_t *weights, int taps, uint8_t *dst, int width);
+int scale_column_line16_sse2(
+    const uint16_t *src, int stride, const int16_t *weights, int taps, uint16_t *dst, int width);
+#endif
+
 /** virtual function declaration for an image scaler
  *
  * image scaler implementations are expected to support the following in and out formats:
@@ -45,6 +68,403 @@ typedef int (*image_scaler)(mlt_frame frame,
                             int owidth,
                             int oheight);
 
+/** The interpolation kernels of the built-in scaler */
+
+enum scale_kind {
+    SCALE_NEAREST,
+    SCALE_BILINEAR,
+    SCALE_BICUBIC,
+    SCALE_LANCZOS,
+};
+
+/** The fixed point precision of the filter weights */
+#define WEIGHT_BITS (14)
+/** The number of tap tables kept across frames */
+#define TAPS_CACHE_SIZE (8)
+/** The number of samples accumulated at once by the vertical pass */
+#define COLUMN_CHUNK (512)
+
+/** Filter taps to scale one dimension from in_size to out_size samples */
+
+typedef struct
+{
+    int in_size;
+    int out_size;
+    enum scale_kind kind;
+    int taps;         /**< the number of taps per output sample */
+    int *start;       /**< the first input sample of each output sample */
+    int16_t *weights; /**< taps weights per output sample that sum to 1 << WEIGHT_BITS */
+    int refs;
+    int cached;
+    uint64_t used;
+} scale_taps;
+
+static struct
+{
+    pthread_mutex_t mutex;
+    scale_taps *entries[TAPS_CACHE_SIZE];
+    uint64_t clock;
+    int registered;
+} taps_cache = {PTHREAD_MUTEX_INITIALIZER};
+
+static enum scale_kind scale_kind(const char *interps)
+{
+    if (!interps)
+        return SCALE_BILINEAR;
+    if (!strcmp(interps, "nearest") || !strcmp(interps, "neighbor"))
+        return SCALE_NEAREST;
+    if (!strcmp(interps, "bicubic") || !strcmp(interps, "bicublin") || !strcmp(interps, "spline"))
+        return SCALE_BICUBIC;
+    if (!strcmp(interps, "hyper") || !strcmp(interps, "lanczos") || !strcmp(interps, "sinc"))
+        return SCALE_LANCZOS;
+    return SCALE_BILINEAR;
+}
+
+static double kernel_support(enum scale_kind kind)
+{
+    switch (kind) {
+    case SCALE_BICUBIC:
+        return 2.0;
+    case SCALE_LANCZOS:
+        return 3.0;
+    default:
+        return 1.0;
+    }
+}
+
+static double kernel(enum scale_kind kind, double x)
+{
+    x = fabs(x);
+    switch (kind) {
+    case SCALE_BICUBIC:
+        // Keys cubic with a = -0.5 (Catmull-Rom)
+        if (x < 1.0)
+            return (1.5 * x - 2.5) * x * x + 1.0;
+        if (x < 2.0)
+            return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+        return 0.0;
+    case SCALE_LANCZOS:
+        if (x < 1e-8)
+            return 1.0;
+        if (x < 3.0)
+            return 3.0 * sin(M_PI * x) * sin(M_PI * x / 3.0) / (M_PI * M_PI * x * x);
+        return 0.0;
+    default:
+        return x < 1.0 ? 1.0 - x : 0.0;
+    }
+}
+
+static void taps_close(scale_taps *self)
+{
+    free(self->start);
+    free(self->weights);
+    free(self);
+}
+
+/** Compute the taps for the centers of the output samples.
+ *
+ * The kernel is stretched when reducing so that every input sample contributes, and the
+ * weights that fall outside the input are folded onto the edge samples.
+ */
+
+static scale_taps *taps_create(int in_size, int out_size, enum scale_kind kind)
+{
+    scale_taps *self = calloc(1, sizeof(*self));
+    double scale = (double) in_size / out_size;
+    double stretch = scale > 1.0 ? scale : 1.0;
+    int radius = ceil(kernel_support(kind) * stretch);
+
+    self->in_size = in_size;
+    self->out_size = out_size;
+    self->kind = kind;
+    if (kind == SCALE_NEAREST || in_size == out_size)
+        self->taps = 1;
+    else
+        self->taps = MIN(2 * radius, in_size);
+    self->start = malloc(out_size * sizeof(*self->start));
+    self->weights = calloc(out_size * self->taps, sizeof(*self->weights));
+
+    double *weights = malloc(2 * radius * sizeof(*weights));
+    for (int i = 0; i < out_size; i++) {
+        double center = (i + 0.5) * scale - 0.5;
+        int16_t *w = self->weights + i * self->taps;
+
+        if (self->taps == 1) {
+            self->start[i] = CLAMP((int) floor(center + 0.5), 0, in_size - 1);
+            w[0] = 1 << WEIGHT_BITS;
+            continue;
+        }
+
+        int left = (int) floor(center) - radius + 1;
+        double sum = 0.0;
+        for (int k = 0; k < 2 * radius; k++) {
+            weights[k] = kernel(kind, (left + k - center) / stretch);
+            sum += weights[k];
+        }
+
+        int start = CLAMP(left, 0, in_size - self->taps);
+        int total = 0, largest = 0;
+        self->start[i] = start;
+        for (int k = 0; k < 2 * radius; k++) {
+            int j = CLAMP(left + k, 0, in_size - 1) - start;
+            j = CLAMP(j, 0, self->taps - 1);
+            w[j] += lrint(weights[k] / sum * (1 << WEIGHT_BITS));
+        }
+        for (int k = 0; k < self->taps; k++) {
+            total += w[k];
+            if (w[k] > w[largest])
+                largest = k;
+        }
+        // Keep the sum exact so that flat areas do not drift
+        w[largest] += (1 << WEIGHT_BITS) - total;
+    }
+    free(weights);
+    return self;
+}
+
+static void taps_cache_close(void *cache)
+{
+    (void) cache; // unused
+    pthread_mutex_lock(&taps_cache.mutex);
+    for (int i = 0; i < TAPS_CACHE_SIZE; i++) {
+        scale_taps *entry = taps_cache.entries[i];
+        // An entry still in use is closed when it is released
+        if (entry && entry->refs)
+            entry->cached = 0;
+        else if (entry)
+            taps_close(entry);
+        taps_cache.entries[i] = NULL;
+    }
+    taps_cache.registered = 0;
+    pthread_mutex_unlock(&taps_cache.mutex);
+}
+
+/** Get the taps for a geometry from the cache or compute and cache them. */
+
+static scale_taps *taps_get(int in_size, int out_size, enum scale_kind kind)
+{
+    scale_taps *result = NULL;
+    int victim = -1;
+
+    pthread_mutex_lock(&taps_cache.mutex);
+    for (int i = 0; i < TAPS_CACHE_SIZE && !result; i++) {
+        scale_taps *entry = taps_cache.entries[i];
+        if (!entry) {
+            victim = i;
+        } else if (entry->in_size == in_size && entry->out_size == out_size
+                   && entry->kind == kind) {
+            result = entry;
+        } else if (!entry->refs && (victim < 0 || (taps_cache.entries[victim]
+                                                   && taps_cache.entries[victim]->used
+                                                          > entry->used))) {
+            // Replace the least recently used entry that is not in use
+            victim = i;
+        }
+    }
+    if (!result) {
+        result = taps_create(in_size, out_size, kind);
+        if (victim >= 0) {
+            if (taps_cache.entries[victim])
+                taps_close(taps_cache.entries[victim]);
+            taps_cache.entries[victim] = result;
+            result->cached = 1;
+        }
+    }
+    result->refs++;
+    result->used = ++taps_cache.clock;
+    pthread_mutex_unlock(&taps_cache.mutex);
+    return result;
+}
+
+static void taps_release(scale_taps *self)
+{
+    pthread_mutex_lock(&taps_cache.mutex);
+    int unused = --self->refs == 0 && !self->cached;
+    pthread_mutex_unlock(&taps_cache.mutex);
+    if (unused)
+        taps_close(self);
+}
+
+/** Scale one row of a set of interleaved channels into the intermediate row */
+
+typedef void (*scale_row_function)(const void *src, uint16_t *dst, const scale_taps *taps);
+
+/** A set of interleaved channels within the rows of an image */
+
+typedef struct
+{
+    int offset;                  /**< the first sample in a row */
+    scale_row_function scale;    /**< the row function for the layout of the channels */
+    scale_taps *taps;            /**< the horizontal taps */
+} scale_component;
+
+typedef struct
+{
+    int depth; /**< 8 or 16 bits per sample */
+    const uint8_t *src;
+    int src_stride; /**< samples per input row */
+    int src_height;
+    uint8_t *dst;
+    int dst_stride; /**< samples per output row */
+    uint16_t *tmp;  /**< the horizontally scaled rows with dst_stride samples */
+    int count;
+    scale_component components[2];
+    scale_taps *taps; /**< the vertical taps */
+} scale_desc;
+
+/* The row functions are generated per layout so that the compiler can unroll the channels.
+ * 8-bit samples get 7 extra bits of precision in the 16-bit intermediate rows, and 16-bit
+ * samples are kept as they are.
+ */
+
+#define SCALE_ROW_LOOP(type, shift, max, step, channels, channel_step, taps) \
+    for (int x = 0; x < out_size; x++) { \
+        const int16_t *w = weights + x * (taps); \
+        const type *p = src + start[x] * (step); \
+        int acc[channels] = {0}; \
+        for (int k = 0; k < (taps); k++, p += (step)) \
+            for (int c = 0; c < (channels); c++) \
+                acc[c] += w[k] * p[c * (channel_step)]; \
+        for (int c = 0; c < (channels); c++) \
+            dst[x * (step) + c * (channel_step)] \
+                = CLAMP((acc[c] + (1 << ((shift) - 1))) >> (shift), 0, (max)); \
+    }
+
+#define DEFINE_SCALE_ROW(name, type, shift, max, step, channels, channel_step) \
+    static void name(const void *source, uint16_t *dst, const scale_taps *taps) \
+    { \
+        const type *src = source; \
+        const int out_size = taps->out_size; \
+        const int n = taps->taps; \
+        const int *start = taps->start; \
+        const int16_t *weights = taps->weights; \
+        if (n == 1) { \
+            for (int x = 0; x < out_size; x++) { \
+                const type *p = src + start[x] * (step); \
+                for (int c = 0; c < (channels); c++) \
+                    dst[x * (step) + c * (channel_step)] = p[c * (channel_step)] \
+                                                          << (WEIGHT_BITS - (shift)); \
+            } \
+        } else if (n == 2) { \
+            SCALE_ROW_LOOP(type, shift, max, step, channels, channel_step, 2) \
+        } else if (n == 4) { \
+            SCALE_ROW_LOOP(type, shift, max, step, channels, channel_step, 4) \
+        } else if (n == 6) { \
+            SCALE_ROW_LOOP(type, shift, max, step, channels, channel_step, 6) \
+        } else if (n == 8) { \
+            SCALE_ROW_LOOP(type, shift, max, step, channels, channel_step, 8) \
+        } else { \
+            SCALE_ROW_LOOP(type, shift, max, step, channels, channel_step, n) \
+        } \
+    }
+
+DEFINE_SCALE_ROW(scale_row_a8, uint8_t, WEIGHT_BITS - 7, 255 << 7, 1, 1, 1)
+DEFINE_SCALE_ROW(scale_row_y8, uint8_t, WEIGHT_BITS - 7, 255 << 7, 2, 1, 1)
+DEFINE_SCALE_ROW(scale_row_uv8, uint8_t, WEIGHT_BITS - 7, 255 << 7, 4, 2, 2)
+DEFINE_SCALE_ROW(scale_row_rgb8, uint8_t, WEIGHT_BITS - 7, 255 << 7, 3, 3, 1)
+
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+static void scale_row_rgba8_sse2(const void *src, uint16_t *dst, const scale_taps *taps)
+{
+    scale_rgba_row_sse2(src, dst, taps->start, taps->weights, taps->taps, taps->out_size);
+}
+
+static void scale_row_rgba16_sse2(const void *src, uint16_t *dst, const scale_taps *taps)
+{
+    scale_rgba64_row_sse2(src, dst, taps->start, taps->weights, taps->taps, taps->out_size);
+}
+#else
+DEFINE_SCALE_ROW(scale_row_rgba8, uint8_t, WEIGHT_BITS - 7, 255 << 7, 4, 4, 1)
+DEFINE_SCALE_ROW(scale_row_rgba16, uint16_t, WEIGHT_BITS, 65535, 4, 4, 1)
+#endif
+
+static int scale_rows(int id, int index, int jobs, void *cookie)
+{
+    (void) id; // unused
+    scale_desc *desc = cookie;
+    int start, height = mlt_slices_size_slice(jobs, index, desc->src_height, &start);
+    int sample_size = desc->depth / 8;
+
+    for (int line = start; line < start + height; line++) {
+        const uint8_t *src = desc->src + line * desc->src_stride * sample_size;
+        uint16_t *dst = desc->tmp + line * desc->dst_stride;
+        for (int i = 0; i < desc->count; i++) {
+            const scale_component *c = &desc->components[i];
+            c->scale(src + c->offset * sample_size, dst + c->offset, c->taps);
+        }
+    }
+    return 0;
+}
+
+/** The vertical pass works on whole rows, so it does not depend on the layout. */
+
+static int scale_columns(int id, int index, int jobs, void *cookie)
+{
+    (void) id; // unused
+    scale_desc *desc = cookie;
+    const scale_taps *taps = desc->taps;
+    int start, height = mlt_slices_size_slice(jobs, index, taps->out_size, &start);
+    int acc[COLUMN_CHUNK];
+
+    for (int line = start; line < start + height; line++) {
+        const int16_t *w = taps->weights + line * taps->taps;
+        const uint16_t *tmp = desc->tmp + taps->start[line] * desc->dst_stride;
+        int done = 0;
+
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+        if (desc->depth == 8)
+            done = scale_column_line8_sse2(tmp,
+                                           desc->dst_stride,
+                                           w,
+                                           taps->taps,
+                                           desc->dst + line * desc->dst_stride,
+                                           desc->dst_stride);
+        else
+            done = scale_column_line16_sse2(tmp,
+                                            desc->dst_stride,
+                                            w,
+                                            taps->taps,
+                                            (uint16_t *) desc->dst + line * desc->dst_stride,
+                                            desc->dst_stride);
+#endif
+        for (int x = done; x < desc->dst_stride; x += COLUMN_CHUNK) {
+            int count = MIN(COLUMN_CHUNK, desc->dst_stride - x);
+            memset(acc, 0, count * sizeof(*acc));
+            for (int k = 0; k < taps->taps; k++) {
+                const uint16_t *t = tmp + k * desc->dst_stride + x;
+                int weight = w[k];
+                for (int i = 0; i < count; i++)
+                    acc[i] += weight * t[i];
+            }
+            if (desc->depth == 8) {
+                uint8_t *dst = desc->dst + line * desc->dst_stride + x;
+                const int shift = WEIGHT_BITS + 7;
+                for (int i = 0; i < count; i++)
+                    dst[i] = CLAMP((acc[i] + (1 << (shift - 1))) >> shift, 0, 255);
+            } else {
+                uint16_t *dst = (uint16_t *) desc->dst + line * desc->dst_stride + x;
+                for (int i = 0; i < count; i++)
+                    dst[i] = CLAMP((acc[i] + (1 << (WEIGHT_BITS - 1))) >> WEIGHT_BITS, 0, 65535);
+            }
+        }
+    }
+    return 0;
+}
+
+/** Scale in two sliced passes: rows into an intermediate image, then columns. */
+
+static void scale_image(scale_desc *desc, int owidth, int oheight, enum scale_kind kind)
+{
+    desc->tmp = mlt_pool_alloc(desc->dst_stride * desc->src_height * sizeof(*desc->tmp));
+    desc->taps = taps_get(desc->src_height, oheight, kind);
+    mlt_slices_run_normal(0, scale_rows, desc);
+    mlt_slices_run_normal(0, scale_columns, desc);
+    taps_release(desc->taps);
+    for (int i = 0; i < desc->count; i++)
+        taps_release(desc->components[i].taps);
+    mlt_pool_release(desc->tmp);
+}
+
 static int filter_scale(mlt_frame frame,
                         uint8_t **image,
                         mlt_image_format *format,
@@ -53,68 +473,64 @@ static int filter_scale(mlt_frame frame,
                         int owidth,
                         int oheight)
 {
-    // Create the output image
-    uint8_t *output = mlt_pool_alloc(owidth * (oheight + 1) * 2);
-
-    // Calculate strides
-    int istride = iwidth * 2;
-    int ostride = owidth * 2;
-    iwidth = iwidth - (iwidth % 4);
-
-    // Derived coordinates
-    int dy, dx;
-
-    // Calculate ranges
-    int out_x_range = owidth / 2;
-    int out_y_range = oheight / 2;
-    int in_x_range = iwidth / 2;
-    int in_y_range = iheight / 2;
-
-    // Output pointers
-    register uint8_t *out_line = output;
-    register uint8_t *out_ptr;
-
-    // Calculate a middle pointer
-    uint8_t *in_middle = *image + istride * in_y_range + in_x_range * 2;
-    uint8_t *in_line;
-
-    // Generate the affine transform scaling values
-    register int scale_width = (iwidth << 16) / owidth;
-    register int scale_height = (iheight << 16) / oheight;
-    register int base = 0;
-
-    int outer = out_x_range * scale_width;
-    int bottom = out_y_range * scale_height;
-
-    // Loop for the entirety of our output height.
-    for (dy = -bottom; dy < bottom; dy += scale_height) {
-        // Start at the beginning of the line
-        out_ptr = out_line;
-
-        // Pointer to the middle of the input line
-        in_line = in_middle + (dy >> 16) * istride;
-
-        // Loop for the entirety of our output row.
-        for (dx = -outer; dx < outer; dx += scale_width) {
-            base = dx >> 15;
-            base &= 0xfffffffe;
-            *out_ptr++ = *(in_line + base);
-            base &= 0xfffffffc;
-            *out_ptr++ = *(in_line + base + 1);
-            dx += scale_width;
-            base = dx >> 15;
-            base &= 0xfffffffe;
-            *out_ptr++ = *(in_line + base);
-            base &= 0xfffffffc;
-            *out_ptr++ = *(in_line + base + 3);
+    if (*format != mlt_image_yuv422 && *format != mlt_image_rgb && *format != mlt_image_rgba
+        && *format != mlt_image_rgba64) {
+        if (mlt_frame_convert_image(frame, image, format, mlt_image_yuv422)
+            || *format != mlt_image_yuv422)
+            return 1;
+    }
+
+    enum scale_kind kind = scale_kind(
+        mlt_properties_get(MLT_FRAME_PROPERTIES(frame), "consumer.rescale"));
+    struct mlt_image_s output;
+    scale_desc desc = {.depth = *format == mlt_image_rgba64 ? 16 : 8, .src = *image};
+
+    mlt_image_set_values(&output, NULL, *format, owidth, oheight);
+    mlt_image_alloc_data(&output);
+    desc.dst = output.data;
+    desc.src_height = iheight;
+
+    switch (*format) {
+    case mlt_image_yuv422:
+        desc.src_stride = iwidth * 2;
+        desc.dst_stride = owidth * 2;
+        desc.count = 2;
+        desc.components[0] = (scale_component) {0, scale_row_y8, taps_get(iwidth, owidth, kind)};
+        // Scale the chroma as pairs of U and V
+        desc.components[1] = (scale_component) {1, scale_row_uv8, NULL};
+        desc.components[1].taps = taps_get(MAX(iwidth / 2, 1), MAX(owidth / 2, 1), kind);
+        break;
+    case mlt_image_rgb:
+        desc.src_stride = iwidth * 3;
+        desc.dst_stride = owidth * 3;
+        desc.count = 1;
+        desc.components[0] = (scale_component) {0, scale_row_rgb8, taps_get(iwidth, owidth, kind)};
+        break;
+    default:
+        desc.src_stride = iwidth * 4;
+        desc.dst_stride = owidth * 4;
+        desc.count = 1;
+#if defined(USE_SSE) && defined(ARCH_X86_64)
+        desc.components[0].scale = desc.depth == 8 ? scale_row_rgba8_sse2 : scale_row_rgba16_sse2;
+#else
+        desc.components[0].scale = desc.depth == 8 ? scale_row_rgba8 : scale_row_rgba16;
+#endif
+        desc.components[0].taps = taps_get(iwidth, owidth, kind);
+        break;
+    }
+    scale_image(&desc, owidth, oheight, kind);
+
+    // An odd width leaves the U of the last pixel without a pair
+    if (*format == mlt_image_yuv422 && owidth % 2 && owidth > 1) {
+        for (int line = 0; line < oheight; line++) {
+            uint8_t *p = (uint8_t *) output.data + line * owidth * 2 + (owidth - 1) * 2;
+            p[1] = p[-3];
         }
-        // Move to next output line
-        out_line += ostride;
     }
 
     // Now update the frame
-    mlt_frame_set_image(frame, output, owidth * (oheight + 1) * 2, mlt_pool_release);
-    *image = output;
+    mlt_frame_set_image(frame, output.data, 0, output.release_data);
+    *image = output.data;
 
     return 0;
 }
@@ -122,24 +538,21 @@ static int filter_scale(mlt_frame frame,
 static void scale_alpha(mlt_frame frame, int iwidth, int iheight, int owidth, int oheight)
 {
     // Scale the alpha
-    uint8_t *output = NULL;
     uint8_t *input = mlt_frame_get_alpha(frame);
 
     if (input != NULL) {
-        uint8_t *out_line, *in_line;
-        register int i, j, x, y;
-        register int ox = (iwidth << 16) / owidth;
-        register int oy = (iheight << 16) / oheight;
-
-        output = mlt_pool_alloc(owidth * oheight);
-        out_line = output;
-
-        // Loop for the entirety of our output height.
-        for (i = 0, y = (oy >> 1); i < oheight; i++, y += oy) {
-            in_line = &input[(y >> 16) * iwidth];
-            for (j = 0, x = (ox >> 1); j < owidth; j++, x += ox)
-                *out_line++ = in_line[x >> 16];
-        }
+        enum scale_kind kind = scale_kind(
+            mlt_properties_get(MLT_FRAME_PROPERTIES(frame), "consumer.rescale"));
+        uint8_t *output = mlt_pool_alloc(owidth * oheight);
+        scale_desc desc = {.depth = 8,
+                           .src = input,
+                           .src_stride = iwidth,
+                           .src_height = iheight,
+                           .dst = output,
+                           .dst_stride = owidth,
+                           .count = 1};
+        desc.components[0] = (scale_component) {0, scale_row_a8, taps_get(iwidth, owidth, kind)};
+        scale_image(&desc, owidth, oheight, kind);
 
         // Set it back on the frame
         mlt_frame_set_alpha(frame, output, owidth * oheight, mlt_pool_release);
@@ -218,8 +631,9 @@ static int filter_get_image(mlt_frame frame,
         if (iheight != oheight && (strcmp(interps, "nearest") || (iheight % oheight != 0)))
             mlt_properties_set_int(properties, "consumer.progressive", 1);
 
-        // Convert the image to yuv422 when using the local scaler
-        if (scaler_method == filter_scale)
+        // The local scaler handles yuv422 and packed RGB
+        if (scaler_method == filter_scale && *format != mlt_image_rgb
+            && *format != mlt_image_rgba && *format != mlt_image_rgba64)
             *format = mlt_image_yuv422;
 
         // Get the image as requested
@@ -302,6 +716,14 @@ mlt_filter filter_rescale_init(mlt_profile profile, mlt_service_type type, const
 
         // Set the method
         mlt_properties_set_data(properties, "method", filter_scale, 0, NULL, NULL);
+
+        // Release the cached filter taps with the factory
+        pthread_mutex_lock(&taps_cache.mutex);
+        if (!taps_cache.registered) {
+            taps_cache.registered = 1;
+            mlt_factory_register_for_clean_up(&taps_cache, taps_cache_close);
+        }
+        pthread_mutex_unlock(&taps_cache.mutex);
     }
 
     return filter;
@@ -21,42 +21,79 @@
 #include <framework/mlt_frame.h>
 #include <framework/mlt_log.h>
 #include <framework/mlt_profile.h>
+#include <framework/mlt_slices.h>
 
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/** Centering an image in a larger one */
+
+typedef struct
+{
+    uint8_t *output;
+    int ostride;
+    int oheight;
+    const uint8_t *input;
+    int istride;
+    int iheight;
+    int offset_x; /**< in bytes, negative to crop the input */
+    int offset_y; /**< in rows, negative to crop the input */
+    const uint8_t *black; /**< one output row of the padding color */
+} pad_desc;
+
+static int pad_sliced_proc(int id, int index, int jobs, void *cookie)
+{
+    (void) id; // unused
+    pad_desc *desc = cookie;
+    int start, height = mlt_slices_size_slice(jobs, index, desc->oheight, &start);
+    int out_x = MAX(desc->offset_x, 0);
+    int in_x = MAX(-desc->offset_x, 0);
+    int used = MIN(desc->istride - in_x, desc->ostride - out_x);
+
+    for (int y = start; y < start + height; y++) {
+        uint8_t *out_line = desc->output + y * desc->ostride;
+        int line = y - desc->offset_y;
+
+        if (line < 0 || line >= desc->iheight) {
+            memcpy(out_line, desc->black, desc->ostride);
+        } else {
+            // Write every byte once: the left padding, the input, and the right padding
+            memcpy(out_line, desc->black, out_x);
+            memcpy(out_line + out_x, desc->input + line * desc->istride + in_x, used);
+            memcpy(out_line + out_x + used,
+                   desc->black + out_x + used,
+                   desc->ostride - out_x - used);
+        }
+    }
+    return 0;
+}
+
 static uint8_t *resize_alpha(
     uint8_t *input, int owidth, int oheight, int iwidth, int iheight, uint8_t alpha_value)
 {
     uint8_t *output = NULL;
 
     if (input != NULL && (iwidth != owidth || iheight != oheight) && (owidth > 6 && oheight > 6)) {
-        uint8_t *out_line;
         int offset_x = (owidth - iwidth) / 2;
-        int offset_y = (oheight - iheight) / 2;
-        int iused = iwidth;
+        uint8_t *black = mlt_pool_alloc(owidth);
 
         output = mlt_pool_alloc(owidth * oheight);
-        memset(output, alpha_value, owidth * oheight);
-
+        memset(black, alpha_value, owidth);
         offset_x -= offset_x % 2;
 
-        out_line = output + offset_y * owidth;
-        out_line += offset_x;
-
-        // Loop for the entirety of our output height.
-        while (iheight--) {
-            // We're in the input range for this row.
-            memcpy(out_line, input, iused);
-
-            // Move to next input line
-            input += iwidth;
-
-            // Move to next output line
-            out_line += owidth;
-        }
+        pad_desc desc = {output,
+                         owidth,
+                         oheight,
+                         input,
+                         iwidth,
+                         iheight,
+                         offset_x,
+                         (oheight - iheight) / 2,
+                         black};
+        mlt_slices_run_normal(0, pad_sliced_proc, &desc);
+        mlt_pool_release(black);
     }
 
     return output;
@@ -76,11 +113,6 @@ static void resize_image(uint8_t *output,
     int istride = iwidth * bpp;
     int ostride = owidth * bpp;
     int offset_x = (owidth - iwidth) / 2 * bpp;
-    int offset_y = (oheight - iheight) / 2;
-    uint8_t *in_line = input;
-    uint8_t *out_line;
-    int size = owidth * oheight;
-    uint8_t *p = output;
 
     // Optimisation point
     if (output == NULL || input == NULL
@@ -91,49 +123,38 @@ static void resize_image(uint8_t *output,
         return;
     }
 
+    // Prepare a row of black to copy into the padding
+    uint8_t *black = mlt_pool_alloc(ostride);
     if (format == mlt_image_rgba) {
-        memset(p, 0, size * bpp);
-        if (alpha_value != 0) {
-            while (size--) {
-                p[3] = alpha_value;
-                p += 4;
-            }
-        }
+        memset(black, 0, ostride);
+        for (int x = 0; x < owidth; x++)
+            black[x * 4 + 3] = alpha_value;
     } else if (format == mlt_image_rgba64) {
-        uint16_t *p16 = (uint16_t *) p;
-        uint16_t alpha_value_16 = alpha_value << 8;
-        memset(p16, 0, size * bpp);
-        if (alpha_value != 0) {
-            while (size--) {
-                p16[3] = alpha_value_16;
-                p16 += 4;
-            }
-        }
+        uint16_t *p16 = (uint16_t *) black;
+        memset(black, 0, ostride);
+        for (int x = 0; x < owidth; x++)
+            p16[x * 4 + 3] = alpha_value << 8;
     } else if (bpp == 2) {
-        memset(p, 16, size * bpp);
-        while (size--) {
-            p[1] = 128;
-            p += 2;
+        for (int x = 0; x < owidth; x++) {
+            black[x * 2] = 16;
+            black[x * 2 + 1] = 128;
         }
         offset_x -= offset_x % 4;
     } else {
-        memset(p, 0, size * bpp);
+        memset(black, 0, ostride);
     }
 
-    out_line = output + offset_y * ostride;
-    out_line += offset_x;
-
-    // Loop for the entirety of our output height.
-    while (iheight--) {
-        // We're in the input range for this row.
-        memcpy(out_line, in_line, istride);
-
-        // Move to next input line
-        in_line += istride;
-
-        // Move to next output line
-        out_line += ostride;
-    }
+    pad_desc desc = {output,
+                     ostride,
+                     oheight,
+                     input,
+                     istride,
+                     iheight,
+                     offset_x,
+                     (oheight - iheight) / 2,
+                     black};
+    mlt_slices_run_normal(0, pad_sliced_proc, &desc);
+    mlt_pool_release(black);
 }
 
 /** A padding function for frames - this does not rescale, but simply
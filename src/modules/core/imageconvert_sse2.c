@@ -0,0 +1,197 @@
+/*
+ * imageconvert_sse2.c -- SSE2 lines for the colorspace and pixel format converter
+ * Copyright (C) 2026 Meltytech, LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <emmintrin.h>
+#include <inttypes.h>
+#include <string.h>
+
+/* These compute exactly the same values as YUV2RGB_601_SCALED and RGB2YUV_601_SCALED in
+ * mlt_frame.h: the products are summed in 32 bits with pmaddwd before the shift, and the
+ * saturating packs do the clamping.
+ */
+
+/** Repeat a pair of 16-bit coefficients for pmaddwd. */
+
+static inline __m128i coef_pair(int16_t lo, int16_t hi)
+{
+    return _mm_set1_epi32((int) ((uint32_t) (uint16_t) lo | ((uint32_t) (uint16_t) hi << 16)));
+}
+
+/** Convert 8 pixels of 16-bit Y, U and V, offset by -16, -128 and -128, to RGBA. */
+
+static inline void yuv_to_rgba_8(__m128i y, __m128i u, __m128i v, __m128i a, uint8_t *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coef_r = coef_pair(1192, 1634);
+    const __m128i coef_g_yu = coef_pair(1192, -401);
+    const __m128i coef_g_v = coef_pair(-832, 0);
+    const __m128i coef_b = coef_pair(1192, 2066);
+    __m128i yu_lo = _mm_unpacklo_epi16(y, u);
+    __m128i yu_hi = _mm_unpackhi_epi16(y, u);
+    __m128i yv_lo = _mm_unpacklo_epi16(y, v);
+    __m128i yv_hi = _mm_unpackhi_epi16(y, v);
+    __m128i v_lo = _mm_unpacklo_epi16(v, zero);
+    __m128i v_hi = _mm_unpackhi_epi16(v, zero);
+
+    __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(yv_lo, coef_r), 10),
+                                _mm_srai_epi32(_mm_madd_epi16(yv_hi, coef_r), 10));
+    __m128i g = _mm_packs_epi32(
+        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_lo, coef_g_yu),
+                                     _mm_madd_epi16(v_lo, coef_g_v)),
+                       10),
+        _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu_hi, coef_g_yu),
+                                     _mm_madd_epi16(v_hi, coef_g_v)),
+                       10));
+    __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_madd_epi16(yu_lo, coef_b), 10),
+                                _mm_srai_epi32(_mm_madd_epi16(yu_hi, coef_b), 10));
+
+    // Clamp to 0..255 and interleave
+    __m128i rg = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_packus_epi16(g, g));
+    __m128i ba = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), a);
+    _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128((__m128i *) (dst + 16), _mm_unpackhi_epi16(rg, ba));
+}
+
+static inline __m128i load_alpha_8(const uint8_t *alpha)
+{
+    return alpha ? _mm_loadl_epi64((const __m128i *) alpha) : _mm_set1_epi8((char) 0xff);
+}
+
+/** Convert a line of packed YUV 4:2:2 to RGBA.
+ *
+ * \param alpha an 8-bit alpha line or NULL for opaque
+ * \return the number of pixels converted, a multiple of 8
+ */
+
+int convert_yuv422_to_rgba_line_sse2(const uint8_t *src,
+                                     const uint8_t *alpha,
+                                     uint8_t *dst,
+                                     int width)
+{
+    const __m128i mask_lo = _mm_set1_epi16(0x00ff);
+    const __m128i mask_u = _mm_set1_epi32(0x0000ffff);
+    const __m128i offset_y = _mm_set1_epi16(16);
+    const __m128i offset_uv = _mm_set1_epi16(128);
+    int n = width & ~7;
+
+    for (int i = 0; i < n; i += 8) {
+        __m128i in = _mm_loadu_si128((const __m128i *) (src + i * 2));
+        __m128i y = _mm_sub_epi16(_mm_and_si128(in, mask_lo), offset_y);
+        __m128i uv = _mm_srli_epi16(in, 8);
+        __m128i u = _mm_and_si128(uv, mask_u);
+        __m128i v = _mm_srli_epi32(uv, 16);
+        // Use each chroma sample for two pixels
+        u = _mm_sub_epi16(_mm_or_si128(u, _mm_slli_epi32(u, 16)), offset_uv);
+        v = _mm_sub_epi16(_mm_or_si128(v, _mm_slli_epi32(v, 16)), offset_uv);
+        yuv_to_rgba_8(y, u, v, load_alpha_8(alpha ? alpha + i : NULL), dst + i * 4);
+    }
+    return n;
+}
+
+/** Convert a line of planar YUV 4:2:0 to RGBA.
+ *
+ * \param alpha an 8-bit alpha line or NULL for opaque
+ * \return the number of pixels converted, a multiple of 8
+ */
+
+int convert_yuv420p_to_rgba_line_sse2(const uint8_t *src_y,
+                                      const uint8_t *src_u,
+                                      const uint8_t *src_v,
+                                      const uint8_t *alpha,
+                                      uint8_t *dst,
+                                      int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i offset_y = _mm_set1_epi16(16);
+    const __m128i offset_uv = _mm_set1_epi16(128);
+    int n = width & ~7;
+
+    for (int i = 0; i < n; i += 8) {
+        int32_t u4, v4;
+        memcpy(&u4, src_u + i / 2, sizeof(u4));
+        memcpy(&v4, src_v + i / 2, sizeof(v4));
+        __m128i y = _mm_loadl_epi64((const __m128i *) (src_y + i));
+        __m128i u = _mm_cvtsi32_si128(u4);
+        __m128i v = _mm_cvtsi32_si128(v4);
+        y = _mm_sub_epi16(_mm_unpacklo_epi8(y, zero), offset_y);
+        // Use each chroma sample for two pixels
+        u = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(u, u), zero), offset_uv);
+        v = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(v, v), zero), offset_uv);
+        yuv_to_rgba_8(y, u, v, load_alpha_8(alpha ? alpha + i : NULL), dst + i * 4);
+    }
+    return n;
+}
+
+/** Convert a line of RGBA to packed YUV 4:2:2 and an alpha line.
+ *
+ * \return the number of pixels converted, a multiple of 8
+ */
+
+int convert_rgba_to_yuv422_line_sse2(const uint8_t *src, uint8_t *dst, uint8_t *alpha, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i coef_y_rg = coef_pair(263, 516);
+    const __m128i coef_y_b = coef_pair(100, 0);
+    const __m128i coef_u_rg = coef_pair(-152, -300);
+    const __m128i coef_u_b = coef_pair(450, 0);
+    const __m128i coef_v_rg = coef_pair(450, -377);
+    const __m128i coef_v_b = coef_pair(-73, 0);
+    const __m128i offset_y = _mm_set1_epi16(16);
+    const __m128i offset_uv = _mm_set1_epi16(128);
+    int n = width & ~7;
+
+    for (int i = 0; i < n; i += 8) {
+        __m128i p0 = _mm_loadu_si128((const __m128i *) (src + i * 4));
+        __m128i p1 = _mm_loadu_si128((const __m128i *) (src + i * 4 + 16));
+        __m128i r = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+        __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask),
+                                    _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+        __m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask),
+                                    _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+        __m128i a = _mm_packs_epi32(_mm_srli_epi32(p0, 24), _mm_srli_epi32(p1, 24));
+        __m128i rg_lo = _mm_unpacklo_epi16(r, g);
+        __m128i rg_hi = _mm_unpackhi_epi16(r, g);
+        __m128i b_lo = _mm_unpacklo_epi16(b, zero);
+        __m128i b_hi = _mm_unpackhi_epi16(b, zero);
+
+#define RGB_TO(rg_coef, b_coef) \
+    _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(rg_lo, rg_coef), \
+                                                 _mm_madd_epi16(b_lo, b_coef)), \
+                                   10), \
+                    _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(rg_hi, rg_coef), \
+                                                 _mm_madd_epi16(b_hi, b_coef)), \
+                                   10))
+
+        __m128i y = _mm_add_epi16(RGB_TO(coef_y_rg, coef_y_b), offset_y);
+        __m128i u = _mm_add_epi16(RGB_TO(coef_u_rg, coef_u_b), offset_uv);
+        __m128i v = _mm_add_epi16(RGB_TO(coef_v_rg, coef_v_b), offset_uv);
+#undef RGB_TO
+
+        // Average the chroma of each pair of pixels
+        u = _mm_srai_epi32(_mm_madd_epi16(u, ones), 1);
+        v = _mm_srai_epi32(_mm_madd_epi16(v, ones), 1);
+        __m128i uv = _mm_or_si128(u, _mm_slli_epi32(v, 16));
+        __m128i yuyv = _mm_or_si128(y, _mm_slli_epi16(uv, 8));
+        _mm_storeu_si128((__m128i *) (dst + i * 2), yuyv);
+        _mm_storel_epi64((__m128i *) (alpha + i), _mm_packus_epi16(a, a));
+    }
+    return n;
+}
@@ -130,8 +130,6 @@ static int producer_get_image(mlt_frame frame,
         mlt_properties_set_int(producer_props, "_format", *format);
         mlt_properties_set(producer_props, "_resource", now);
 
-        mlt_service_unlock(MLT_PRODUCER_SERVICE(producer));
-
         if (!strcmp(now, "checkerboard")) {
             struct mlt_image_s img;
             mlt_image_set_values(&img, NULL, *format, *width, *height);
@@ -210,8 +208,6 @@ static int producer_get_image(mlt_frame frame,
                               mlt_image_format_name(*format));
             }
         }
-    } else {
-        mlt_service_unlock(MLT_PRODUCER_SERVICE(producer));
     }
 
     // Create the alpha channel
@@ -228,11 +224,12 @@ static int producer_get_image(mlt_frame frame,
             alpha_size = 0;
     }
 
-    // Clone our image
+    // Clone our image while it cannot be regenerated by another frame
     if (buffer && image && size > 0) {
         *buffer = mlt_pool_alloc(size);
         memcpy(*buffer, image, size);
     }
+    mlt_service_unlock(MLT_PRODUCER_SERVICE(producer));
 
     // Now update properties so we free the copy after
     mlt_frame_set_image(frame, *buffer, size, mlt_pool_release);
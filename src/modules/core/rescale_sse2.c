@@ -0,0 +1,196 @@
+/*
+ * rescale_sse2.c -- SSE2 lines for the separable image scaler
+ * Copyright (C) 2026 Meltytech, LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <emmintrin.h>
+#include <inttypes.h>
+#include <string.h>
+
+/* These compute exactly the same values as the C loops in filter_rescale.c: pairs of taps
+ * are summed in 32 bits with pmaddwd, and the saturating packs do the clamping. pmaddwd
+ * multiplies signed words, so 16-bit samples are offset by -32768 and the sum of the
+ * weights times 32768 is added back.
+ */
+
+/** Repeat a pair of 16-bit weights for pmaddwd. */
+
+static inline __m128i weight_pair(int16_t lo, int16_t hi)
+{
+    return _mm_set1_epi32((int) ((uint32_t) (uint16_t) lo | ((uint32_t) (uint16_t) hi << 16)));
+}
+
+/** Scale a row of 8-bit RGBA into 16-bit samples with 7 extra bits.
+ *
+ * \param start the first input pixel of each output pixel
+ * \param weights taps weights per output pixel
+ */
+
+void scale_rgba_row_sse2(const uint8_t *src,
+                         uint16_t *dst,
+                         const int *start,
+                         const int16_t *weights,
+                         int taps,
+                         int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << 6);
+    const __m128i max = _mm_set1_epi16(255 << 7);
+
+    for (int x = 0; x < width; x++) {
+        const uint8_t *p = src + start[x] * 4;
+        const int16_t *w = weights + x * taps;
+        __m128i acc = round;
+        int k = 0;
+        for (; k + 1 < taps; k += 2) {
+            // r0 g0 b0 a0 r1 g1 b1 a1 -> r0 r1 g0 g1 b0 b1 a0 a1
+            __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (p + k * 4)), zero);
+            v = _mm_unpacklo_epi16(v, _mm_srli_si128(v, 8));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(v, weight_pair(w[k], w[k + 1])));
+        }
+        if (k < taps) {
+            int32_t pixel;
+            memcpy(&pixel, p + k * 4, sizeof(pixel));
+            __m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero);
+            v = _mm_unpacklo_epi16(v, zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(v, weight_pair(w[k], 0)));
+        }
+        acc = _mm_srai_epi32(acc, 7);
+        __m128i out = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(acc, acc), zero), max);
+        _mm_storel_epi64((__m128i *) (dst + x * 4), out);
+    }
+}
+
+/** Scale a row of 16-bit RGBA into 16-bit samples.
+ *
+ * \param start the first input pixel of each output pixel
+ * \param weights taps weights per output pixel
+ */
+
+void scale_rgba64_row_sse2(const uint16_t *src,
+                           uint16_t *dst,
+                           const int *start,
+                           const int16_t *weights,
+                           int taps,
+                           int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sign = _mm_set1_epi16((short) 0x8000);
+    const __m128i offset = _mm_set1_epi32(32768);
+
+    for (int x = 0; x < width; x++) {
+        const uint16_t *p = src + start[x] * 4;
+        const int16_t *w = weights + x * taps;
+        int sum = 0;
+        __m128i acc = zero;
+        int k = 0;
+        for (; k + 1 < taps; k += 2) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (p + k * 4)), sign);
+            v = _mm_unpacklo_epi16(v, _mm_srli_si128(v, 8));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(v, weight_pair(w[k], w[k + 1])));
+            sum += w[k] + w[k + 1];
+        }
+        if (k < taps) {
+            __m128i v = _mm_xor_si128(_mm_loadl_epi64((const __m128i *) (p + k * 4)), sign);
+            v = _mm_unpacklo_epi16(v, zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(v, weight_pair(w[k], 0)));
+            sum += w[k];
+        }
+        acc = _mm_add_epi32(acc, _mm_set1_epi32(sum * 32768 + (1 << 13)));
+        acc = _mm_sub_epi32(_mm_srai_epi32(acc, 14), offset);
+        __m128i out = _mm_xor_si128(_mm_packs_epi32(acc, acc), sign);
+        _mm_storel_epi64((__m128i *) (dst + x * 4), out);
+    }
+}
+
+/** Accumulate the taps of 8 samples from consecutive rows of 16-bit samples.
+ *
+ * \param bias added to the samples, -32768 when they can exceed 32767
+ */
+
+static inline void column_8(const uint16_t *src,
+                            int stride,
+                            const int16_t *w,
+                            int taps,
+                            __m128i bias,
+                            __m128i *lo,
+                            __m128i *hi)
+{
+    int k = 0;
+    for (; k + 1 < taps; k += 2) {
+        __m128i a = _mm_add_epi16(_mm_loadu_si128((const __m128i *) (src + k * stride)), bias);
+        __m128i b = _mm_add_epi16(_mm_loadu_si128((const __m128i *) (src + (k + 1) * stride)),
+                                  bias);
+        __m128i pair = weight_pair(w[k], w[k + 1]);
+        *lo = _mm_add_epi32(*lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), pair));
+        *hi = _mm_add_epi32(*hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), pair));
+    }
+    if (k < taps) {
+        __m128i a = _mm_add_epi16(_mm_loadu_si128((const __m128i *) (src + k * stride)), bias);
+        __m128i pair = weight_pair(w[k], 0);
+        *lo = _mm_add_epi32(*lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, a), pair));
+        *hi = _mm_add_epi32(*hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, a), pair));
+    }
+}
+
+/** Scale a line of 8-bit samples from the rows of 16-bit samples with 7 extra bits.
+ *
+ * \param stride the number of samples between the rows
+ * \return the number of samples scaled, a multiple of 8
+ */
+
+int scale_column_line8_sse2(
+    const uint16_t *src, int stride, const int16_t *weights, int taps, uint8_t *dst, int width)
+{
+    const __m128i round = _mm_set1_epi32(1 << 20);
+    int x = 0;
+
+    for (; x + 8 <= width; x += 8) {
+        __m128i lo = round, hi = round;
+        column_8(src + x, stride, weights, taps, _mm_setzero_si128(), &lo, &hi);
+        __m128i out = _mm_packs_epi32(_mm_srai_epi32(lo, 21), _mm_srai_epi32(hi, 21));
+        _mm_storel_epi64((__m128i *) (dst + x), _mm_packus_epi16(out, out));
+    }
+    return x;
+}
+
+/** Scale a line of 16-bit samples from the rows of 16-bit samples.
+ *
+ * \param stride the number of samples between the rows
+ * \return the number of samples scaled, a multiple of 8
+ */
+
+int scale_column_line16_sse2(
+    const uint16_t *src, int stride, const int16_t *weights, int taps, uint16_t *dst, int width)
+{
+    const __m128i sign = _mm_set1_epi16((short) 0x8000);
+    const __m128i offset = _mm_set1_epi32(32768);
+    int sum = 0;
+    int x = 0;
+
+    for (int k = 0; k < taps; k++)
+        sum += weights[k];
+    const __m128i round = _mm_set1_epi32(sum * 32768 + (1 << 13));
+    for (; x + 8 <= width; x += 8) {
+        __m128i lo = round, hi = round;
+        column_8(src + x, stride, weights, taps, sign, &lo, &hi);
+        lo = _mm_sub_epi32(_mm_srai_epi32(lo, 14), offset);
+        hi = _mm_sub_epi32(_mm_srai_epi32(hi, 14), offset);
+        _mm_storeu_si128((__m128i *) (dst + x), _mm_xor_si128(_mm_packs_epi32(lo, hi), sign));
+    }
+    return x;
+}
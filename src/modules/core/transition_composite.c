@@ -449,6 +449,9 @@ static int composite_yuv(uint8_t *p_dest,
     // Align chroma of source and destination
     if (uneven_x != uneven_x_src) {
         p_src += 2;
+        // without reading past the end of the source lines
+        if (x_src + 1 + width_src > geometry->sw)
+            width_src = geometry->sw - x_src - 1;
     }
 
     // now do the compositing only to cropped extents
@@ -840,6 +843,62 @@ static int get_b_frame_image(mlt_transition self,
     return !error && image;
 }
 
+/** Check whether the images of the a and b frames can be got at the same time.
+
+    The b frame carries parallel_tracks from the tractor. Getting the b image copies
+    the consumer properties of the a frame, so they must already be what getting the
+    a image leaves them as: the scaling is settled here like get_image_a does, and
+    only a progressive consumer stops filters from changing consumer.progressive.
+*/
+
+int composite_parallel_tracks(mlt_frame a_frame, mlt_frame b_frame)
+{
+    mlt_properties a_props = MLT_FRAME_PROPERTIES(a_frame);
+    if (!mlt_properties_get_int(MLT_FRAME_PROPERTIES(b_frame), "parallel_tracks")
+        || !mlt_properties_get_int(a_props, "consumer.progressive"))
+        return 0;
+    const char *rescale = mlt_properties_get(a_props, "consumer.rescale");
+    if (!rescale || !strcmp(rescale, "none"))
+        mlt_properties_set(a_props, "consumer.rescale", "nearest");
+    return 1;
+}
+
+/** The parameters of getting the a and b frame images at the same time.
+*/
+
+typedef struct
+{
+    mlt_transition self;
+    mlt_frame a_frame;
+    uint8_t **image;
+    mlt_image_format *format;
+    int *width;
+    int *height;
+    mlt_frame b_frame;
+    uint8_t *image_b;
+    int width_b;
+    int height_b;
+    struct geometry_s *geometry;
+    int b_ok;
+} get_images_desc;
+
+static int get_images_sliced_proc(int id, int idx, int jobs, void *cookie)
+{
+    (void) id;   // unused
+    (void) jobs; // unused
+    get_images_desc *desc = cookie;
+    if (idx == 0)
+        mlt_frame_get_image(desc->a_frame, desc->image, desc->format, desc->width, desc->height, 1);
+    else
+        desc->b_ok = get_b_frame_image(desc->self,
+                                       desc->b_frame,
+                                       &desc->image_b,
+                                       &desc->width_b,
+                                       &desc->height_b,
+                                       desc->geometry);
+    return 0;
+}
+
 static void crop_calculate(mlt_transition self, struct geometry_s *result, double position)
 {
     // Get the properties from the transition
@@ -1034,8 +1093,33 @@ static int transition_get_image(mlt_frame a_frame,
             mlt_properties_set_double(a_props, "aspect_ratio", aspect_ratio);
         }
 
-        // Get the image from the a frame
-        mlt_frame_get_image(a_frame, image, format, width, height, 1);
+        // The b image does not depend on the a image unless titling, so a tractor with
+        // parallel_tracks can get both images at the same time
+        int b_fetched = 0;
+        int b_ok = 0;
+        if (a_frame != b_frame && result.item.o != 0 && (result.item.w != 0 || result.item.h != 0)
+            && !mlt_properties_get_int(properties, "titles")
+            && composite_parallel_tracks(a_frame, b_frame)) {
+            get_images_desc desc = {.self = self,
+                                    .a_frame = a_frame,
+                                    .image = image,
+                                    .format = format,
+                                    .width = width,
+                                    .height = height,
+                                    .b_frame = b_frame,
+                                    .width_b = width_b,
+                                    .height_b = height_b,
+                                    .geometry = &result};
+            mlt_slices_run_normal(2, get_images_sliced_proc, &desc);
+            image_b = desc.image_b;
+            width_b = desc.width_b;
+            height_b = desc.height_b;
+            b_ok = desc.b_ok;
+            b_fetched = 1;
+        } else {
+            // Get the image from the a frame
+            mlt_frame_get_image(a_frame, image, format, width, height, 1);
+        }
         alpha_a = mlt_frame_get_alpha(a_frame);
 
         // Optimisation - no compositing required
@@ -1065,9 +1149,10 @@ static int transition_get_image(mlt_frame a_frame,
             height_b = mlt_properties_get_int(a_props, "dest_height");
         }
 
-        if (*image != image_b
-            && (image_b
-                || get_b_frame_image(self, b_frame, &image_b, &width_b, &height_b, &result))) {
+        if (!b_fetched && *image != image_b)
+            b_ok = image_b
+                   || get_b_frame_image(self, b_frame, &image_b, &width_b, &height_b, &result);
+        if (*image != image_b && b_ok) {
             int progressive = mlt_properties_get_int(a_props, "consumer.progressive")
                               || mlt_properties_get_int(properties, "progressive");
             int top_field_first = mlt_properties_get_int(a_props, "top_field_first");
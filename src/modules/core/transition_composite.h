@@ -37,4 +37,6 @@ extern void composite_line_yuv(uint8_t *dest,
                                int soft,
                                uint32_t step);
 
+extern int composite_parallel_tracks(mlt_frame a_frame, mlt_frame b_frame);
+
 #endif
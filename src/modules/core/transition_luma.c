@@ -31,6 +31,49 @@
 #include <stdlib.h>
 #include <string.h>
 
+/** A request for the image of a frame.
+*/
+
+typedef struct
+{
+    mlt_frame frame;
+    uint8_t **image;
+    mlt_image_format *format;
+    int *width;
+    int *height;
+    int writable;
+} image_request;
+
+static int get_image_sliced_proc(int id, int idx, int jobs, void *cookie)
+{
+    (void) id;   // unused
+    (void) jobs; // unused
+    image_request *request = (image_request *) cookie + idx;
+    mlt_frame_get_image(request->frame,
+                        request->image,
+                        request->format,
+                        request->width,
+                        request->height,
+                        request->writable);
+    return 0;
+}
+
+/** Get the images of the a and b frames.
+
+    The requests do not depend on each other, so a tractor with parallel_tracks
+    can get both at the same time.
+*/
+
+static void get_images(image_request requests[2])
+{
+    if (composite_parallel_tracks(requests[0].frame, requests[1].frame)) {
+        mlt_slices_run_normal(2, get_image_sliced_proc, requests);
+    } else {
+        get_image_sliced_proc(0, 0, 2, requests);
+        get_image_sliced_proc(0, 1, 2, requests);
+    }
+}
+
 static inline int is_opaque(uint8_t *alpha_channel, int width, int height)
 {
     int n = width * height + 1;
@@ -148,6 +191,7 @@ static inline int dissolve_yuv422(mlt_frame frame,
     uint8_t *alpha_dst;
     int mix = weight * (1 << 16);
 
+    // The b image is requested in the format of the a image, so they cannot be fetched together
     mlt_frame_get_image(frame, &p_dest, &format, &width, &height, 1);
     if (fix_background_alpha && mlt_frame_has_convert_image(frame))
         mlt_frame_convert_image(frame, &p_dest, &format, mlt_image_yuv422);
@@ -220,10 +264,12 @@ static inline int dissolve_rgba32(
     struct mlt_image_s dimg;
     struct mlt_image_s simg;
     mlt_image_set_values(&dimg, NULL, mlt_image_rgba, width, height);
-    mlt_frame_get_image(frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1);
-    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, NULL, mlt_image_rgba, width, height);
-    mlt_frame_get_image(that, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0);
+    image_request requests[] = {
+        {frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1},
+        {that, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0}};
+    get_images(requests);
+    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, simg.data, simg.format, simg.width, simg.height);
 
     if (simg.width != dimg.width || simg.height != dimg.height) {
@@ -271,10 +317,12 @@ static inline int dissolve_rgba64(
     struct mlt_image_s dimg;
     struct mlt_image_s simg;
     mlt_image_set_values(&dimg, NULL, mlt_image_rgba64, width, height);
-    mlt_frame_get_image(frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1);
-    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, NULL, mlt_image_rgba64, width, height);
-    mlt_frame_get_image(that, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0);
+    image_request requests[] = {
+        {frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1},
+        {that, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0}};
+    get_images(requests);
+    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, simg.data, simg.format, simg.width, simg.height);
 
     if (simg.width != dimg.width || simg.height != dimg.height) {
@@ -357,11 +405,12 @@ static void luma_composite_yuv422(mlt_frame a_frame,
         mlt_properties_set(&b_frame->parent,
                            "distort",
                            mlt_properties_get(&a_frame->parent, "distort"));
-    mlt_frame_get_image(a_frame, &p_dest, &format_dest, &width_dest, &height_dest, 1);
+    image_request requests[] = {{a_frame, &p_dest, &format_dest, &width_dest, &height_dest, 1},
+                                {b_frame, &p_src, &format_src, &width_src, &height_src, 0}};
+    get_images(requests);
     if (fix_background_alpha && mlt_frame_has_convert_image(a_frame))
         mlt_frame_convert_image(a_frame, &p_dest, &format_dest, mlt_image_yuv422);
     alpha_dest = mlt_frame_get_alpha(a_frame);
-    mlt_frame_get_image(b_frame, &p_src, &format_src, &width_src, &height_src, 0);
     if (fix_background_alpha && mlt_frame_has_convert_image(b_frame))
         mlt_frame_convert_image(b_frame, &p_src, &format_src, mlt_image_yuv422);
     alpha_src = mlt_frame_get_alpha(b_frame);
@@ -493,10 +542,12 @@ static int luma_composite_rgba32(mlt_frame a_frame,
     struct mlt_image_s dimg;
     struct mlt_image_s simg;
     mlt_image_set_values(&dimg, NULL, mlt_image_rgba, width, height);
-    mlt_frame_get_image(a_frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1);
-    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, NULL, mlt_image_rgba, width, height);
-    mlt_frame_get_image(b_frame, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0);
+    image_request requests[] = {
+        {a_frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1},
+        {b_frame, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0}};
+    get_images(requests);
+    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, simg.data, simg.format, simg.width, simg.height);
 
     if (simg.width != dimg.width || simg.height != dimg.height || simg.width == 0 || dimg.width == 0
@@ -618,10 +669,12 @@ static int luma_composite_rgba64(mlt_frame a_frame,
     struct mlt_image_s dimg;
     struct mlt_image_s simg;
     mlt_image_set_values(&dimg, NULL, mlt_image_rgba64, width, height);
-    mlt_frame_get_image(a_frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1);
-    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, NULL, mlt_image_rgba64, width, height);
-    mlt_frame_get_image(b_frame, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0);
+    image_request requests[] = {
+        {a_frame, (uint8_t **) &dimg.data, &dimg.format, &dimg.width, &dimg.height, 1},
+        {b_frame, (uint8_t **) &simg.data, &simg.format, &simg.width, &simg.height, 0}};
+    get_images(requests);
+    mlt_image_set_values(&dimg, dimg.data, dimg.format, dimg.width, dimg.height);
     mlt_image_set_values(&simg, simg.data, simg.format, simg.width, simg.height);
 
     if (simg.width != dimg.width || simg.height != dimg.height || simg.width == 0 || dimg.width == 0
@@ -47,6 +47,9 @@ static void initialise()
             mlt_service_cache_set_size(NULL, "pixbuf.alpha", n);
             mlt_service_cache_set_size(NULL, "pixbuf.pixbuf", n);
         }
+        mlt_service_cache_share(NULL, "pixbuf.image");
+        mlt_service_cache_share(NULL, "pixbuf.alpha");
+        mlt_service_cache_share(NULL, "pixbuf.pixbuf");
         if (getenv("MLT_PANGO_PRODUCER_CACHE")) {
             int n = atoi(getenv("MLT_PANGO_PRODUCER_CACHE"));
             mlt_service_cache_set_size(NULL, "pango.image", n);
@@ -535,7 +535,8 @@ static int refresh_pixbuf(producer_pixbuf self, mlt_frame frame)
             mlt_service_cache_put(MLT_PRODUCER_SERVICE(producer),
                                   "pixbuf.pixbuf",
                                   self->pixbuf,
-                                  0,
+                                  gdk_pixbuf_get_rowstride(self->pixbuf)
+                                      * gdk_pixbuf_get_height(self->pixbuf),
                                   (mlt_destructor) g_object_unref);
             self->pixbuf_cache = mlt_service_cache_get(MLT_PRODUCER_SERVICE(producer),
                                                        "pixbuf.pixbuf");
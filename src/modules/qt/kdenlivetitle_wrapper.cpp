@@ -788,6 +788,33 @@ int initTitleProducer(mlt_producer producer)
     return true;
 }
 
+/** Hand a rendered buffer to the producer's cache and hold a reference to it.
+ *
+ * \return the buffer or NULL if it was released already
+ */
+
+static uint8_t *cache_buffer(
+    producer_ktitle self, const char *name, mlt_cache_item *item, uint8_t *buffer, int size)
+{
+    mlt_service service = MLT_PRODUCER_SERVICE(&self->parent);
+    mlt_cache_item_close(*item);
+    mlt_service_cache_put(service, name, buffer, size, buffer ? mlt_pool_release : NULL);
+    *item = mlt_service_cache_get(service, name);
+    return static_cast<uint8_t *>(mlt_cache_item_data(*item, NULL));
+}
+
+/** Get a reference to a cached buffer.
+ *
+ * \return the buffer or NULL if it was released by the cache
+ */
+
+static uint8_t *cached_buffer(producer_ktitle self, const char *name, mlt_cache_item *item)
+{
+    mlt_cache_item_close(*item);
+    *item = mlt_service_cache_get(MLT_PRODUCER_SERVICE(&self->parent), name);
+    return static_cast<uint8_t *>(mlt_cache_item_data(*item, NULL));
+}
+
 void drawKdenliveTitle(producer_ktitle self,
                        mlt_frame frame,
                        mlt_image_format format,
@@ -806,6 +833,18 @@ void drawKdenliveTitle(producer_ktitle self,
 
     pthread_mutex_lock(&self->mutex);
 
+    // Render again if the cache released the last rendering
+    if (self->current_image) {
+        uint8_t *rgba_image = cached_buffer(self, "kdenlivetitle.rgba", &self->rgba_cache);
+        uint8_t *image = cached_buffer(self, "kdenlivetitle.image", &self->image_cache);
+        uint8_t *alpha = cached_buffer(self, "kdenlivetitle.alpha", &self->alpha_cache);
+        if (!rgba_image || !image || (self->current_alpha && !alpha))
+            image = NULL;
+        self->rgba_image = rgba_image;
+        self->current_image = image;
+        self->current_alpha = alpha;
+    }
+
     // Check if user wants us to reload the image or if we need animation
     bool animated = mlt_properties_get(producer_props, "_endrect") != NULL;
 
@@ -814,7 +853,7 @@ void drawKdenliveTitle(producer_ktitle self,
         if (!animated) {
             // Cache image only if no animation
             self->current_image = NULL;
-            mlt_properties_set_data(producer_props, "_cached_image", NULL, 0, NULL, NULL);
+            cache_buffer(self, "kdenlivetitle.image", &self->image_cache, NULL, 0);
         }
         mlt_properties_set_int(producer_props, "force_reload", 0);
     }
@@ -948,18 +987,16 @@ void drawKdenliveTitle(producer_ktitle self,
         convert_qimage_to_mlt(&img, self->rgba_image, width, height);
         self->current_image = (uint8_t *) mlt_pool_alloc(image_size);
         memcpy(self->current_image, self->rgba_image, image_size);
-        mlt_properties_set_data(producer_props,
-                                "_cached_buffer",
-                                self->rgba_image,
-                                image_size,
-                                mlt_pool_release,
-                                NULL);
-        mlt_properties_set_data(producer_props,
-                                "_cached_image",
-                                self->current_image,
-                                image_size,
-                                mlt_pool_release,
-                                NULL);
+        self->rgba_image = cache_buffer(self,
+                                        "kdenlivetitle.rgba",
+                                        &self->rgba_cache,
+                                        self->rgba_image,
+                                        image_size);
+        self->current_image = cache_buffer(self,
+                                           "kdenlivetitle.image",
+                                           &self->image_cache,
+                                           self->current_image,
+                                           image_size);
         self->current_width = width;
         self->current_height = height;
 
@@ -967,28 +1004,27 @@ void drawKdenliveTitle(producer_ktitle self,
         if ((alpha = mlt_frame_get_alpha(frame))) {
             self->current_alpha = (uint8_t *) mlt_pool_alloc(width * height);
             memcpy(self->current_alpha, alpha, width * height);
-            mlt_properties_set_data(producer_props,
-                                    "_cached_alpha",
-                                    self->current_alpha,
-                                    width * height,
-                                    mlt_pool_release,
-                                    NULL);
         }
+        self->current_alpha = cache_buffer(self,
+                                           "kdenlivetitle.alpha",
+                                           &self->alpha_cache,
+                                           self->current_alpha,
+                                           width * height);
     }
 
     // Convert image to requested format
-    if (format != mlt_image_none && format != mlt_image_movit && format != self->format) {
+    if (self->current_image && self->rgba_image && format != mlt_image_none
+        && format != mlt_image_movit && format != self->format) {
         uint8_t *buffer = NULL;
         if (self->format != mlt_image_rgba) {
             // Image buffer was previously converted, revert to original rgba buffer
             self->current_image = (uint8_t *) mlt_pool_alloc(image_size);
             memcpy(self->current_image, self->rgba_image, image_size);
-            mlt_properties_set_data(producer_props,
-                                    "_cached_image",
-                                    self->current_image,
-                                    image_size,
-                                    mlt_pool_release,
-                                    NULL);
+            self->current_image = cache_buffer(self,
+                                               "kdenlivetitle.image",
+                                               &self->image_cache,
+                                               self->current_image,
+                                               image_size);
             self->format = mlt_image_rgba;
         }
 
@@ -1005,22 +1041,20 @@ void drawKdenliveTitle(producer_ktitle self,
             image_size = mlt_image_format_size(format, width, height, NULL);
             self->current_image = (uint8_t *) mlt_pool_alloc(image_size);
             memcpy(self->current_image, buffer, image_size);
-            mlt_properties_set_data(producer_props,
-                                    "_cached_image",
-                                    self->current_image,
-                                    image_size,
-                                    mlt_pool_release,
-                                    NULL);
+            self->current_image = cache_buffer(self,
+                                               "kdenlivetitle.image",
+                                               &self->image_cache,
+                                               self->current_image,
+                                               image_size);
         }
         if ((buffer = mlt_frame_get_alpha(frame))) {
             self->current_alpha = (uint8_t *) mlt_pool_alloc(width * height);
             memcpy(self->current_alpha, buffer, width * height);
-            mlt_properties_set_data(producer_props,
-                                    "_cached_alpha",
-                                    self->current_alpha,
-                                    width * height,
-                                    mlt_pool_release,
-                                    NULL);
+            self->current_alpha = cache_buffer(self,
+                                               "kdenlivetitle.alpha",
+                                               &self->alpha_cache,
+                                               self->current_alpha,
+                                               width * height);
         }
     }
 
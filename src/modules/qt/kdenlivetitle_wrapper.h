@@ -39,6 +39,9 @@ struct producer_ktitle_s
     int current_height;
     int has_alpha;
     pthread_mutex_t mutex;
+    mlt_cache_item rgba_cache;
+    mlt_cache_item image_cache;
+    mlt_cache_item alpha_cache;
 };
 
 typedef struct producer_ktitle_s *producer_ktitle;
@@ -131,6 +131,12 @@ static int producer_get_image(mlt_frame frame,
         error = 1;
     }
 
+    // Let the cache release the rendering while it is not in use
+    mlt_cache_item_close(self->rgba_cache);
+    mlt_cache_item_close(self->image_cache);
+    mlt_cache_item_close(self->alpha_cache);
+    self->rgba_cache = self->image_cache = self->alpha_cache = NULL;
+
     mlt_service_unlock(MLT_PRODUCER_SERVICE(producer));
 
     return error;
@@ -217,6 +223,15 @@ mlt_producer producer_kdenlivetitle_init(mlt_profile profile,
         /* Callback registration */
         producer->get_frame = producer_get_frame;
         producer->close = (mlt_destructor) producer_close;
+
+        /* Keep a rendering per title, limited only by the shared cache budget */
+        mlt_service service = MLT_PRODUCER_SERVICE(producer);
+        mlt_service_cache_set_max_bytes(service, "kdenlivetitle.rgba", INT64_MAX);
+        mlt_service_cache_set_max_bytes(service, "kdenlivetitle.image", INT64_MAX);
+        mlt_service_cache_set_max_bytes(service, "kdenlivetitle.alpha", INT64_MAX);
+        mlt_service_cache_share(service, "kdenlivetitle.rgba");
+        mlt_service_cache_share(service, "kdenlivetitle.image");
+        mlt_service_cache_share(service, "kdenlivetitle.alpha");
         mlt_properties_set(properties, "resource", filename);
         mlt_properties_set_int(properties, "meta.media.progressive", 1);
         mlt_properties_set_int(properties, "aspect_ratio", 1);
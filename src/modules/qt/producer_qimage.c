@@ -77,6 +77,9 @@ mlt_producer producer_qimage_init(mlt_profile profile,
         // Callback registration
         producer->get_frame = producer_get_frame;
         producer->close = (mlt_destructor) producer_close;
+        mlt_service_cache_share(MLT_PRODUCER_SERVICE(producer), "qimage.qimage");
+        mlt_service_cache_share(MLT_PRODUCER_SERVICE(producer), "qimage.image");
+        mlt_service_cache_share(MLT_PRODUCER_SERVICE(producer), "qimage.alpha");
 
         // Set the default properties
         mlt_properties_set(properties, "resource", filename);
@@ -164,7 +164,7 @@ int refresh_qimage(producer_qimage self, mlt_frame frame, int enable_caching)
                 mlt_service_cache_put(MLT_PRODUCER_SERVICE(producer),
                                       "qimage.qimage",
                                       qimage,
-                                      0,
+                                      qimage->sizeInBytes(),
                                       (mlt_destructor) qimage_delete);
                 self->qimage_cache = mlt_service_cache_get(MLT_PRODUCER_SERVICE(producer),
                                                            "qimage.qimage");
@@ -250,7 +250,7 @@ void refresh_image(producer_qimage self,
             mlt_service_cache_put(MLT_PRODUCER_SERVICE(producer),
                                   "qimage.qimage",
                                   qimage,
-                                  0,
+                                  qimage->sizeInBytes(),
                                   (mlt_destructor) qimage_delete);
             self->qimage_cache = mlt_service_cache_get(MLT_PRODUCER_SERVICE(producer),
                                                        "qimage.qimage");
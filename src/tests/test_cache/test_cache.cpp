@@ -0,0 +1,462 @@
+/*
+ * Copyright (C) 2026 Meltytech, LLC
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with consumer library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <framework/mlt.h>
+#include <mlt++/Mlt.h>
+#include <QtTest>
+using namespace Mlt;
+
+// The cached data are ints counting how many times they were destroyed.
+static void destroy_counter(void *data)
+{
+    ++*static_cast<int *>(data);
+}
+
+static void close_cache(void *data)
+{
+    mlt_cache_close(static_cast<mlt_cache>(data));
+}
+
+static bool is_cached(mlt_cache cache, void *object)
+{
+    mlt_cache_item item = mlt_cache_get(cache, object);
+    bool result = mlt_cache_item_data(item, NULL) != NULL;
+    mlt_cache_item_close(item);
+    return result;
+}
+
+static void put_frame(mlt_cache cache, mlt_position position, int image_size)
+{
+    mlt_frame frame = mlt_frame_init(NULL);
+    mlt_frame_set_position(frame, position);
+    if (image_size > 0) {
+        uint8_t *image = static_cast<uint8_t *>(mlt_pool_alloc(image_size));
+        mlt_frame_set_image(frame, image, image_size, mlt_pool_release);
+        mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "format", mlt_image_rgba);
+        mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "width", image_size / 4);
+        mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "height", 1);
+    }
+    mlt_cache_put_frame(cache, frame);
+    mlt_frame_close(frame);
+}
+
+static bool has_frame(mlt_cache cache, mlt_position position)
+{
+    mlt_frame frame = mlt_cache_get_frame(cache, position);
+    mlt_frame_close(frame);
+    return frame != NULL;
+}
+
+class TestCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestCache() { Factory::init(); }
+
+private Q_SLOTS:
+
+    void DefaultSizeIsFour()
+    {
+        mlt_cache cache = mlt_cache_init();
+        QVERIFY(cache);
+        QCOMPARE(mlt_cache_get_size(cache), 4);
+        QCOMPARE(mlt_cache_get_max_bytes(cache), int64_t(0));
+        mlt_cache_close(cache);
+    }
+
+    void GetReturnsWhatWasPut()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int object, data = 0, size = 0;
+        mlt_cache_put(cache, &object, &data, 10, destroy_counter);
+        mlt_cache_item item = mlt_cache_get(cache, &object);
+        QVERIFY(item);
+        QCOMPARE(mlt_cache_item_data(item, &size), static_cast<void *>(&data));
+        QCOMPARE(size, 10);
+        mlt_cache_item_close(item);
+        QCOMPARE(data, 0);
+        mlt_cache_close(cache);
+        QCOMPARE(data, 1);
+    }
+
+    void GetMissReturnsNoData()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int object;
+        mlt_cache_item item = mlt_cache_get(cache, &object);
+        QVERIFY(!mlt_cache_item_data(item, NULL));
+        mlt_cache_item_close(item);
+        mlt_cache_close(cache);
+    }
+
+    void PutEvictsLeastRecentlyPut()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[4], data[4] = {0, 0, 0, 0};
+        mlt_cache_set_size(cache, 3);
+        for (int i = 0; i < 4; i++)
+            mlt_cache_put(cache, &objects[i], &data[i], 0, destroy_counter);
+        QCOMPARE(data[0], 1);
+        QCOMPARE(data[1], 0);
+        QVERIFY(!is_cached(cache, &objects[0]));
+        for (int i = 1; i < 4; i++)
+            QVERIFY(is_cached(cache, &objects[i]));
+        mlt_cache_close(cache);
+        for (int i = 1; i < 4; i++)
+            QCOMPARE(data[i], 1);
+    }
+
+    void GetMakesItemMostRecentlyUsed()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[4], data[4] = {0, 0, 0, 0};
+        mlt_cache_set_size(cache, 3);
+        for (int i = 0; i < 3; i++)
+            mlt_cache_put(cache, &objects[i], &data[i], 0, destroy_counter);
+        // Using the oldest makes the second one the least recently used
+        QVERIFY(is_cached(cache, &objects[0]));
+        mlt_cache_put(cache, &objects[3], &data[3], 0, destroy_counter);
+        QCOMPARE(data[0], 0);
+        QCOMPARE(data[1], 1);
+        QVERIFY(is_cached(cache, &objects[0]));
+        QVERIFY(!is_cached(cache, &objects[1]));
+        mlt_cache_close(cache);
+    }
+
+    void PutMakesItemMostRecentlyUsed()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[4], data[4] = {0, 0, 0, 0}, replacement = 0;
+        mlt_cache_set_size(cache, 3);
+        for (int i = 0; i < 3; i++)
+            mlt_cache_put(cache, &objects[i], &data[i], 0, destroy_counter);
+        // Replacing the data of the oldest releases the old data
+        mlt_cache_put(cache, &objects[0], &replacement, 0, destroy_counter);
+        QCOMPARE(data[0], 1);
+        mlt_cache_put(cache, &objects[3], &data[3], 0, destroy_counter);
+        QCOMPARE(data[1], 1);
+        QCOMPARE(replacement, 0);
+        mlt_cache_item item = mlt_cache_get(cache, &objects[0]);
+        QCOMPARE(mlt_cache_item_data(item, NULL), static_cast<void *>(&replacement));
+        mlt_cache_item_close(item);
+        mlt_cache_close(cache);
+        QCOMPARE(replacement, 1);
+    }
+
+    void SizeIsNotLimitedTo200()
+    {
+        mlt_cache cache = mlt_cache_init();
+        const int n = 1000;
+        int objects[n], data[n] = {};
+        mlt_cache_set_size(cache, n);
+        QCOMPARE(mlt_cache_get_size(cache), n);
+        for (int i = 0; i < n; i++)
+            mlt_cache_put(cache, &objects[i], &data[i], 0, destroy_counter);
+        for (int i = 0; i < n; i++)
+            QCOMPARE(data[i], 0);
+        for (int i = 0; i < n; i++)
+            QVERIFY(is_cached(cache, &objects[i]));
+        mlt_cache_close(cache);
+    }
+
+    void ShrinkingEvictsOnNextPut()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[5], data[5] = {};
+        for (int i = 0; i < 4; i++)
+            mlt_cache_put(cache, &objects[i], &data[i], 0, destroy_counter);
+        mlt_cache_set_size(cache, 2);
+        mlt_cache_put(cache, &objects[4], &data[4], 0, destroy_counter);
+        QCOMPARE(data[0] + data[1] + data[2], 3);
+        QVERIFY(is_cached(cache, &objects[3]));
+        QVERIFY(is_cached(cache, &objects[4]));
+        mlt_cache_close(cache);
+    }
+
+    void PurgeReleasesItem()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[2], data[2] = {0, 0};
+        for (int i = 0; i < 2; i++)
+            mlt_cache_put(cache, &objects[i], &data[i], 0, destroy_counter);
+        mlt_cache_purge(cache, &objects[0]);
+        QCOMPARE(data[0], 1);
+        QVERIFY(!is_cached(cache, &objects[0]));
+        QVERIFY(is_cached(cache, &objects[1]));
+        // Purging what is not there does nothing
+        mlt_cache_purge(cache, &objects[0]);
+        QCOMPARE(data[0], 1);
+        mlt_cache_close(cache);
+        QCOMPARE(data[1], 1);
+    }
+
+    void PurgedItemInUseIsReleasedOnClose()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int object, data = 0;
+        mlt_cache_put(cache, &object, &data, 0, destroy_counter);
+        mlt_cache_item item = mlt_cache_get(cache, &object);
+        mlt_cache_purge(cache, &object);
+        QCOMPARE(data, 0);
+        QCOMPARE(mlt_cache_item_data(item, NULL), static_cast<void *>(&data));
+        mlt_cache_item_close(item);
+        QCOMPARE(data, 1);
+        mlt_cache_close(cache);
+        QCOMPARE(data, 1);
+    }
+
+    void EvictedItemInUseIsReleasedOnClose()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[2], data[2] = {0, 0};
+        mlt_cache_set_size(cache, 1);
+        mlt_cache_put(cache, &objects[0], &data[0], 0, destroy_counter);
+        mlt_cache_item item = mlt_cache_get(cache, &objects[0]);
+        mlt_cache_put(cache, &objects[1], &data[1], 0, destroy_counter);
+        QVERIFY(!is_cached(cache, &objects[0]));
+        QCOMPARE(data[0], 0);
+        mlt_cache_item_close(item);
+        QCOMPARE(data[0], 1);
+        mlt_cache_close(cache);
+        QCOMPARE(data[1], 1);
+    }
+
+    void ReplacedItemInUseKeepsItsData()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int object, old_data = 0, new_data = 0;
+        mlt_cache_put(cache, &object, &old_data, 0, destroy_counter);
+        mlt_cache_item item1 = mlt_cache_get(cache, &object);
+        mlt_cache_item item2 = mlt_cache_get(cache, &object);
+        mlt_cache_put(cache, &object, &new_data, 0, destroy_counter);
+        // The old data is in the garbage collection until both are closed
+        QCOMPARE(old_data, 0);
+        QCOMPARE(mlt_cache_item_data(item1, NULL), static_cast<void *>(&old_data));
+        mlt_cache_item_close(item1);
+        QCOMPARE(old_data, 0);
+        mlt_cache_item_close(item2);
+        QCOMPARE(old_data, 1);
+        QCOMPARE(new_data, 0);
+        mlt_cache_item item = mlt_cache_get(cache, &object);
+        QCOMPARE(mlt_cache_item_data(item, NULL), static_cast<void *>(&new_data));
+        mlt_cache_item_close(item);
+        mlt_cache_close(cache);
+        QCOMPARE(old_data, 1);
+        QCOMPARE(new_data, 1);
+    }
+
+    void MaxBytesEvictsByCost()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[4], data[4] = {};
+        mlt_cache_set_max_bytes(cache, 300);
+        QCOMPARE(mlt_cache_get_max_bytes(cache), int64_t(300));
+        for (int i = 0; i < 3; i++)
+            mlt_cache_put(cache, &objects[i], &data[i], 100, destroy_counter);
+        QCOMPARE(mlt_cache_get_bytes(cache), int64_t(300));
+        QCOMPARE(data[0], 0);
+        // The count does not matter with a number of bytes
+        QVERIFY(mlt_cache_get_size(cache) > 0);
+        mlt_cache_put(cache, &objects[3], &data[3], 200, destroy_counter);
+        QCOMPARE(data[0], 1);
+        QCOMPARE(data[1], 1);
+        QCOMPARE(data[2], 0);
+        QCOMPARE(mlt_cache_get_bytes(cache), int64_t(300));
+        mlt_cache_close(cache);
+    }
+
+    void MaxBytesKeepsItemLargerThanBudget()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[2], data[2] = {0, 0};
+        mlt_cache_set_max_bytes(cache, 100);
+        mlt_cache_put(cache, &objects[0], &data[0], 50, destroy_counter);
+        mlt_cache_put(cache, &objects[1], &data[1], 1000, destroy_counter);
+        QCOMPARE(data[0], 1);
+        QVERIFY(is_cached(cache, &objects[1]));
+        QCOMPARE(mlt_cache_get_bytes(cache), int64_t(1000));
+        mlt_cache_close(cache);
+    }
+
+    void MaxBytesChargesReplacedData()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int object, data1 = 0, data2 = 0;
+        mlt_cache_set_max_bytes(cache, 1000);
+        mlt_cache_put(cache, &object, &data1, 100, destroy_counter);
+        mlt_cache_put(cache, &object, &data2, 40, destroy_counter);
+        QCOMPARE(mlt_cache_get_bytes(cache), int64_t(40));
+        mlt_cache_purge(cache, &object);
+        QCOMPARE(mlt_cache_get_bytes(cache), int64_t(0));
+        mlt_cache_close(cache);
+        QCOMPARE(data1, 1);
+        QCOMPARE(data2, 1);
+    }
+
+    void FrameCacheEvictsLeastRecentlyUsed()
+    {
+        mlt_cache cache = mlt_cache_init();
+        mlt_cache_set_size(cache, 2);
+        put_frame(cache, 10, 0);
+        put_frame(cache, 11, 0);
+        QVERIFY(has_frame(cache, 10));
+        put_frame(cache, 12, 0);
+        QVERIFY(has_frame(cache, 10));
+        QVERIFY(!has_frame(cache, 11));
+        QVERIFY(has_frame(cache, 12));
+        mlt_cache_close(cache);
+    }
+
+    void FrameCacheMaxBytesCountsImages()
+    {
+        mlt_cache cache = mlt_cache_init();
+        mlt_cache_set_max_bytes(cache, 1000);
+        put_frame(cache, 0, 400);
+        put_frame(cache, 1, 400);
+        QCOMPARE(mlt_cache_get_bytes(cache), int64_t(800));
+        put_frame(cache, 2, 400);
+        QVERIFY(!has_frame(cache, 0));
+        QVERIFY(has_frame(cache, 1));
+        QVERIFY(has_frame(cache, 2));
+        QCOMPARE(mlt_cache_get_bytes(cache), int64_t(800));
+        mlt_cache_close(cache);
+    }
+
+    void SharedBudgetEvictsOldestOfAllCaches()
+    {
+        mlt_cache a = mlt_cache_init();
+        mlt_cache b = mlt_cache_init();
+        int objects[4], data[4] = {};
+        mlt_cache_share(a);
+        mlt_cache_share(b);
+        mlt_cache_set_size(a, 100);
+        mlt_cache_set_size(b, 100);
+        mlt_cache_set_shared_max_bytes(300);
+        QCOMPARE(mlt_cache_get_shared_max_bytes(), int64_t(300));
+        int64_t bytes = mlt_cache_get_shared_bytes();
+        mlt_cache_put(a, &objects[0], &data[0], 100, destroy_counter);
+        mlt_cache_put(b, &objects[1], &data[1], 100, destroy_counter);
+        mlt_cache_put(a, &objects[2], &data[2], 100, destroy_counter);
+        QCOMPARE(mlt_cache_get_shared_bytes(), bytes + 300);
+        QCOMPARE(data[0], 0);
+        // The oldest entry is in the other cache
+        mlt_cache_put(b, &objects[3], &data[3], 100, destroy_counter);
+        QCOMPARE(data[0], 1);
+        QCOMPARE(data[1], 0);
+        QCOMPARE(mlt_cache_get_shared_bytes(), bytes + 300);
+        // Using an entry protects it
+        QVERIFY(is_cached(b, &objects[1]));
+        mlt_cache_put(a, &objects[0], &data[0], 100, destroy_counter);
+        QCOMPARE(data[1], 0);
+        QCOMPARE(data[2], 1);
+        mlt_cache_set_shared_max_bytes(0);
+        mlt_cache_close(a);
+        mlt_cache_close(b);
+        QCOMPARE(mlt_cache_get_shared_bytes(), bytes);
+    }
+
+    void SharedBudgetKeepsWhatWasJustPut()
+    {
+        mlt_cache cache = mlt_cache_init();
+        int objects[2], data[2] = {0, 0};
+        mlt_cache_share(cache);
+        mlt_cache_set_shared_max_bytes(100);
+        mlt_cache_put(cache, &objects[0], &data[0], 50, destroy_counter);
+        mlt_cache_put(cache, &objects[1], &data[1], 1000, destroy_counter);
+        QCOMPARE(data[0], 1);
+        QVERIFY(is_cached(cache, &objects[1]));
+        mlt_cache_set_shared_max_bytes(0);
+        mlt_cache_close(cache);
+        QCOMPARE(data[1], 1);
+    }
+
+    void SharedBudgetChargesFrames()
+    {
+        mlt_cache cache = mlt_cache_init();
+        mlt_cache_share(cache);
+        mlt_cache_set_size(cache, 100);
+        mlt_cache_set_shared_max_bytes(1000);
+        int64_t bytes = mlt_cache_get_shared_bytes();
+        put_frame(cache, 0, 400);
+        put_frame(cache, 1, 400);
+        QCOMPARE(mlt_cache_get_shared_bytes(), bytes + 800);
+        put_frame(cache, 2, 400);
+        QVERIFY(!has_frame(cache, 0));
+        QVERIFY(has_frame(cache, 2));
+        mlt_cache_set_shared_max_bytes(0);
+        mlt_cache_close(cache);
+        QCOMPARE(mlt_cache_get_shared_bytes(), bytes);
+    }
+
+    void SharedEvictionCanCloseSharedCaches()
+    {
+        // Releasing an entry can close a service and its caches, which leave the
+        // shared budget. This must not deadlock.
+        mlt_cache cache = mlt_cache_init();
+        mlt_cache inner = mlt_cache_init();
+        int objects[2], data = 0;
+        mlt_cache_share(cache);
+        mlt_cache_share(inner);
+        mlt_cache_set_shared_max_bytes(100);
+        mlt_cache_put(cache, &objects[0], inner, 100, close_cache);
+        mlt_cache_put(cache, &objects[1], &data, 100, destroy_counter);
+        QVERIFY(!is_cached(cache, &objects[0]));
+        QVERIFY(is_cached(cache, &objects[1]));
+        mlt_cache_set_shared_max_bytes(0);
+        mlt_cache_close(cache);
+        QCOMPARE(data, 1);
+    }
+
+    void SharedHitsAndMisses()
+    {
+        mlt_cache cache = mlt_cache_init();
+        mlt_cache other = mlt_cache_init();
+        int objects[2], data = 0;
+        mlt_cache_share(cache);
+        mlt_cache_put(cache, &objects[0], &data, 0, destroy_counter);
+        mlt_cache_put(other, &objects[0], &data, 0, NULL);
+        int64_t hits = mlt_cache_get_shared_hits();
+        int64_t misses = mlt_cache_get_shared_misses();
+        QVERIFY(is_cached(cache, &objects[0]));
+        QVERIFY(!is_cached(cache, &objects[1]));
+        QVERIFY(is_cached(cache, &objects[0]));
+        QCOMPARE(mlt_cache_get_shared_hits(), hits + 2);
+        QCOMPARE(mlt_cache_get_shared_misses(), misses + 1);
+        // Caches that are not shared are not counted
+        QVERIFY(is_cached(other, &objects[0]));
+        QVERIFY(!is_cached(other, &objects[1]));
+        QCOMPARE(mlt_cache_get_shared_hits(), hits + 2);
+        QCOMPARE(mlt_cache_get_shared_misses(), misses + 1);
+        // Frames count too
+        mlt_cache frames = mlt_cache_init();
+        mlt_cache_share(frames);
+        put_frame(frames, 5, 0);
+        QVERIFY(has_frame(frames, 5));
+        QVERIFY(!has_frame(frames, 6));
+        QCOMPARE(mlt_cache_get_shared_hits(), hits + 3);
+        QCOMPARE(mlt_cache_get_shared_misses(), misses + 2);
+        mlt_cache_close(frames);
+        mlt_cache_close(other);
+        mlt_cache_close(cache);
+    }
+};
+
+QTEST_APPLESS_MAIN(TestCache)
+
+#include "test_cache.moc"
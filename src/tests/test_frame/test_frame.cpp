@@ -52,6 +52,25 @@ static int convert_b(mlt_frame, uint8_t **, mlt_image_format *format, mlt_image_
     return 0;
 }
 
+// --- helpers for frame recycling tests ---
+
+static int g_destructor_calls = 0;
+
+static void count_destructor(void *)
+{
+    ++g_destructor_calls;
+}
+
+static int dummy_get_image(mlt_frame, uint8_t **, mlt_image_format *, int *, int *, int)
+{
+    return 0;
+}
+
+static int dummy_convert_audio(mlt_frame, void **, mlt_audio_format *, mlt_audio_format)
+{
+    return 0;
+}
+
 class TestFrame : public QObject
 {
     Q_OBJECT
@@ -246,6 +265,101 @@ private Q_SLOTS:
         mlt_frame_close(dst);
         mlt_frame_close(src);
     }
+
+    // --- frame recycling tests ---
+
+    void ClosedFrameIsRecycled()
+    {
+        mlt_frame frame = mlt_frame_init(NULL);
+        mlt_frame_close(frame);
+        mlt_frame reused = mlt_frame_init(NULL);
+        QCOMPARE(reused, frame);
+        mlt_frame_close(reused);
+    }
+
+    void RecycledFrameMatchesFreshFrame()
+    {
+        mlt_frame fresh = mlt_frame_init(NULL);
+        mlt_properties fresh_properties = MLT_FRAME_PROPERTIES(fresh);
+
+        mlt_frame frame = mlt_frame_init(NULL);
+        mlt_properties properties = MLT_FRAME_PROPERTIES(frame);
+        mlt_properties_set_int(properties, "width", 1920);
+        mlt_properties_set(properties, "consumer.rescale", "bilinear");
+        mlt_properties_set_int(properties, "test_image", 1);
+        mlt_properties_set_lcnumeric(properties, "C");
+        mlt_frame_set_position(frame, 100);
+        mlt_frame_push_get_image(frame, dummy_get_image);
+        mlt_frame_push_audio(frame, (void *) frame);
+        mlt_frame_append_convert_image(frame, convert_always);
+        frame->convert_audio = dummy_convert_audio;
+        frame->is_processing = 1;
+        mlt_properties_inc_ref(properties);
+        mlt_frame_close(frame);
+        mlt_frame_close(frame);
+
+        frame = mlt_frame_init(NULL);
+        properties = MLT_FRAME_PROPERTIES(frame);
+        QCOMPARE(mlt_properties_ref_count(properties), 1);
+        QCOMPARE(mlt_properties_count(properties), mlt_properties_count(fresh_properties));
+        for (int i = 0; i < mlt_properties_count(fresh_properties); i++) {
+            QCOMPARE(mlt_properties_get_name(properties, i),
+                     mlt_properties_get_name(fresh_properties, i));
+            QCOMPARE(mlt_properties_get_value(properties, i),
+                     mlt_properties_get_value(fresh_properties, i));
+        }
+        QVERIFY(mlt_properties_get(properties, "consumer.rescale") == nullptr);
+        QVERIFY(mlt_properties_get_lcnumeric(properties) == nullptr);
+        QCOMPARE(mlt_frame_get_position(frame), mlt_position(0));
+        QCOMPARE(mlt_frame_is_test_card(frame), 1);
+        QCOMPARE(mlt_deque_count(MLT_FRAME_IMAGE_STACK(frame)), 0);
+        QCOMPARE(mlt_deque_count(MLT_FRAME_AUDIO_STACK(frame)), 0);
+        QCOMPARE(mlt_deque_count(MLT_FRAME_SERVICE_STACK(frame)), 0);
+        QVERIFY(frame->convert_image == mlt_frame_convert_image);
+        QCOMPARE(mlt_frame_has_convert_image(frame), 0);
+        QVERIFY(frame->convert_audio == nullptr);
+        QCOMPARE(frame->is_processing, 0);
+
+        mlt_frame_close(frame);
+        mlt_frame_close(fresh);
+    }
+
+    void RecycledFrameReleasesValuesOnClose()
+    {
+        mlt_frame frame = mlt_frame_init(NULL);
+        g_destructor_calls = 0;
+        mlt_properties_set_data(MLT_FRAME_PROPERTIES(frame),
+                                "data",
+                                (void *) frame,
+                                0,
+                                count_destructor,
+                                NULL);
+        mlt_frame_close(frame);
+        QCOMPARE(g_destructor_calls, 1);
+
+        frame = mlt_frame_init(NULL);
+        QVERIFY(mlt_properties_get_data(MLT_FRAME_PROPERTIES(frame), "data", NULL) == nullptr);
+        mlt_frame_close(frame);
+        QCOMPARE(g_destructor_calls, 1);
+    }
+
+    void PoolCloseFreesRecycledFrames()
+    {
+        mlt_frame first = mlt_frame_init(NULL);
+        mlt_frame second = mlt_frame_init(NULL);
+        mlt_frame_close(first);
+        mlt_frame_close(second);
+        mlt_frame_pool_close();
+
+        // The pool is empty but frames can still be made and recycled
+        mlt_frame frame = mlt_frame_init(NULL);
+        QVERIFY(frame != nullptr);
+        QCOMPARE(mlt_properties_ref_count(MLT_FRAME_PROPERTIES(frame)), 1);
+        mlt_frame_close(frame);
+        QCOMPARE(mlt_frame_init(NULL), frame);
+        mlt_frame_close(frame);
+        mlt_frame_pool_close();
+    }
 };
 
 QTEST_APPLESS_MAIN(TestFrame)
@@ -19,9 +19,92 @@
 #include <QString>
 #include <QtTest>
 
+#include <cstring>
 #include <mlt++/Mlt.h>
 using namespace Mlt;
 
+// --- helpers for imageconvert tests ---
+
+static mlt_image newImage(mlt_image_format format, int width, int height)
+{
+    mlt_image image = mlt_image_new();
+    image->format = format;
+    image->width = width;
+    image->height = height;
+    mlt_image_alloc_data(image);
+    return image;
+}
+
+// Convert an image with the imageconvert filter into a new image.
+static mlt_image convertImage(mlt_image src, mlt_image_format format)
+{
+    Profile profile;
+    Filter filter(profile, "imageconvert");
+    mlt_frame frame = mlt_frame_init(nullptr);
+    uint8_t *buffer = static_cast<uint8_t *>(src->data);
+    mlt_image_format src_format = src->format;
+
+    mlt_frame_set_image(frame, buffer, 0, nullptr);
+    if (src->alpha)
+        mlt_frame_set_alpha(frame, static_cast<uint8_t *>(src->alpha), 0, nullptr);
+    mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "width", src->width);
+    mlt_properties_set_int(MLT_FRAME_PROPERTIES(frame), "height", src->height);
+    mlt_filter_process(filter.get_filter(), frame);
+    mlt_frame_convert_image(frame, &buffer, &src_format, format);
+
+    mlt_image dst = newImage(format, src->width, src->height);
+    memcpy(dst->data, buffer, mlt_image_calculate_size(dst));
+    uint8_t *alpha = mlt_frame_get_alpha(frame);
+    if (alpha && alpha != src->alpha) {
+        mlt_image_alloc_alpha(dst);
+        memcpy(dst->alpha, alpha, dst->width * dst->height);
+    }
+    mlt_frame_close(frame);
+    return dst;
+}
+
+static uint8_t *line8(mlt_image image, int plane, int line)
+{
+    return image->planes[plane] + image->strides[plane] * line;
+}
+
+// The 16-bit chroma planes of odd widths are not aligned.
+static int sample(mlt_image image, int plane, int line, int i)
+{
+    uint16_t value;
+    memcpy(&value, line8(image, plane, line) + i * 2, sizeof(value));
+    return value;
+}
+
+static void setSample(mlt_image image, int plane, int line, int i, int value)
+{
+    uint16_t value16 = value;
+    memcpy(line8(image, plane, line) + i * 2, &value16, sizeof(value16));
+}
+
+// Deterministic sample values that cover the whole range.
+static int pattern(int i, int bits)
+{
+    return (i * 7919 + 104729) % (1 << bits);
+}
+
+static void fillPattern(mlt_image image)
+{
+    int size = mlt_image_calculate_size(image);
+    for (int i = 0; i < size; i++)
+        static_cast<uint8_t *>(image->data)[i] = pattern(i, 8);
+    if (image->format != mlt_image_yuv420p10 && image->format != mlt_image_yuv444p10)
+        return;
+    // Keep the 10-bit samples in range
+    for (int plane = 0; plane < 3; plane++) {
+        int lines = image->format == mlt_image_yuv420p10 && plane > 0 ? image->height / 2
+                                                                      : image->height;
+        for (int line = 0; line < lines; line++)
+            for (int i = 0; i < image->strides[plane] / 2; i++)
+                setSample(image, plane, line, i, pattern(line * 1000 + i, 10));
+    }
+}
+
 class TestImage : public QObject
 {
     Q_OBJECT
@@ -167,6 +250,257 @@ private Q_SLOTS:
         QCOMPARE(mlt_image_color_pri_id("6"), mlt_color_pri_smpte170m);
         QCOMPARE(mlt_image_color_pri_id("9"), mlt_color_pri_bt2020);
     }
+
+    void ConvertYuv422ToYuv422p16()
+    {
+        // An odd width leaves the last pixel without its own chroma pair
+        mlt_image src = newImage(mlt_image_yuv422, 7, 2);
+        for (int line = 0; line < 2; line++)
+            for (int i = 0; i < 14; i++)
+                line8(src, 0, line)[i] = 16 + line * 100 + i * 10;
+        mlt_image dst = convertImage(src, mlt_image_yuv422p16);
+        for (int line = 0; line < 2; line++) {
+            for (int x = 0; x < 7; x++)
+                QCOMPARE(sample(dst, 0, line, x), line8(src, 0, line)[x * 2] << 8);
+            for (int c = 0; c < 3; c++) {
+                QCOMPARE(sample(dst, 1, line, c), line8(src, 0, line)[c * 4 + 1] << 8);
+                QCOMPARE(sample(dst, 2, line, c), line8(src, 0, line)[c * 4 + 3] << 8);
+            }
+        }
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
+
+    void ConvertYuv422p16ToYuv420p10()
+    {
+        mlt_image src = newImage(mlt_image_yuv422p16, 7, 4);
+        fillPattern(src);
+        // The 4:2:0 chroma comes from the even lines
+        for (int line = 0; line < 4; line++)
+            for (int c = 0; c < 3; c++) {
+                setSample(src, 1, line, c, line % 2 ? 0xffff : 0x4000 + line * 0x1000 + c);
+                setSample(src, 2, line, c, line % 2 ? 0 : 0x8000 - line * 0x1000 - c);
+            }
+        mlt_image dst = convertImage(src, mlt_image_yuv420p10);
+        for (int line = 0; line < 4; line++)
+            for (int x = 0; x < 7; x++)
+                QCOMPARE(sample(dst, 0, line, x),
+                         qMin((sample(src, 0, line, x) + 32) >> 6, 1023));
+        QCOMPARE(sample(dst, 1, 0, 0), 0x4000 >> 6);
+        QCOMPARE(sample(dst, 2, 0, 0), 0x8000 >> 6);
+        QCOMPARE(sample(dst, 1, 1, 2), (0x6000 + 2 + 32) >> 6);
+        QCOMPARE(sample(dst, 2, 1, 2), (0x6000 - 2 + 32) >> 6);
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
+
+    void ConvertYuv444p10ToYuv422p16()
+    {
+        mlt_image src = newImage(mlt_image_yuv444p10, 7, 2);
+        fillPattern(src);
+        mlt_image dst = convertImage(src, mlt_image_yuv422p16);
+        for (int line = 0; line < 2; line++) {
+            for (int x = 0; x < 7; x++)
+                QCOMPARE(sample(dst, 0, line, x), sample(src, 0, line, x) << 6);
+            // Subsampled chroma is the average of each pair of pixels
+            for (int c = 0; c < 3; c++)
+                for (int plane = 1; plane < 3; plane++) {
+                    int pair = (sample(src, plane, line, c * 2) << 6)
+                               + (sample(src, plane, line, c * 2 + 1) << 6);
+                    QCOMPARE(sample(dst, plane, line, c), pair >> 1);
+                }
+        }
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
+
+    void ConvertRgbaToRgba64()
+    {
+        mlt_image src = newImage(mlt_image_rgba, 7, 2);
+        fillPattern(src);
+        mlt_image dst = convertImage(src, mlt_image_rgba64);
+        for (int line = 0; line < 2; line++)
+            for (int i = 0; i < 7 * 4; i++)
+                QCOMPARE(sample(dst, 0, line, i), line8(src, 0, line)[i] * 257);
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
+
+    void ConvertYuv422p16ToRgba64()
+    {
+        // Black, white and grey of studio range
+        const int luma[] = {16 << 8, 235 << 8, 126 << 8};
+        const int rgb[] = {0, 65516, 32908};
+        mlt_image src = newImage(mlt_image_yuv422p16, 3, 2);
+        for (int line = 0; line < 2; line++) {
+            for (int x = 0; x < 3; x++)
+                setSample(src, 0, line, x, luma[x]);
+            setSample(src, 1, line, 0, 0x8000);
+            setSample(src, 2, line, 0, 0x8000);
+        }
+        mlt_image dst = convertImage(src, mlt_image_rgba64);
+        for (int line = 0; line < 2; line++)
+            for (int x = 0; x < 3; x++) {
+                for (int i = 0; i < 3; i++)
+                    QCOMPARE(sample(dst, 0, line, x * 4 + i), rgb[x]);
+                QCOMPARE(sample(dst, 0, line, x * 4 + 3), 65535);
+            }
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
+
+    void RoundTripRgbaThroughRgba64()
+    {
+        mlt_image src = newImage(mlt_image_rgba, 7, 3);
+        fillPattern(src);
+        mlt_image rgba64 = convertImage(src, mlt_image_rgba64);
+        mlt_image dst = convertImage(rgba64, mlt_image_rgba);
+        QVERIFY(!memcmp(src->data, dst->data, mlt_image_calculate_size(src)));
+        mlt_image_close(src);
+        mlt_image_close(rgba64);
+        mlt_image_close(dst);
+    }
+
+    void RoundTripYuv420p10ThroughYuv422p16()
+    {
+        mlt_image src = newImage(mlt_image_yuv420p10, 7, 4);
+        fillPattern(src);
+        mlt_image yuv422p16 = convertImage(src, mlt_image_yuv422p16);
+        mlt_image dst = convertImage(yuv422p16, mlt_image_yuv420p10);
+        for (int line = 0; line < 4; line++)
+            for (int x = 0; x < 7; x++)
+                QCOMPARE(sample(dst, 0, line, x), sample(src, 0, line, x));
+        for (int line = 0; line < 2; line++)
+            for (int c = 0; c < 3; c++) {
+                QCOMPARE(sample(dst, 1, line, c), sample(src, 1, line, c));
+                QCOMPARE(sample(dst, 2, line, c), sample(src, 2, line, c));
+            }
+        mlt_image_close(src);
+        mlt_image_close(yuv422p16);
+        mlt_image_close(dst);
+    }
+
+    void RoundTripYuv444p10ThroughYuv422p16()
+    {
+        mlt_image src = newImage(mlt_image_yuv444p10, 7, 2);
+        fillPattern(src);
+        mlt_image yuv422p16 = convertImage(src, mlt_image_yuv422p16);
+        mlt_image dst = convertImage(yuv422p16, mlt_image_yuv444p10);
+        for (int line = 0; line < 2; line++)
+            for (int x = 0; x < 7; x++) {
+                QCOMPARE(sample(dst, 0, line, x), sample(src, 0, line, x));
+                // Both pixels of a pair get their average chroma
+                int c = qMin(x / 2, 2);
+                for (int plane = 1; plane < 3; plane++) {
+                    int pair = sample(src, plane, line, c * 2)
+                               + sample(src, plane, line, c * 2 + 1);
+                    QCOMPARE(sample(dst, plane, line, x), (pair + 1) >> 1);
+                }
+            }
+        mlt_image_close(src);
+        mlt_image_close(yuv422p16);
+        mlt_image_close(dst);
+    }
+
+    void RoundTripRgba64ThroughYuv444p10()
+    {
+        mlt_image src = newImage(mlt_image_rgba64, 7, 2);
+        // Colors inside the Y'CbCr gamut
+        for (int line = 0; line < 2; line++)
+            for (int i = 0; i < 7 * 4; i++)
+                setSample(src, 0, line, i, 0x2000 + pattern(line * 100 + i, 15));
+        mlt_image yuv = convertImage(src, mlt_image_yuv444p10);
+        QVERIFY(yuv->alpha != nullptr);
+        mlt_image dst = convertImage(yuv, mlt_image_rgba64);
+        for (int line = 0; line < 2; line++)
+            for (int x = 0; x < 7; x++) {
+                for (int i = x * 4; i < x * 4 + 3; i++)
+                    QVERIFY(qAbs(sample(dst, 0, line, i) - sample(src, 0, line, i)) <= 512);
+                // Alpha goes through the 8-bit alpha plane
+                int alpha = sample(src, 0, line, x * 4 + 3);
+                QCOMPARE(sample(dst, 0, line, x * 4 + 3), (alpha >> 8) * 257);
+            }
+        mlt_image_close(src);
+        mlt_image_close(yuv);
+        mlt_image_close(dst);
+    }
+
+    // The SSE2 lines convert the leading multiples of 8 pixels and the C loops the rest, so
+    // these use widths that are not multiples of 8 to check both against the same macros.
+
+    void ConvertYuv422ToRgbaMatchesScalar()
+    {
+        const int width = 38;
+        mlt_image src = newImage(mlt_image_yuv422, width, 2);
+        fillPattern(src);
+        mlt_image dst = convertImage(src, mlt_image_rgba);
+        for (int line = 0; line < 2; line++)
+            for (int x = 0; x < width; x++) {
+                uint8_t *yuv = line8(src, 0, line) + x / 2 * 4;
+                int y = yuv[x % 2 * 2], u = yuv[1], v = yuv[3], r, g, b;
+                YUV2RGB_601_SCALED(y, u, v, r, g, b);
+                uint8_t *rgba = line8(dst, 0, line) + x * 4;
+                QCOMPARE(int(rgba[0]), r);
+                QCOMPARE(int(rgba[1]), g);
+                QCOMPARE(int(rgba[2]), b);
+                QCOMPARE(int(rgba[3]), 255);
+            }
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
+
+    void ConvertYuv420pToRgbaMatchesScalar()
+    {
+        const int width = 38;
+        mlt_image src = newImage(mlt_image_yuv420p, width, 4);
+        fillPattern(src);
+        mlt_image_alloc_alpha(src);
+        for (int i = 0; i < width * 4; i++)
+            static_cast<uint8_t *>(src->alpha)[i] = pattern(i + 5, 8);
+        mlt_image dst = convertImage(src, mlt_image_rgba);
+        for (int line = 0; line < 4; line++)
+            for (int x = 0; x < width; x++) {
+                int y = line8(src, 0, line)[x], r, g, b;
+                int u = line8(src, 1, line / 2)[x / 2], v = line8(src, 2, line / 2)[x / 2];
+                YUV2RGB_601_SCALED(y, u, v, r, g, b);
+                uint8_t *rgba = line8(dst, 0, line) + x * 4;
+                QCOMPARE(int(rgba[0]), r);
+                QCOMPARE(int(rgba[1]), g);
+                QCOMPARE(int(rgba[2]), b);
+                QCOMPARE(rgba[3], line8(src, 3, line)[x]);
+            }
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
+
+    void ConvertRgbaToYuv422MatchesScalar()
+    {
+        const int width = 37;
+        mlt_image src = newImage(mlt_image_rgba, width, 2);
+        fillPattern(src);
+        mlt_image dst = convertImage(src, mlt_image_yuv422);
+        QVERIFY(dst->alpha != nullptr);
+        for (int line = 0; line < 2; line++)
+            for (int x = 0; x < width; x += 2) {
+                uint8_t *rgba = line8(src, 0, line) + x * 4;
+                uint8_t *yuv = line8(dst, 0, line) + x * 2;
+                int y0, u0, v0, y1, u1, v1;
+                RGB2YUV_601_SCALED(rgba[0], rgba[1], rgba[2], y0, u0, v0);
+                QCOMPARE(int(yuv[0]), y0);
+                QCOMPARE(line8(dst, 3, line)[x], rgba[3]);
+                if (x + 1 < width) {
+                    RGB2YUV_601_SCALED(rgba[4], rgba[5], rgba[6], y1, u1, v1);
+                    QCOMPARE(int(yuv[1]), (u0 + u1) >> 1);
+                    QCOMPARE(int(yuv[2]), y1);
+                    QCOMPARE(int(yuv[3]), (v0 + v1) >> 1);
+                    QCOMPARE(line8(dst, 3, line)[x + 1], rgba[7]);
+                } else {
+                    QCOMPARE(int(yuv[1]), u0);
+                }
+            }
+        mlt_image_close(src);
+        mlt_image_close(dst);
+    }
 };
 
 QTEST_APPLESS_MAIN(TestImage)
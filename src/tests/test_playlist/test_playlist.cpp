@@ -263,6 +263,53 @@ private Q_SLOTS:
         delete pp2;
         delete pp3;
     }
+
+    void ClipIndexAtPosition()
+    {
+        Playlist pl(profile);
+        QVERIFY(pl.is_valid());
+        Producer p(profile, "noise");
+        QVERIFY(p.is_valid());
+
+        // Lengths: 10, 20, 30
+        pl.append(p, 0, 9);
+        pl.append(p, 0, 19);
+        pl.append(p, 0, 4);
+        pl.append(p, 0, 29);
+        pl.remove(2);
+        QCOMPARE(pl.count(), 3);
+        QCOMPARE(pl.clip_start(0), 0);
+        QCOMPARE(pl.clip_start(1), 10);
+        QCOMPARE(pl.clip_start(2), 30);
+        QCOMPARE(pl.get_clip_index_at(0), 0);
+        QCOMPARE(pl.get_clip_index_at(9), 0);
+        QCOMPARE(pl.get_clip_index_at(10), 1);
+        QCOMPARE(pl.get_clip_index_at(29), 1);
+        QCOMPARE(pl.get_clip_index_at(30), 2);
+        QCOMPARE(pl.get_clip_index_at(59), 2);
+        QCOMPARE(pl.get_clip_index_at(60), 3);
+
+        // Lengths: 10, 30, 5
+        pl.resize_clip(1, 0, 29);
+        pl.resize_clip(2, 0, 4);
+        QCOMPARE(pl.clip_start(2), 40);
+        QCOMPARE(pl.get_clip_index_at(39), 1);
+        QCOMPARE(pl.get_clip_index_at(44), 2);
+
+        // Lengths: 5, 10, 30
+        pl.move(2, 0);
+        QCOMPARE(pl.clip_start(1), 5);
+        QCOMPARE(pl.clip_start(2), 15);
+        QCOMPARE(pl.get_clip_index_at(4), 0);
+        QCOMPARE(pl.get_clip_index_at(5), 1);
+        QCOMPARE(pl.get_clip_index_at(15), 2);
+
+        // Lengths: 5, 20, 30
+        pl.repeat(1, 2);
+        QCOMPARE(pl.clip_start(2), 25);
+        QCOMPARE(pl.get_clip_index_at(24), 1);
+        QCOMPARE(pl.get_clip_index_at(25), 2);
+    }
 };
 
 QTEST_APPLESS_MAIN(TestPlaylist)
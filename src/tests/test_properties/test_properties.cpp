@@ -668,6 +668,59 @@ private Q_SLOTS:
         mlt_animation_close(a);
     }
 
+    void AnimationWithManyKeyframes()
+    {
+        double fps = 25.0;
+        mlt_animation a = mlt_animation_new();
+        struct mlt_animation_item_s item;
+        QString data;
+        for (int i = 0; i < 1000; i++)
+            data += QStringLiteral("%1=%2;").arg(i * 10).arg(i * 100);
+        mlt_animation_parse(a, data.toUtf8().constData(), 10000, fps, locale);
+        QCOMPARE(mlt_animation_key_count(a), 1000);
+        item.property = mlt_property_init();
+
+        // Forward, backward and random order must agree
+        for (int position = 0; position <= 9990; position += 7) {
+            mlt_animation_get_item(a, &item, position);
+            QCOMPARE(mlt_property_get_int(item.property, fps, locale), position * 10);
+        }
+        for (int position = 9990; position >= 0; position -= 13) {
+            mlt_animation_get_item(a, &item, position);
+            QCOMPARE(mlt_property_get_int(item.property, fps, locale), position * 10);
+            QCOMPARE(item.is_key, int(position % 10 == 0));
+        }
+        mlt_animation_get_item(a, &item, 5005);
+        QCOMPARE(mlt_property_get_int(item.property, fps, locale), 50050);
+        mlt_animation_get_item(a, &item, 15);
+        QCOMPARE(mlt_property_get_int(item.property, fps, locale), 150);
+
+        // Insert in the middle, remove and move key frames
+        item.frame = 5005;
+        item.keyframe_type = mlt_keyframe_discrete;
+        mlt_property_set_int(item.property, 0);
+        mlt_animation_insert(a, &item);
+        QCOMPARE(mlt_animation_key_count(a), 1001);
+        mlt_animation_get_item(a, &item, 5007);
+        QCOMPARE(mlt_property_get_int(item.property, fps, locale), 0);
+        mlt_animation_remove(a, 5005);
+        mlt_animation_get_item(a, &item, 5007);
+        QCOMPARE(mlt_property_get_int(item.property, fps, locale), 50070);
+        QCOMPARE(mlt_animation_next_key(a, &item, 5001), 0);
+        QCOMPARE(item.frame, 5010);
+        QCOMPARE(mlt_animation_prev_key(a, &item, 5009), 0);
+        QCOMPARE(item.frame, 5000);
+        mlt_animation_key_set_frame(a, 1, 15);
+        mlt_animation_get_item(a, &item, 15);
+        QCOMPARE(mlt_property_get_int(item.property, fps, locale), 100);
+        QCOMPARE(item.is_key, 1);
+        mlt_animation_get_item(a, &item, 17);
+        QCOMPARE(mlt_property_get_int(item.property, fps, locale), 140);
+
+        mlt_property_close(item.property);
+        mlt_animation_close(a);
+    }
+
     void AnimationWithTimeValueKeyframes()
     {
         double fps = 25.0;
@@ -1583,6 +1636,24 @@ private Q_SLOTS:
         QCOMPARE(p.get_int("foo"), 123);
         QCOMPARE(p.get_double("foo"), 123.4);
     }
+
+    void InternedKeys()
+    {
+        Properties p;
+        mlt_properties_key key = mlt_properties_intern("foo");
+        QCOMPARE(mlt_properties_intern("foo"), key);
+        QCOMPARE(mlt_properties_key_name(key), "foo");
+        p.set("foo", 123);
+        QCOMPARE(mlt_properties_get_int_k(p.get_properties(), key), 123);
+        mlt_properties_set_int_k(p.get_properties(), key, 456);
+        QCOMPARE(p.get_int("foo"), 456);
+        QCOMPARE(p.count(), 1);
+        mlt_properties_set_double_k(p.get_properties(), mlt_properties_intern("bar"), 1.5);
+        QCOMPARE(p.get_double("bar"), 1.5);
+        p.rename("foo", "baz");
+        QVERIFY(mlt_properties_get_k(p.get_properties(), key) == nullptr);
+        QCOMPARE(p.get_int("baz"), 456);
+    }
 };
 
 QTEST_APPLESS_MAIN(TestProperties)
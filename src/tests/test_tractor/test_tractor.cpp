@@ -35,6 +35,39 @@ public:
         Factory::init();
     }
 
+private:
+    QByteArray renderPictureInPicture(bool parallel, int position, mlt_image_format format)
+    {
+        Tractor t(profile);
+        Producer background(profile, "color:#ff204080");
+        Producer p1(profile, "noise");
+        Producer p2(profile, "noise");
+        t.set_track(background, 0);
+        t.set_track(p1, 1);
+        t.set_track(p2, 2);
+        t.set("parallel_tracks", parallel ? 1 : 0);
+
+        Transition composite(profile, "composite");
+        composite.set("geometry", "10%/10%:40%x40%");
+        t.plant_transition(composite, 0, 1);
+        Transition affine(profile, "affine");
+        affine.set("rect", "50%/45%:37%x41%");
+        t.plant_transition(affine, 0, 2);
+
+        t.seek(position);
+        Frame *frame = t.get_frame();
+        frame->set("consumer.rescale", "bilinear");
+        frame->set("consumer.progressive", 1);
+        int width = profile.width();
+        int height = profile.height();
+        uint8_t *data = frame->get_image(format, width, height);
+        struct mlt_image_s image;
+        mlt_image_set_values(&image, data, format, width, height);
+        QByteArray result((const char *) data, data ? mlt_image_calculate_size(&image) : 0);
+        delete frame;
+        return result;
+    }
+
 private Q_SLOTS:
 
     void CreateSingleTrack()
@@ -434,6 +467,21 @@ private Q_SLOTS:
 
         mlt_frame_close(merged);
     }
+
+    void ParallelTracksMatchSerialPictureInPicture()
+    {
+        Transition affine(profile, "affine");
+        if (!affine.is_valid())
+            QSKIP("affine transition not available");
+        mlt_image_format formats[] = {mlt_image_yuv422, mlt_image_rgba};
+        for (auto format : formats) {
+            for (int position = 0; position < 100; position += 37) {
+                QByteArray serial = renderPictureInPicture(false, position, format);
+                QVERIFY(!serial.isEmpty());
+                QCOMPARE(renderPictureInPicture(true, position, format), serial);
+            }
+        }
+    }
 };
 
 QTEST_APPLESS_MAIN(TestTractor)